@@ -1,36 +1,109 @@
 .PHONY: all
 all: $(BUILDDIR)/feedthrough.elf $(BUILDDIR)/sine.elf $(BUILDDIR)/delay.elf
 all: $(BUILDDIR)/fxbox.elf $(BUILDDIR)/fxbox2.elf $(BUILDDIR)/guitar.elf
-all: $(BUILDDIR)/fft_tests.elf
+all: $(BUILDDIR)/bench_fastmath.elf
 
 .PHONY: clean
 clean:
 	rm -rf $(BUILDDIR)
 
-$(BUILDDIR)/%.o: src/%.c Makefile $(LIBOPENCM3)
+# Audio configuration, see codec.h for the supported values
+SAMPLERATE ?= 48000
+FRAMESIZE ?= 64
+COMMONFLAGS += -DCODEC_SAMPLERATE=$(SAMPLERATE) -DCODEC_SAMPLES_PER_FRAME=$(FRAMESIZE)
+
+# Rebuild everything when the audio configuration or the FFT backend changes
+AUDIO_CONFIG = $(SAMPLERATE) $(FRAMESIZE) $(FFT_BACKEND)
+$(BUILDDIR)/audio-config: FORCE
+	@mkdir -p $(dir $@)
+	@echo '$(AUDIO_CONFIG)' | cmp -s - $@ || echo '$(AUDIO_CONFIG)' > $@
+
+.PHONY: FORCE
+FORCE:
+
+# Constant tables generated at build time, see src/dsp/tables.h. Set
+# FFT_TABLE_SIZE to the largest real FFT used, and WINDOW_SIZES to all sizes
+# of windows used.
+PYTHON ?= python3
+FFT_TABLE_SIZE ?= 2048
+WINDOW_SIZES ?= 1024 2048
+TABLES_CONFIG := $(FFT_TABLE_SIZE) $(WINDOW_SIZES)
+COMMONFLAGS += -I$(BUILDDIR)/tables
+
+$(BUILDDIR)/tables/config: FORCE
+	@mkdir -p $(dir $@)
+	@echo '$(TABLES_CONFIG)' | cmp -s - $@ || echo '$(TABLES_CONFIG)' > $@
+
+# A pattern rule, so that one run makes both files. They are kept, as the
+# dependency files refer to the header.
+.SECONDARY: $(BUILDDIR)/tables/tabledata.c $(BUILDDIR)/tables/tabledata.h
+$(BUILDDIR)/%/tabledata.c $(BUILDDIR)/%/tabledata.h: src/dsp/make_tables.py $(BUILDDIR)/%/config
+	@echo GEN $@
+	@$(PYTHON) src/dsp/make_tables.py $(dir $@) $(TABLES_CONFIG)
+
+# Each table in its own section, so that the linker drops unused ones
+$(BUILDDIR)/tables/tabledata.o: $(BUILDDIR)/tables/tabledata.c $(BUILDDIR)/audio-config
+	@echo CC $@
+	@$(CC) -MD -MP $(COMMONFLAGS) $(CFLAGS) -fdata-sections -c -o $@ $<
+
+# Headers with the sinc interpolation table and the default cabinet impulse
+# response, made the same way
+GENERATED_HEADERS := $(BUILDDIR)/tables/tabledata.h \
+	$(BUILDDIR)/tables/sinctable.h $(BUILDDIR)/tables/cabinet_ir.h
+
+$(BUILDDIR)/tables/sinctable.h: src/dsp/make_sinctable.py
+	@echo GEN $@
+	@mkdir -p $(dir $@)
+	@$(PYTHON) src/dsp/make_sinctable.py $(dir $@)
+
+$(BUILDDIR)/tables/cabinet_ir.h: src/dsp/make_cabinet.py $(BUILDDIR)/audio-config
+	@echo GEN $@
+	@mkdir -p $(dir $@)
+	@$(PYTHON) src/dsp/make_cabinet.py $(dir $@) $(SAMPLERATE)
+
+$(BUILDDIR)/%.o: src/%.c Makefile $(LIBOPENCM3) $(BUILDDIR)/audio-config | $(GENERATED_HEADERS)
 	@echo CC $@
 	@mkdir -p $(dir $@)
-	@$(CC) -MD $(COMMONFLAGS) $(CFLAGS) -c -o $@ $<
+	@$(CC) -MD -MP $(COMMONFLAGS) $(CFLAGS) -c -o $@ $<
 
 # -------------------------------------
 
 COMMONFLAGS += -Isrc/kiss_fft130
 
+# FFT backend under kiss_fftr, see dsp/fft.h
+FFT_BACKEND ?= radix4
+COMMONFLAGS += -DFFT_BACKEND_RADIX4=$(if $(filter radix4,$(FFT_BACKEND)),1,0)
+FFT_BACKEND_OBJS_kiss := $(BUILDDIR)/kiss_fft130/kiss_fft.o \
+	$(BUILDDIR)/kiss_fft130/tools/kiss_fftr.o $(BUILDDIR)/dsp/fft_kiss.o
+FFT_BACKEND_OBJS_radix4 := $(BUILDDIR)/dsp/fft_radix4.o
+FFT_OBJS := $(FFT_BACKEND_OBJS_$(FFT_BACKEND)) $(BUILDDIR)/tables/tabledata.o
+
+# The oversampled drive stage at the end of the applications
+DRIVE_OBJS := $(BUILDDIR)/dsp/waveshaper.o $(BUILDDIR)/dsp/halfband.o \
+	$(BUILDDIR)/tables/tabledata.o
+
 $(BUILDDIR)/feedthrough.elf: $(COMMON_OBJS) $(BUILDDIR)/examples/feedthrough.o
 $(BUILDDIR)/sine.elf: $(COMMON_OBJS) $(BUILDDIR)/examples/sine.o
 $(BUILDDIR)/delay.elf: $(COMMON_OBJS) $(BUILDDIR)/examples/delay.o
 $(BUILDDIR)/fxbox.elf: $(COMMON_OBJS) $(BUILDDIR)/fxbox.o \
-	$(BUILDDIR)/dsp/vibrato.o $(BUILDDIR)/dsp/wahwah.o \
-	$(BUILDDIR)/dsp/delay.o $(BUILDDIR)/dsp/pitcher.o \
-	$(BUILDDIR)/dsp/biquad.o
+	$(BUILDDIR)/effectswitch.o $(BUILDDIR)/taptempo.o $(BUILDDIR)/fxgraph.o $(BUILDDIR)/arena.o \
+	$(BUILDDIR)/dsp/vibrato.o $(BUILDDIR)/dsp/lfo.o $(BUILDDIR)/dsp/wahwah.o \
+	$(BUILDDIR)/dsp/delay.o $(BUILDDIR)/dsp/adpcm.o $(BUILDDIR)/dsp/pitcher.o \
+	$(BUILDDIR)/dsp/biquad.o $(BUILDDIR)/dsp/harmonizer.o \
+	$(BUILDDIR)/dsp/reverb.o $(BUILDDIR)/dsp/gate.o $(FFT_OBJS) $(DRIVE_OBJS)
 $(BUILDDIR)/fxbox2.elf: $(COMMON_OBJS) $(BUILDDIR)/fxbox2.o \
-	$(BUILDDIR)/dsp/vibrato.o $(BUILDDIR)/dsp/biquad.o \
-	$(BUILDDIR)/dsp/delay.o
+	$(BUILDDIR)/fxgraph.o $(BUILDDIR)/arena.o \
+	$(BUILDDIR)/dsp/vibrato.o $(BUILDDIR)/dsp/lfo.o $(BUILDDIR)/dsp/biquad.o \
+	$(BUILDDIR)/dsp/delay.o $(BUILDDIR)/dsp/adpcm.o $(BUILDDIR)/dsp/gate.o \
+	$(DRIVE_OBJS)
 $(BUILDDIR)/guitar.elf: $(COMMON_OBJS) $(BUILDDIR)/guitar.o \
-	$(BUILDDIR)/dsp/vibrato.o $(BUILDDIR)/dsp/delay.o
-$(BUILDDIR)/fft_tests.elf: $(COMMON_OBJS) $(BUILDDIR)/tests/fft_tests.o
-$(BUILDDIR)/fft_tests.elf: $(BUILDDIR)/kiss_fft130/kiss_fft.o
-$(BUILDDIR)/fft_tests.elf: $(BUILDDIR)/kiss_fft130/tools/kiss_fftr.o
+	$(BUILDDIR)/effectswitch.o $(BUILDDIR)/taptempo.o $(BUILDDIR)/fxgraph.o $(BUILDDIR)/arena.o \
+	$(BUILDDIR)/dsp/vibrato.o $(BUILDDIR)/dsp/lfo.o $(BUILDDIR)/dsp/delay.o \
+	$(BUILDDIR)/dsp/adpcm.o $(BUILDDIR)/dsp/cabinet.o $(BUILDDIR)/dsp/reverb.o \
+	$(BUILDDIR)/dsp/gate.o $(FFT_OBJS) $(DRIVE_OBJS)
+$(BUILDDIR)/fft_tests.elf: $(COMMON_OBJS) $(BUILDDIR)/tests/fft_tests.o $(FFT_OBJS)
+$(BUILDDIR)/bench_fastmath.elf: $(COMMON_OBJS) $(BUILDDIR)/tests/bench_fastmath.o \
+	$(BUILDDIR)/tables/tabledata.o
 
 $(BUILDDIR)/%.elf: $(LIBOPENCM3) $(LDSCRIPT)
 	@echo LD $@
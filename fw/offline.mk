@@ -0,0 +1,79 @@
+#
+# Makefile with definitions for building for host (POSIX) without Jack. The
+# executables render audio files offline, as fast as the CPU allows.
+#
+
+BUILDDIR := build_offline
+
+COMMONFLAGS := -I. -Isrc -Isrc/host -Iinclude
+COMMONFLAGS += -std=c11 -O1 -fno-common -g -Wall -Wextra -DHOST
+COMMONFLAGS += -Wall -Wextra -Werror-implicit-function-declaration  -Werror -Wno-error=unused-variable
+
+LDFLAGS += -lm
+
+# Sources to build for offline host only
+SRCS += src/host/platform-offline.c
+SRCS += src/host/offline.c
+SRCS += src/host/cyclecounter.c
+
+# Sources shared by all platforms
+SRCS += src/loadmeter.c
+
+COMMON_OBJS := $(SRCS:src/%.c=$(BUILDDIR)/%.o)
+
+include common.mk
+
+# -------------------------------------
+
+# DSP benchmarks only make sense without an audio backend
+.PHONY: bench
+BENCH_FFT := $(BUILDDIR)/bench_fft_kiss.elf $(BUILDDIR)/bench_fft_radix4.elf
+all: $(BUILDDIR)/bench_dsp.elf $(BUILDDIR)/bench_interp.elf $(BENCH_FFT)
+all: $(BUILDDIR)/bench_adpcm.elf $(BUILDDIR)/cabinet_tests.elf
+bench: $(BUILDDIR)/bench_dsp.elf $(BUILDDIR)/bench_interp.elf $(BENCH_FFT) \
+	$(BUILDDIR)/bench_fastmath.elf $(BUILDDIR)/bench_adpcm.elf adpcm-delay
+	$(BUILDDIR)/bench_dsp.elf
+	$(BUILDDIR)/bench_interp.elf
+	$(BUILDDIR)/bench_adpcm.elf
+	$(BUILDDIR)/adpcm/bench_dsp.elf $(DELAY_BENCHES)
+	$(BUILDDIR)/bench_fastmath.elf
+	for b in $(BENCH_FFT); do $$b; done
+
+# The delay with DELAY_ADPCM=1, in a build directory of its own, so that its
+# ADPCM paths get built and run along with the default int16 ones
+.PHONY: adpcm-delay
+DELAY_BENCHES := delay delay-wobble delay-fixed
+adpcm-delay:
+	$(MAKE) -f offline.mk BUILDDIR=$(BUILDDIR)/adpcm CFLAGS=-DDELAY_ADPCM=1 \
+		$(BUILDDIR)/adpcm/bench_dsp.elf
+
+$(BUILDDIR)/bench_dsp.elf: $(BUILDDIR)/tests/bench_dsp.o \
+	$(BUILDDIR)/dsp/vibrato.o $(BUILDDIR)/dsp/lfo.o $(BUILDDIR)/dsp/wahwah.o \
+	$(BUILDDIR)/dsp/delay.o $(BUILDDIR)/dsp/adpcm.o $(BUILDDIR)/dsp/pitcher.o \
+	$(BUILDDIR)/dsp/biquad.o $(BUILDDIR)/dsp/cabinet.o $(BUILDDIR)/dsp/reverb.o \
+	$(BUILDDIR)/dsp/gate.o $(FFT_OBJS) $(DRIVE_OBJS) $(BUILDDIR)/loadmeter.o $(BUILDDIR)/host/cyclecounter.o
+
+$(BUILDDIR)/bench_interp.elf: $(BUILDDIR)/tests/bench_interp.o
+
+$(BUILDDIR)/bench_adpcm.elf: $(BUILDDIR)/tests/bench_adpcm.o $(BUILDDIR)/dsp/adpcm.o
+
+$(BUILDDIR)/cabinet_tests.elf: $(BUILDDIR)/tests/cabinet_tests.o \
+	$(BUILDDIR)/dsp/cabinet.o $(FFT_OBJS)
+
+# The cabinet partitions are a frame long, so check it built for a few frame
+# sizes, each in a build directory of its own. Also run the ADPCM delay for a
+# moment.
+.PHONY: test
+TEST_FRAMESIZES := 16 64 256
+test: adpcm-delay
+	for f in $(TEST_FRAMESIZES); do \
+		$(MAKE) -f offline.mk BUILDDIR=$(BUILDDIR)/frames$$f FRAMESIZE=$$f \
+			$(BUILDDIR)/frames$$f/cabinet_tests.elf && \
+		$(BUILDDIR)/frames$$f/cabinet_tests.elf || exit 1; \
+	done
+	$(BUILDDIR)/adpcm/bench_dsp.elf -n 1000 $(DELAY_BENCHES)
+
+# The FFT benchmark once with each backend
+$(BENCH_FFT): $(BUILDDIR)/tests/bench_fft.o $(BUILDDIR)/tables/tabledata.o
+$(BUILDDIR)/bench_fft_kiss.elf: $(FFT_BACKEND_OBJS_kiss)
+$(BUILDDIR)/bench_fft_radix4.elf: $(FFT_BACKEND_OBJS_radix4)
@@ -0,0 +1,134 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "platform.h"
+#include "arena.h"
+
+#define ALIGNMENT 8
+
+enum Region {
+    REGION_CCM,
+    REGION_SRAM,
+    REGION_COUNT
+};
+
+static uint8_t ccmMemory[ARENA_CCM_SIZE] CCM_DATA __attribute__((aligned(ALIGNMENT)));
+static uint8_t sramMemory[ARENA_SRAM_SIZE] __attribute__((aligned(ALIGNMENT)));
+
+static struct {
+    const char* name;
+    uint8_t* memory;
+    size_t size;
+    size_t used;
+} regions[REGION_COUNT] = {
+    [REGION_CCM] = { "ccm", ccmMemory, ARENA_CCM_SIZE, 0 },
+    [REGION_SRAM] = { "sram", sramMemory, ARENA_SRAM_SIZE, 0 },
+};
+
+typedef struct {
+    const char* name;
+    size_t offset;
+    size_t size;
+    uint8_t region;
+    uint8_t overlay; ///< Overlay number from 1, or 0 if not in one
+    uint8_t branch;
+} Entry;
+
+static Entry entries[ARENA_MAX_ENTRIES];
+static unsigned entryCount;
+
+static struct {
+    bool active;
+    uint8_t region;
+    uint8_t number;
+    uint8_t branch;
+    size_t start;
+    size_t end; ///< End of the largest branch so far
+} overlay;
+
+static bool fits(enum Region r, size_t size)
+{
+    return regions[r].size - regions[r].used >= size;
+}
+
+void* arenaAlloc(size_t size, enum ArenaHeat heat, const char* name)
+{
+    size = (size + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+
+    enum Region r;
+    if (overlay.active) {
+        r = overlay.region;
+    }
+    else if (heat == ARENA_HOT && fits(REGION_CCM, size)) {
+        r = REGION_CCM;
+    }
+    else {
+        r = REGION_SRAM;
+    }
+
+    if (!fits(r, size) || entryCount == ARENA_MAX_ENTRIES) {
+        printf("arena: no room for %s, %u bytes\n", name, (unsigned)size);
+        return NULL;
+    }
+
+    entries[entryCount++] = (Entry) {
+        .name = name,
+        .offset = regions[r].used,
+        .size = size,
+        .region = r,
+        .overlay = overlay.active ? overlay.number : 0,
+        .branch = overlay.branch
+    };
+
+    void* p = regions[r].memory + regions[r].used;
+    regions[r].used += size;
+    if (overlay.active && regions[r].used > overlay.end) {
+        overlay.end = regions[r].used;
+    }
+
+    // CCM isn't cleared at startup, and overlaid memory may have been used
+    memset(p, 0, size);
+    return p;
+}
+
+void arenaOverlayBegin(enum ArenaHeat heat)
+{
+    overlay.active = true;
+    overlay.region = heat == ARENA_HOT ? REGION_CCM : REGION_SRAM;
+    overlay.number++;
+    overlay.branch = 0;
+    overlay.start = regions[overlay.region].used;
+    overlay.end = overlay.start;
+}
+
+void arenaOverlayNext(void)
+{
+    regions[overlay.region].used = overlay.start;
+    overlay.branch++;
+}
+
+void arenaOverlayEnd(void)
+{
+    regions[overlay.region].used = overlay.end;
+    overlay.active = false;
+    overlay.branch = 0;
+}
+
+void arenaPrintMap(void)
+{
+    printf("memory map:\n");
+    for (unsigned e = 0; e < entryCount; e++) {
+        const Entry* entry = &entries[e];
+        printf("  %-4s %6u %6u  %s", regions[entry->region].name,
+                (unsigned)entry->offset, (unsigned)entry->size, entry->name);
+        if (entry->overlay) {
+            printf(" (overlay %u branch %u)", entry->overlay, entry->branch);
+        }
+        printf("\n");
+    }
+    for (unsigned r = 0; r < REGION_COUNT; r++) {
+        printf("%s: %u of %u bytes used\n", regions[r].name,
+                (unsigned)regions[r].used, (unsigned)regions[r].size);
+    }
+}
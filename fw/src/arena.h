@@ -0,0 +1,64 @@
+#pragma once
+
+/**
+ * Allocator for effect states, placing them in the fixed size memory regions
+ * of the STM32F405 at boot. Nothing is ever freed.
+ *
+ * Hot states, read and written for every sample, go into the core coupled
+ * memory when they fit, and everything else into a block of SRAM. The host
+ * builds use regions of the same sizes, so a memory map printed on host shows
+ * what fits in the firmware.
+ *
+ * States of effects that never run at the same time can share memory in an
+ * overlay: everything allocated between arenaOverlayBegin() and the first
+ * arenaOverlayNext() is one branch, starting at the same address as the next
+ * branch, and so on. The overlay takes as much memory as its largest branch.
+ * Whoever runs an overlaid effect must initialize its state again after
+ * another branch of the overlay has used the memory.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/// Size of the CCM region, all of the CCM on target
+#ifndef ARENA_CCM_SIZE
+#define ARENA_CCM_SIZE (64 * 1024)
+#endif
+
+/// Size of the SRAM region, leaving the rest of the 128 KB for other
+/// variables and the stack
+#ifndef ARENA_SRAM_SIZE
+#define ARENA_SRAM_SIZE (100 * 1024)
+#endif
+
+#define ARENA_MAX_ENTRIES 32
+
+enum ArenaHeat {
+    ARENA_HOT, ///< In CCM if there's room left, else SRAM
+    ARENA_COLD ///< In SRAM
+};
+
+/**
+ * Allocate zeroed memory aligned to 8 bytes.
+ *
+ * @param name Shown in the memory map
+ * @return NULL, after printing an error, if the memory has run out
+ */
+void* arenaAlloc(size_t size, enum ArenaHeat heat, const char* name);
+
+/**
+ * Start an overlay, with all of its branches in the region for heat
+ */
+void arenaOverlayBegin(enum ArenaHeat heat);
+
+/**
+ * Start the next branch of the current overlay
+ */
+void arenaOverlayNext(void);
+
+void arenaOverlayEnd(void);
+
+/**
+ * Print all allocations and how much of each region is used
+ */
+void arenaPrintMap(void);
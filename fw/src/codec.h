@@ -1,11 +1,31 @@
 #pragma once
 #include <stdint.h>
 
+/*
+ * The sample rate and the number of samples processed per frame are set at
+ * build time, e.g. make SAMPLERATE=44100 FRAMESIZE=16
+ */
+#ifndef CODEC_SAMPLERATE
 #define CODEC_SAMPLERATE 48000
+#endif
+
+#if CODEC_SAMPLERATE != 32000 && CODEC_SAMPLERATE != 44100 && \
+        CODEC_SAMPLERATE != 48000 && CODEC_SAMPLERATE != 96000
+#error "CODEC_SAMPLERATE must be 32000, 44100, 48000 or 96000"
+#endif
+
 #define NYQUIST (CODEC_SAMPLERATE / 2)
 
 // 64 samples = 1.33ms at 48kHz
+#ifndef CODEC_SAMPLES_PER_FRAME
 #define CODEC_SAMPLES_PER_FRAME 64
+#endif
+
+#if CODEC_SAMPLES_PER_FRAME != 16 && CODEC_SAMPLES_PER_FRAME != 32 && \
+        CODEC_SAMPLES_PER_FRAME != 64 && CODEC_SAMPLES_PER_FRAME != 128 && \
+        CODEC_SAMPLES_PER_FRAME != 256
+#error "CODEC_SAMPLES_PER_FRAME must be 16, 32, 64, 128 or 256"
+#endif
 
 typedef int16_t CodecIntSample;
 
@@ -0,0 +1,110 @@
+#include "adpcm.h"
+
+#define STEP_COUNT 89
+
+_Static_assert(ADPCM_BLOCK_LEN % 2 == 0, "Blocks must hold whole bytes");
+
+/// The IMA ADPCM step sizes, growing by about 10% each
+static const int16_t stepSizes[STEP_COUNT] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41,
+    45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209,
+    230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876,
+    963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749,
+    3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630,
+    9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385,
+    24623, 27086, 29794, 32767
+};
+
+/// Change of the step index for each code, by its magnitude
+static const int8_t indexSteps[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+/**
+ * Move the coder state on by one code, shared by the encoder and decoder so
+ * that they reconstruct the same samples
+ */
+static inline void step(int32_t* predictor, int32_t* stepIndex, unsigned code)
+{
+    const int32_t size = stepSizes[*stepIndex];
+    int32_t delta = size >> 3;
+    if (code & 4) {
+        delta += size;
+    }
+    if (code & 2) {
+        delta += size >> 1;
+    }
+    if (code & 1) {
+        delta += size >> 2;
+    }
+    int32_t p = *predictor + (code & 8 ? -delta : delta);
+    *predictor = p > INT16_MAX ? INT16_MAX : (p < INT16_MIN ? INT16_MIN : p);
+
+    const int32_t i = *stepIndex + indexSteps[code & 7];
+    *stepIndex = i < 0 ? 0 : (i >= STEP_COUNT ? STEP_COUNT - 1 : i);
+}
+
+static inline unsigned codeAt(const AdpcmBlock* block, unsigned k)
+{
+    return (block->codes[k / 2] >> ((k & 1) * 4)) & 0xf;
+}
+
+void adpcmWrite(AdpcmBlock* line, size_t mask, AdpcmEncoder* enc, size_t pos,
+        CodecIntSample v)
+{
+    const size_t idx = pos & mask;
+    AdpcmBlock* block = &line[idx / ADPCM_BLOCK_LEN];
+    const unsigned k = idx % ADPCM_BLOCK_LEN;
+    if (!k) {
+        block->predictor = enc->predictor;
+        block->stepIndex = enc->stepIndex;
+    }
+
+    // Quantize the difference to the prediction in three binary steps
+    int32_t diff = v - enc->predictor;
+    unsigned code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    int32_t size = stepSizes[enc->stepIndex];
+    if (diff >= size) {
+        code |= 4;
+        diff -= size;
+    }
+    size >>= 1;
+    if (diff >= size) {
+        code |= 2;
+        diff -= size;
+    }
+    size >>= 1;
+    if (diff >= size) {
+        code |= 1;
+    }
+    step(&enc->predictor, &enc->stepIndex, code);
+
+    uint8_t* byte = &block->codes[k / 2];
+    *byte = k & 1 ? (*byte & 0x0f) | (code << 4) : code;
+}
+
+void adpcmDecode(const AdpcmBlock* line, size_t mask, size_t start,
+        unsigned count, CodecIntSample* out)
+{
+    size_t idx = start & mask;
+    while (count) {
+        const AdpcmBlock* block = &line[idx / ADPCM_BLOCK_LEN];
+        int32_t predictor = block->predictor;
+        int32_t stepIndex = block->stepIndex;
+
+        // Skip to the start position in its block, then decode up to the end
+        // of the block or the count
+        unsigned k = 0;
+        const unsigned first = idx % ADPCM_BLOCK_LEN;
+        for (; k < first; k++) {
+            step(&predictor, &stepIndex, codeAt(block, k));
+        }
+        for (; k < ADPCM_BLOCK_LEN && count; k++, count--) {
+            step(&predictor, &stepIndex, codeAt(block, k));
+            *out++ = predictor;
+        }
+        idx = (idx + k - first) & mask;
+    }
+}
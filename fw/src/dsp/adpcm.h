@@ -0,0 +1,58 @@
+#pragma once
+
+/**
+ * Delay line storage in 4 bit IMA ADPCM, a quarter of the size of int16
+ * samples, for long delays.
+ *
+ * The line is a ring of blocks of ADPCM_BLOCK_LEN samples. Each block starts
+ * with the state of the coder at its first sample, so decoding can start at any
+ * block rather than only at the start of the stream, and a read at any
+ * position decodes at most a block's worth of samples before it. Reads at
+ * fractional positions decode the range they cover into a small int16 buffer
+ * with adpcmDecode() and interpolate in that, with the functions in
+ * delayline.h.
+ *
+ * Writing rewrites the header of a block at its first sample, so the rest of
+ * the block the write position is in no longer decodes: a line of some
+ * capacity holds capacity - ADPCM_BLOCK_LEN samples of history.
+ *
+ * Positions are in samples and wrap with a mask, like in delayline.h.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "codec.h"
+
+/// Samples per block, each block is 4 bytes of header and 4 bits per sample
+#define ADPCM_BLOCK_LEN 64
+
+/// Number of blocks for a line of a capacity
+#define ADPCM_BLOCKS(capacity) ((capacity) / ADPCM_BLOCK_LEN)
+
+typedef struct {
+    int16_t predictor; ///< Value of the sample before the first
+    uint8_t stepIndex; ///< Step size of the first sample
+    uint8_t unused;
+    uint8_t codes[ADPCM_BLOCK_LEN / 2]; ///< Two samples a byte, low nibble first
+} AdpcmBlock;
+
+/// State of the encoder, carried from sample to sample
+typedef struct {
+    int32_t predictor;
+    int32_t stepIndex;
+} AdpcmEncoder;
+
+/**
+ * Encode one sample into the line at a position, the one after the previous
+ * sample written with the same encoder
+ */
+void adpcmWrite(AdpcmBlock* line, size_t mask, AdpcmEncoder* enc, size_t pos,
+        CodecIntSample v);
+
+/**
+ * Decode count samples, the first at position start, decoding the block that
+ * start is in from its beginning
+ */
+void adpcmDecode(const AdpcmBlock* line, size_t mask, size_t start,
+        unsigned count, CodecIntSample* out);
@@ -1,8 +1,10 @@
 #include "../dsp/biquad.h"
 
 #include <math.h>
+#include <string.h>
 
 #include "codec.h"
+#include "fastmath.h"
 
 /*
  * Some ideas from:
@@ -22,10 +24,11 @@ void bqMakeLowpass(FloatBiquadCoeffs* c, float w0, float q)
             a2 =   1 - alpha
      */
 
-    const float alpha = sinf(w0)/(2.0f*q);
+    float sinw0, cosw0;
+    fastSinCos(w0, &sinw0, &cosw0);
+    const float alpha = sinw0/(2.0f*q);
     const float a0 = 1.0f + alpha;
     const float a0inv = 1.0 / a0;
-    const float cosw0 = cosf(w0);
     c->gain = a0;
     c->a1 = -2.0f * cosw0 * a0inv;
     c->a2 = (1.0f - alpha) * a0inv;
@@ -45,10 +48,11 @@ void bqMakeBandpass(FloatBiquadCoeffs* c, float w0, float q)
             a2 =   1 - alpha
      */
 
-    const float alpha = sinf(w0)/(2.0f*q);
+    float sinw0, cosw0;
+    fastSinCos(w0, &sinw0, &cosw0);
+    const float alpha = sinw0/(2.0f*q);
     const float a0 = 1.0f + alpha;
     const float a0inv = 1.0 / a0;
-    const float cosw0 = cosf(w0);
     c->gain = a0;
     c->a1 = -2.0f * cosw0 * a0inv;
     c->a2 = (1.0f - alpha) * a0inv;
@@ -57,26 +61,179 @@ void bqMakeBandpass(FloatBiquadCoeffs* c, float w0, float q)
     c->b2 = -c->b0;
 }
 
+/**
+ * Run one Transposed Direct Form II stage over a buffer, both channels in
+ * lockstep so they share coefficient loads. If ramp is set the coefficients
+ * move linearly from c to target over the frame, and c is updated.
+ *
+ * in and out may be the same buffer.
+ */
+static inline __attribute__((always_inline)) void processStage(
+        const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        FloatBiquadCoeffs* c, const FloatBiquadCoeffs* target,
+        FloatBiquadState* state, const bool ramp)
+{
+    float b0 = c->gain * c->b0;
+    float b1 = c->b1;
+    float b2 = c->b2;
+    float a1 = c->a1;
+    float a2 = c->a2;
+
+    float db0 = 0, db1 = 0, db2 = 0, da1 = 0, da2 = 0;
+    if (ramp) {
+        const float step = 1.0f / CODEC_SAMPLES_PER_FRAME;
+        db0 = (target->gain * target->b0 - b0) * step;
+        db1 = (target->b1 - b1) * step;
+        db2 = (target->b2 - b2) * step;
+        da1 = (target->a1 - a1) * step;
+        da2 = (target->a2 - a2) * step;
+    }
+
+    float z1l = state->z[0][0];
+    float z1r = state->z[0][1];
+    float z2l = state->z[1][0];
+    float z2r = state->z[1][1];
+
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        const float xl = in->s[s][0];
+        const float xr = in->s[s][1];
+        const float yl = b0 * xl + z1l;
+        const float yr = b0 * xr + z1r;
+        z1l = b1 * xl - a1 * yl + z2l;
+        z1r = b1 * xr - a1 * yr + z2r;
+        z2l = b2 * xl - a2 * yl;
+        z2r = b2 * xr - a2 * yr;
+        out->s[s][0] = yl;
+        out->s[s][1] = yr;
+
+        if (ramp) {
+            b0 += db0;
+            b1 += db1;
+            b2 += db2;
+            a1 += da1;
+            a2 += da2;
+        }
+    }
+
+    state->z[0][0] = z1l;
+    state->z[0][1] = z1r;
+    state->z[1][0] = z2l;
+    state->z[1][1] = z2r;
+
+    if (ramp) {
+        // Land exactly on target rather than accumulating rounding errors
+        *c = *target;
+    }
+}
+
 void bqProcess(const FloatAudioBuffer* restrict in, FloatAudioBuffer* restrict out,
         const FloatBiquadCoeffs* c, FloatBiquadState* state)
+{
+    FloatBiquadCoeffs coeffs = *c;
+    processStage(in, out, &coeffs, c, state, false);
+}
+
+void bqCascadeInit(FloatBiquadCascade* cascade, unsigned stages)
+{
+    memset(cascade, 0, sizeof(*cascade));
+    cascade->stages = stages < BIQUAD_MAX_STAGES ? stages : BIQUAD_MAX_STAGES;
+    for (unsigned n = 0; n < BIQUAD_MAX_STAGES; n++) {
+        cascade->coeffs[n].gain = 1.0f;
+        cascade->coeffs[n].b0 = 1.0f;
+        cascade->target[n] = cascade->coeffs[n];
+    }
+}
+
+void bqCascadeSetStage(FloatBiquadCascade* cascade, unsigned stage,
+        const FloatBiquadCoeffs* c)
+{
+    if (stage < cascade->stages) {
+        cascade->target[stage] = *c;
+    }
+}
+
+void bqCascadeProcess(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, FloatBiquadCascade* cascade)
+{
+    if (!cascade->started) {
+        memcpy(cascade->coeffs, cascade->target, sizeof(cascade->coeffs));
+        cascade->started = true;
+    }
+
+    if (cascade->stages == 0) {
+        *out = *in;
+        return;
+    }
+
+    // The first stage reads the input, the rest run in place on the output
+    const FloatAudioBuffer* stageIn = in;
+    for (unsigned n = 0; n < cascade->stages; n++) {
+        FloatBiquadCoeffs* c = &cascade->coeffs[n];
+        const FloatBiquadCoeffs* target = &cascade->target[n];
+        if (memcmp(c, target, sizeof(*c))) {
+            processStage(stageIn, out, c, target, &cascade->state[n], true);
+        }
+        else {
+            processStage(stageIn, out, c, target, &cascade->state[n], false);
+        }
+        stageIn = out;
+    }
+}
+
+static q31_t toQ30(float v)
+{
+    const float scaled = v * (1 << 30);
+    if (scaled >= (float)INT32_MAX) return INT32_MAX;
+    if (scaled <= (float)INT32_MIN) return INT32_MIN;
+    return scaled;
+}
+
+void bqMakeFixed(FixedBiquadCoeffs* f, const FloatBiquadCoeffs* c)
+{
+    f->b0 = toQ30(c->gain * c->b0);
+    f->b1 = toQ30(c->b1);
+    f->b2 = toQ30(c->b2);
+    f->a1 = toQ30(c->a1);
+    f->a2 = toQ30(c->a2);
+}
+
+void bqProcessFixed(const AudioBuffer* restrict in, AudioBuffer* restrict out,
+        const FixedBiquadCoeffs* c, FixedBiquadState* state)
 {
     for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
-        float y[2];
-        y[0] = c->gain * c->b0*in->s[s][0] +
-                c->b1*state->X[0][0] + c->b2*state->X[1][0] -
-                c->a1*state->Y[0][0] - c->a2*state->Y[1][0];
-        y[1] = c->gain * c->b0*in->s[s][1] +
-                c->b1*state->X[0][1] + c->b2*state->X[1][1] -
-                c->a1*state->Y[0][1] - c->a2*state->Y[1][1];
-        out->s[s][0] = y[0];
-        out->s[s][1] = y[1];
-        state->X[1][0] = state->X[0][0];
-        state->X[0][0] = in->s[s][0];
-        state->Y[1][0] = state->Y[0][0];
-        state->Y[0][0] = y[0];
-        state->X[1][1] = state->X[0][1];
-        state->X[0][1] = in->s[s][1];
-        state->Y[1][1] = state->Y[0][1];
-        state->Y[0][1] = y[1];
+        for (unsigned ch = 0; ch < 2; ch++) {
+            // Q2.30 * Q23 accumulated in 64 bits, which is a run of SMLAL
+            const int32_t x = (int32_t)in->s[s][ch] << 8;
+            int64_t acc = (int64_t)c->b0 * x;
+            acc += (int64_t)c->b1 * state->X[0][ch];
+            acc += (int64_t)c->b2 * state->X[1][ch];
+            acc -= (int64_t)c->a1 * state->Y[0][ch];
+            acc -= (int64_t)c->a2 * state->Y[1][ch];
+            const int32_t y = acc >> 30;
+
+            out->s[s][ch] = ssat16(y >> 8);
+            state->X[1][ch] = state->X[0][ch];
+            state->X[0][ch] = x;
+            state->Y[1][ch] = state->Y[0][ch];
+            state->Y[0][ch] = y;
+        }
     }
 }
+
+static void cascadeNodeProcess(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        void* state, const void* params)
+{
+    FloatBiquadCascade* cascade = state;
+    const FloatBiquadCoeffs* coeffs = params;
+    for (unsigned stage = 0; stage < cascade->stages; stage++) {
+        bqCascadeSetStage(cascade, stage, &coeffs[stage]);
+    }
+    bqCascadeProcess(in, out, cascade);
+}
+
+const FxNodeType bqCascadeNode = {
+    .name = "biquad cascade",
+    .stateSize = sizeof(FloatBiquadCascade),
+    .heat = ARENA_HOT,
+    .process = cascadeNodeProcess
+};
@@ -1,5 +1,8 @@
 #pragma once
+#include <stdbool.h>
 #include "codec.h"
+#include "fixedpoint.h"
+#include "fxgraph.h"
 
 /**
  * Biquad coefficients for
@@ -17,13 +20,48 @@ typedef struct {
 } FloatBiquadCoeffs;
 
 /**
- * Stereo state for a biquad stage.
+ * Stereo state for a biquad stage, in Transposed Direct Form II.
+ * Indexed as z[delay][channel].
  */
 typedef struct {
-    float X[2][2];
-    float Y[2][2];
+    float z[2][2];
 } FloatBiquadState;
 
+/**
+ * Fixed point biquad coefficients in Q2.30, with the gain folded into b0.
+ */
+typedef struct {
+    q31_t a1, a2; // poles
+    q31_t b0, b1, b2; // zeros
+} FixedBiquadCoeffs;
+
+/**
+ * Stereo state for a fixed point biquad stage, in Direct Form I which doesn't
+ * overflow internally. Indexed as X[delay][channel]. Samples are kept with 8
+ * extra fractional bits (Q23) to keep down the noise at low frequencies.
+ */
+typedef struct {
+    int32_t X[2][2];
+    int32_t Y[2][2];
+} FixedBiquadState;
+
+#define BIQUAD_MAX_STAGES 8
+
+/**
+ * A cascade of biquad stages processing both channels in lockstep.
+ *
+ * Coefficients set with bqCascadeSetStage() are reached by interpolating
+ * linearly over the next frame, so they can be changed every frame without
+ * zipper noise.
+ */
+typedef struct {
+    unsigned stages;
+    bool started; ///< False until the first frame, when there is nothing to interpolate from
+    FloatBiquadCoeffs coeffs[BIQUAD_MAX_STAGES]; ///< Current coefficients
+    FloatBiquadCoeffs target[BIQUAD_MAX_STAGES]; ///< Coefficients at the end of the next frame
+    FloatBiquadState state[BIQUAD_MAX_STAGES];
+} FloatBiquadCascade;
+
 /**
  * Create a second-order resonant lowpass filter
  *
@@ -45,3 +83,43 @@ void bqMakeBandpass(FloatBiquadCoeffs* c, float w0, float q);
  */
 void bqProcess(const FloatAudioBuffer* restrict in, FloatAudioBuffer* restrict out,
         const FloatBiquadCoeffs* c, FloatBiquadState* state);
+
+/**
+ * Initialize a biquad cascade. All stages pass audio through unchanged until
+ * their coefficients are set.
+ *
+ * @param stages Number of stages, up to BIQUAD_MAX_STAGES
+ */
+void bqCascadeInit(FloatBiquadCascade* cascade, unsigned stages);
+
+/**
+ * Set the coefficients for one stage, to be reached at the end of the next
+ * frame processed.
+ */
+void bqCascadeSetStage(FloatBiquadCascade* cascade, unsigned stage,
+        const FloatBiquadCoeffs* c);
+
+/**
+ * Run all stages of a biquad cascade over a buffer.
+ */
+void bqCascadeProcess(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, FloatBiquadCascade* cascade);
+
+/**
+ * Convert biquad coefficients to fixed point. This is cheap enough to do once
+ * per frame.
+ */
+void bqMakeFixed(FixedBiquadCoeffs* f, const FloatBiquadCoeffs* c);
+
+/**
+ * Run a fixed point biquad filter directly on codec samples
+ */
+void bqProcessFixed(const AudioBuffer* restrict in, AudioBuffer* restrict out,
+        const FixedBiquadCoeffs* c, FixedBiquadState* state);
+
+/**
+ * Effect graph node running a FloatBiquadCascade, which the application
+ * initializes with the number of stages. The parameters are an array of
+ * FloatBiquadCoeffs, one for each stage.
+ */
+extern const FxNodeType bqCascadeNode;
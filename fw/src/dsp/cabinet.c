@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "cabinet.h"
+#include "cabinet_ir.h"
+
+#define B CABINET_PARTITION
+#define N CABINET_FFT_SIZE
+#define BINS CABINET_BINS
+
+_Static_assert(CABINET_FFT_PARTITIONS > 0, "Cabinet IR shorter than a frame");
+
+void initCabinet(CabinetState* st)
+{
+    memset(st, 0, sizeof(*st));
+
+    size_t len = sizeof(st->forwardMemory);
+    st->forward = kiss_fftr_alloc(N, false, st->forwardMemory, &len);
+    len = sizeof(st->inverseMemory);
+    st->inverse = kiss_fftr_alloc(N, true, st->inverseMemory, &len);
+    if (!st->forward || !st->inverse) {
+        printf("cabinet: FFT needs %u bytes\n", (unsigned)len);
+    }
+
+    cabinetLoad(st, cabinetDefaultIr, CABINET_DEFAULT_IR_LENGTH);
+}
+
+void cabinetLoad(CabinetState* st, const float* ir, unsigned length)
+{
+    if (length > CABINET_MAX_IR) {
+        printf("cabinet: IR cut from %u to %u samples\n", length,
+                CABINET_MAX_IR);
+        length = CABINET_MAX_IR;
+    }
+
+    memset(st->direct, 0, sizeof(st->direct));
+    memcpy(st->direct, ir, (length < B ? length : B) * sizeof(float));
+
+    // Overlap-save keeps the second half of the inverse transform, which is
+    // only the linear convolution if each partition is padded to the
+    // transform size. The inverse transform isn't scaled, so do it here.
+    st->partitionCount = 0;
+    for (unsigned start = B; start < length; start += B) {
+        memset(st->time, 0, sizeof(st->time));
+        const unsigned n = length - start < B ? length - start : B;
+        for (unsigned i = 0; i < n; i++) {
+            st->time[i] = ir[start + i] / N;
+        }
+        if (st->forward) {
+            kiss_fftr(st->forward, st->time, st->partitions[st->partitionCount]);
+        }
+        st->partitionCount++;
+    }
+
+    memset(st->history, 0, sizeof(st->history));
+    memset(st->spectra, 0, sizeof(st->spectra));
+    st->newest = 0;
+}
+
+/**
+ * Output of all partitions but the first for this frame, from the input of
+ * the previous frames
+ */
+static void convolvePartitions(CabinetState* st, unsigned channel)
+{
+    kiss_fft_cpx (*spectra)[BINS] = st->spectra[channel];
+    kiss_fftr(st->forward, st->history[channel], spectra[st->newest]);
+
+    memset(st->sum, 0, sizeof(st->sum));
+    unsigned pos = st->newest;
+    for (unsigned p = 0; p < st->partitionCount; p++) {
+        const kiss_fft_cpx* h = st->partitions[p];
+        const kiss_fft_cpx* x = spectra[pos];
+        for (unsigned k = 0; k < BINS; k++) {
+            st->sum[k].r += h[k].r * x[k].r - h[k].i * x[k].i;
+            st->sum[k].i += h[k].r * x[k].i + h[k].i * x[k].r;
+        }
+        pos = pos ? pos - 1 : CABINET_FFT_PARTITIONS - 1;
+    }
+
+    kiss_fftri(st->inverse, st->sum, st->time);
+}
+
+void processCabinet(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        CabinetState* st)
+{
+    const bool fft = st->partitionCount && st->forward && st->inverse;
+    if (fft) {
+        st->newest = st->newest + 1 < CABINET_FFT_PARTITIONS ?
+                st->newest + 1 : 0;
+    }
+
+    for (unsigned c = 0; c < 2; c++) {
+        float* history = st->history[c];
+
+        // The history holds the two frames before this one, just what the
+        // transform of the previous frame needs
+        if (fft) {
+            convolvePartitions(st, c);
+        }
+        else {
+            memset(st->time, 0, sizeof(st->time));
+        }
+
+        memmove(history, history + B, B * sizeof(float));
+        for (unsigned s = 0; s < B; s++) {
+            history[B + s] = in->s[s][c];
+        }
+
+        for (unsigned s = 0; s < B; s++) {
+            float v = st->time[B + s];
+            for (unsigned i = 0; i < B; i++) {
+                v += st->direct[i] * history[B + s - i];
+            }
+            out->s[s][c] = v;
+        }
+    }
+}
+
+static void nodeInit(void* state)
+{
+    initCabinet(state);
+}
+
+static void nodeProcess(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        void* state, const void* params)
+{
+    (void)params;
+    processCabinet(in, out, state);
+}
+
+const FxNodeType cabinetNode = {
+    .name = "cabinet",
+    .stateSize = sizeof(CabinetState),
+    .heat = ARENA_HOT,
+    .init = nodeInit,
+    .process = nodeProcess,
+    .flags = FXNODE_INPLACE
+};
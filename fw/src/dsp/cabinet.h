@@ -0,0 +1,90 @@
+#pragma once
+
+/**
+ * Guitar cabinet simulation by convolution with an impulse response. The
+ * response is cut into partitions of one frame. The first partition is
+ * applied directly, sample by sample, so that the convolution adds no latency.
+ * The later ones are applied with uniformly partitioned overlap-save: each
+ * frame the last two frames of input are transformed with kiss_fftr and kept
+ * in a delay line of spectra, every partition's spectrum is multiplied with
+ * the input spectrum of as many frames ago as the partition is from the
+ * start, and one inverse transform of the sum gives their share of the
+ * output. All memory is part of the state, nothing is allocated.
+ */
+
+#include "codec.h"
+#include "fft.h"
+#include "fxgraph.h"
+
+/// Longest impulse response that can be loaded, 25 ms
+#ifndef CABINET_MAX_IR
+#define CABINET_MAX_IR (CODEC_SAMPLERATE / 40)
+#endif
+
+/// Each partition is one frame of the impulse response
+#define CABINET_PARTITION CODEC_SAMPLES_PER_FRAME
+/// Partitions done with FFTs, all but the first
+#define CABINET_FFT_PARTITIONS \
+        ((CABINET_MAX_IR + CABINET_PARTITION - 1) / CABINET_PARTITION - 1)
+/// Transforms cover two partitions, the previous input frame and this one
+#define CABINET_FFT_SIZE (2 * CABINET_PARTITION)
+#define CABINET_BINS (CABINET_FFT_SIZE / 2 + 1)
+
+typedef struct {
+    /// First partition of the impulse response, applied directly
+    float direct[CABINET_PARTITION];
+    /// Spectra of the later partitions, scaled for the inverse transform
+    kiss_fft_cpx partitions[CABINET_FFT_PARTITIONS][CABINET_BINS];
+    /// Partitions in use by the loaded impulse response
+    unsigned partitionCount;
+
+    /// The previous input frame and this one, for each channel
+    float history[2][CABINET_FFT_SIZE];
+    /// Spectra of past input, a ring for each channel
+    kiss_fft_cpx spectra[2][CABINET_FFT_PARTITIONS][CABINET_BINS];
+    /// Position of the newest spectrum in the rings
+    unsigned newest;
+
+    kiss_fft_cpx sum[CABINET_BINS];
+    float time[CABINET_FFT_SIZE];
+    kiss_fftr_cfg forward;
+    kiss_fftr_cfg inverse;
+    uint8_t forwardMemory[FFT_REAL_MEMORY(CABINET_FFT_SIZE)];
+    uint8_t inverseMemory[FFT_REAL_MEMORY(CABINET_FFT_SIZE)];
+} CabinetState;
+
+/**
+ * Initialize the cabinet simulation with the default impulse response from
+ * cabinet_ir.h, generated at build time by make_cabinet.py, creating a
+ * predictable state
+ *
+ * @param state State structure to initialize. Should be allocated by the caller
+ * and passed to subsequent calls to processCabinet().
+ */
+void initCabinet(CabinetState* state);
+
+/**
+ * Load another impulse response, clearing the input history. Must not run at
+ * the same time as processCabinet().
+ *
+ * @param ir Impulse response at CODEC_SAMPLERATE. Samples beyond
+ *        CABINET_MAX_IR are ignored.
+ */
+void cabinetLoad(CabinetState* state, const float* ir, unsigned length);
+
+/**
+ * Run the cabinet simulation over a buffer of stereo samples, convolving
+ * each channel with the impulse response. in and out may be the same buffer.
+ *
+ * @param in Pointer to input samples
+ * @param out Pointer to output samples
+ * @param state Mutable state of the effect
+ */
+void processCabinet(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        CabinetState* state);
+
+/**
+ * Effect graph node running the cabinet simulation, with a CabinetState as
+ * state and no parameters
+ */
+extern const FxNodeType cabinetNode;
@@ -1,73 +1,553 @@
+#include <math.h>
 #include <string.h>
 
 #include "delay.h"
+#include "fixedpoint.h"
 #include "utils.h"
 #include "waveshaper.h"
 
 #define TAPS 4
 
+/// Phases of the LFO for the confusion taps, all but the first tap
+static const float wobbleOffsets[TAPS - 1] = { 0, 2*M_PI/3, -2*M_PI/3 };
+
+#if DELAY_ADPCM
+#define MASK (DELAY_LINELEN - 1)
+_Static_assert(DELAYLINE_IS_POW2(DELAY_LINELEN), "Delay line must be a power of two");
+#endif
+
+/// Routing of each tap, levels to play the L/R delay lines in the L/R
+/// channel. All but the first are scaled by confusion.
+static const float tapRoutes[TAPS][2][2] = {
+        { { 1.0f, 0.0f }, { 0.0f, 1.0f } },
+        { { 0.0f, -1.0f }, { 0.5f, 0.0f } },
+        { { 0.0f, 0.3f }, { -0.6f, 0.0f } },
+        { { 0.1f, -0.2f }, { -0.2f, 0.1f } },
+};
+
+/// Samples past its position that a read may take, with the octaver's kernel
+#define READ_AHEAD (INTERP_LOOKAHEAD(DELAY_OCTAVER_INTERP) + 1)
+
+/// Samples before and after a position that any of the reads take
+#define WINDOW_BEHIND (INTERP_MAX_TAPS/2 - 1)
+#define WINDOW_AHEAD (INTERP_MAX_TAPS/2)
+
+/// Enough samples for a span of reads moving on by up to two samples each
+#define WINDOW_LEN (2 * CODEC_SAMPLES_PER_FRAME + INTERP_MAX_TAPS)
+
+/**
+ * Samples of both delay lines for reading positions in a range. With int16
+ * storage these are the lines themselves, unless the range crosses the end of
+ * the line, with ADPCM storage the range decoded into buffers.
+ */
+struct Window {
+    const CodecIntSample* samples[2];
+    size_t mask;
+    float offset; ///< Position of samples[c][0]
+    float end; ///< Positions from here on are outside the window
+    CodecIntSample buffer[2][WINDOW_LEN];
+};
+
+#if !DELAY_ADPCM
+/**
+ * Copy len samples of a line from a position that may be outside it, wrapping
+ * around its end
+ */
+static void copyWrapped(const CodecIntSample* line, ptrdiff_t start,
+        unsigned len, CodecIntSample* out)
+{
+    while (start < 0) {
+        start += DELAY_LINELEN;
+    }
+    while (start >= DELAY_LINELEN) {
+        start -= DELAY_LINELEN;
+    }
+    const unsigned first = DELAY_LINELEN - start < len ?
+            DELAY_LINELEN - start : len;
+    memcpy(out, &line[start], first * sizeof(*out));
+    memcpy(&out[first], line, (len - first) * sizeof(*out));
+}
+#endif
+
+/**
+ * Make the window cover the positions from pos to pos + span, or as many of
+ * them as fit
+ */
+static inline void openWindow(struct Window* w, const DelayState* st,
+        float pos, float span)
+{
+#if DELAY_ADPCM
+    const size_t start = (size_t)pos - WINDOW_BEHIND;
+    unsigned len = (unsigned)span + WINDOW_BEHIND + WINDOW_AHEAD + 2;
+    if (len > WINDOW_LEN) {
+        len = WINDOW_LEN;
+    }
+    adpcmDecode(st->delayline_l, MASK, start, len, w->buffer[0]);
+    adpcmDecode(st->delayline_r, MASK, start, len, w->buffer[1]);
+    w->samples[0] = w->buffer[0];
+    w->samples[1] = w->buffer[1];
+    w->mask = SIZE_MAX;
+    w->offset = start;
+    w->end = start + len - WINDOW_AHEAD;
+#else
+    // Positions run up to twice the length. Read in place from the line or
+    // from its second lap, where the range stays within the array.
+    const float lap = pos >= DELAY_LINELEN + WINDOW_BEHIND ? DELAY_LINELEN : 0;
+    w->mask = SIZE_MAX;
+    w->end = lap + DELAY_LINELEN + DELAYLINE_GUARD - WINDOW_AHEAD;
+    if (pos >= lap + WINDOW_BEHIND && pos + span < w->end) {
+        w->samples[0] = st->delayline_l;
+        w->samples[1] = st->delayline_r;
+        w->offset = lap;
+        return;
+    }
+
+    const ptrdiff_t start = (ptrdiff_t)floorf(pos) - WINDOW_BEHIND;
+    unsigned len = (unsigned)span + WINDOW_BEHIND + WINDOW_AHEAD + 2;
+    if (len > WINDOW_LEN) {
+        len = WINDOW_LEN;
+    }
+    copyWrapped(st->delayline_l, start, len, w->buffer[0]);
+    copyWrapped(st->delayline_r, start, len, w->buffer[1]);
+    w->samples[0] = w->buffer[0];
+    w->samples[1] = w->buffer[1];
+    w->offset = start;
+    w->end = start + len - WINDOW_AHEAD;
+#endif
+}
+
+static inline bool inWindow(const struct Window* w, float pos)
+{
+    return pos >= w->offset + WINDOW_BEHIND && pos < w->end;
+}
+
+/**
+ * Write a sample to each line at the write position
+ */
+static inline void writeLines(DelayState* st, CodecIntSample l,
+        CodecIntSample r)
+{
+#if DELAY_ADPCM
+    adpcmWrite(st->delayline_l, MASK, &st->encoders[0], st->writepos, l);
+    adpcmWrite(st->delayline_r, MASK, &st->encoders[1], st->writepos, r);
+#else
+    delayLineWriteIndex(st->delayline_l, DELAY_LINELEN, st->writepos, l);
+    delayLineWriteIndex(st->delayline_r, DELAY_LINELEN, st->writepos, r);
+#endif
+}
+
+/**
+ * Move the write position on by a sample
+ */
+static inline void advance(DelayState* st)
+{
+    if (++st->writepos == DELAY_LINELEN) {
+        st->writepos = 0;
+    }
+}
+
 struct Tap {
-    float delay;
-    float route[2][2]; // Levels to play L/R delay lines in L/R channel
+    float delay; ///< At the first sample of the frame
+    float step; ///< Added to the delay each sample
+    float route[2][2];
 };
 
+/**
+ * Compute the factors of the confusion tap delays for a frame
+ *
+ * @return False if the taps stay still, with wobble left unset
+ */
+static bool makeWobble(DelayState* st, const DelayParams* p,
+        const FloatAudioBuffer* in,
+        float wobble[TAPS - 1][CODEC_SAMPLES_PER_FRAME])
+{
+    if (!p->wobble) {
+        return false;
+    }
+
+    lfoProcess(&st->lfo, &p->lfo, in, wobbleOffsets, TAPS - 1, wobble);
+    for (unsigned tap = 0; tap < TAPS - 1; tap++) {
+        for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+            wobble[tap][s] = 1.0f + p->wobble * wobble[tap][s];
+        }
+    }
+    return true;
+}
+
+/**
+ * Read both lines at n positions from pos on, moving on by speed each, in as
+ * many windows as it takes
+ */
+static void readRamp(const DelayState* st, float pos, float speed, unsigned n,
+        float* l, float* r)
+{
+    struct Window win;
+    while (n) {
+        unsigned m = n;
+        // Fast changes of the length read more than a window
+        const float reach = WINDOW_LEN - WINDOW_BEHIND - WINDOW_AHEAD - 2;
+        if (fabsf(speed) * (m - 1) > reach) {
+            m = reach / fabsf(speed) + 1;
+        }
+        const float span = speed * (m - 1);
+        openWindow(&win, st, speed < 0 ? pos + span : pos, fabsf(span));
+        delayLineReadRamp(win.samples[0], win.mask, pos - win.offset, speed,
+                m, l);
+        delayLineReadRamp(win.samples[1], win.mask, pos - win.offset, speed,
+                m, r);
+        pos += speed * m;
+        l += m;
+        r += m;
+        n -= m;
+    }
+}
+
+/**
+ * Set up the taps for a frame over which the length moves on from
+ * startLength + lengthStep by lengthStep per sample
+ *
+ * @return Number of taps to read, leaving out those without a level or a delay
+ */
+static unsigned setupTaps(struct Tap* taps, const DelayParams* p,
+        float startLength, float lengthStep)
+{
+    unsigned tapCount = p->confusion ? TAPS : 1;
+    if (!startLength && !lengthStep) {
+        tapCount = 0;
+    }
+    for (unsigned tap = 0; tap < tapCount; tap++) {
+        taps[tap].delay = (startLength + lengthStep) / (tap + 1);
+        taps[tap].step = lengthStep / (tap + 1);
+        const float level = tap ? p->confusion : 1.0f;
+        for (unsigned c = 0; c < 2; c++) {
+            for (unsigned d = 0; d < 2; d++) {
+                taps[tap].route[c][d] = level * tapRoutes[tap][c][d];
+            }
+        }
+    }
+    return tapCount;
+}
+
+/**
+ * The shortest delay of any of the taps over a frame, for the shortest length
+ */
+static float shortestDelay(const DelayParams* p, unsigned tapCount,
+        float length)
+{
+    if (!tapCount) {
+        return DELAY_MAX_LENGTH;
+    }
+    const float wobbleLow = tapCount > 1 ? 1.0f - fabsf(p->wobble) : 1.0f;
+    return length / tapCount * wobbleLow;
+}
+
+/**
+ * Add the taps to a span of the output, with the delays at sample s of the
+ * frame and on, and scaled by the gains of the frame unless those are NULL
+ */
+static void readTaps(const DelayState* st, const struct Tap* taps,
+        unsigned tapCount, const float wobble[TAPS - 1][CODEC_SAMPLES_PER_FRAME],
+        const float* gain, unsigned s, unsigned n,
+        FloatAudioBuffer* restrict out)
+{
+    const float base = DELAY_LINELEN + st->writepos;
+    float l[CODEC_SAMPLES_PER_FRAME];
+    float r[CODEC_SAMPLES_PER_FRAME];
+
+    for (unsigned tap = 0; tap < tapCount; tap++) {
+        const struct Tap* t = &taps[tap];
+        const float delay = t->delay + t->step * s;
+        if (tap && wobble) {
+            // The LFO moves the position by more than a ramp
+            const float* w = wobble[tap - 1];
+            struct Window win;
+            openWindow(&win, st, base - delay * w[s], n);
+            for (unsigned i = 0; i < n; i++) {
+                const float pos = base + i - (delay + t->step * i) * w[s + i];
+                if (!inWindow(&win, pos)) {
+                    openWindow(&win, st, pos, n - i);
+                }
+                l[i] = delayLineRead(win.samples[0], win.mask, pos - win.offset);
+                r[i] = delayLineRead(win.samples[1], win.mask, pos - win.offset);
+            }
+        }
+        else {
+            readRamp(st, base - delay, 1 - t->step, n, l, r);
+        }
+
+        if (gain) {
+            for (unsigned i = 0; i < n; i++) {
+                l[i] *= gain[s + i];
+                r[i] *= gain[s + i];
+            }
+        }
+
+        if (!tap) {
+            // The first tap plays each line in its own channel
+            for (unsigned i = 0; i < n; i++) {
+                out->s[s + i][0] += l[i];
+                out->s[s + i][1] += r[i];
+            }
+        }
+        else {
+            for (unsigned i = 0; i < n; i++) {
+                out->s[s + i][0] += t->route[0][0] * l[i] + t->route[0][1] * r[i];
+                out->s[s + i][1] += t->route[1][0] * l[i] + t->route[1][1] * r[i];
+            }
+        }
+    }
+}
+
 void processDelay(const FloatAudioBuffer* restrict in,
         FloatAudioBuffer* restrict out, DelayState* st,
         const DelayParams* p)
 {
+    float wobbleFactors[TAPS - 1][CODEC_SAMPLES_PER_FRAME];
+    const float (*wobble)[CODEC_SAMPLES_PER_FRAME] =
+            makeWobble(st, p, in, wobbleFactors) ? wobbleFactors : NULL;
+
+    // With fade, the length jumps to a new value and the taps crossfade from
+    // read heads at the old length. The next change waits for the crossfade.
+    if (p->fade && !st->fadeLeft &&
+            fabsf(p->length - st->filteredLength) * DELAY_MAX_LENGTH >= 1) {
+        st->fadeLength = st->filteredLength;
+        st->filteredLength = p->length;
+        st->fadeLeft = DELAY_FADE_FRAMES;
+    }
+
+    // Otherwise run the length smoothing filter once for the whole frame and
+    // ramp the length linearly over it, rather than filtering per sample.
+    // Sample s takes the length at s + 1, like after a filter step per sample.
+    const float startLength = st->filteredLength * DELAY_MAX_LENGTH;
+    if (!st->fadeLeft) {
+        const float decay = powf(0.9999f, CODEC_SAMPLES_PER_FRAME);
+        st->filteredLength = decay * st->filteredLength +
+                (1.0f - decay) * p->length;
+    }
+    const float endLength = st->filteredLength * DELAY_MAX_LENGTH;
+    const float lengthStep = (endLength - startLength) / CODEC_SAMPLES_PER_FRAME;
+
+    struct Tap taps[TAPS];
+    const unsigned tapCount = setupTaps(taps, p, startLength, lengthStep);
+    float shortestTap = shortestDelay(p, tapCount, fminf(startLength, endLength));
+
+    // Equal power gains of the crossfade, and the taps fading out
+    struct Tap fadeTaps[TAPS];
+    unsigned fadeTapCount = 0;
+    float fadeIn[CODEC_SAMPLES_PER_FRAME];
+    float fadeOut[CODEC_SAMPLES_PER_FRAME];
+    if (st->fadeLeft) {
+        const float fadeLength = st->fadeLength * DELAY_MAX_LENGTH;
+        fadeTapCount = setupTaps(fadeTaps, p, fadeLength, 0);
+        shortestTap = fminf(shortestTap,
+                shortestDelay(p, fadeTapCount, fadeLength));
+
+        const float done = DELAY_FADE_FRAMES - st->fadeLeft;
+        for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+            const float x = (done + (s + 1.0f) / CODEC_SAMPLES_PER_FRAME) /
+                    DELAY_FADE_FRAMES;
+            fastSinCos(x * (float)(M_PI/2), &fadeIn[s], &fadeOut[s]);
+        }
+    }
+
+    const float octaveMix = p->octaveMix;
+
+    // The frame goes in spans that only read samples from before the span, so
+    // that each span can read all taps first and then write the line. The
+    // octaver closes in on the write position at one sample per sample,
+    // which makes the spans short just before it restarts.
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; ) {
+        float limit = shortestTap - READ_AHEAD;
+        if (octaveMix) {
+            const float octaverDelay = startLength + lengthStep * (s + 1) -
+                    st->octaverPhase - fabsf(endLength - startLength);
+            limit = fminf(limit, 0.5f * (octaverDelay - READ_AHEAD));
+        }
+        const unsigned n = limit >= CODEC_SAMPLES_PER_FRAME - s ?
+                CODEC_SAMPLES_PER_FRAME - s : (limit >= 1 ? (unsigned)limit : 1);
+
+        readTaps(st, taps, tapCount, wobble, st->fadeLeft ? fadeIn : NULL, s, n,
+                out);
+        readTaps(st, fadeTaps, fadeTapCount, wobble, fadeOut, s, n, out);
+
+        // The octaver reads at two samples per sample, from a window opened
+        // afresh after each restart. Windows don't outlive the span, as the
+        // writes after it change the line under them.
+        struct Window win;
+        if (octaveMix) {
+            openWindow(&win, st, DELAY_LINELEN + st->writepos -
+                    (startLength + lengthStep * (s + 1)) + st->octaverPhase,
+                    2 * n);
+        }
+        for (unsigned i = s; i < s + n; i++) {
+            const float length = startLength + lengthStep * (i + 1);
+            if (octaveMix) {
+                // FIXME: There is a discontinuity when octaverPhase wraps.
+                const float octaverPos = DELAY_LINELEN + st->writepos + (i - s) -
+                        length + st->octaverPhase;
+                if (!inWindow(&win, octaverPos)) {
+                    openWindow(&win, st, octaverPos, 2 * (s + n - i));
+                }
+                out->s[i][0] += octaveMix * delayLineReadInterp(win.samples[0],
+                        win.mask, octaverPos - win.offset, DELAY_OCTAVER_INTERP);
+                out->s[i][1] += octaveMix * delayLineReadInterp(win.samples[1],
+                        win.mask, octaverPos - win.offset, DELAY_OCTAVER_INTERP);
+            }
+
+            // Also restarts when the length shrinks below the phase. The
+            // interpolation mustn't reach the sample about to be written.
+            if (++st->octaverPhase + INTERP_LOOKAHEAD(DELAY_OCTAVER_INTERP) >=
+                    (size_t)length) {
+                st->octaverPhase = 0;
+            }
+        }
+
+        for (unsigned i = s; i < s + n; i++) {
+            writeLines(st,
+                    saturateSoft(p->input * in->s[i][0] + p->feedback * out->s[i][0]),
+                    saturateSoft(p->input * in->s[i][1] + p->feedback * out->s[i][1]));
+            advance(st);
+
+            // Always feed through the input audio
+            out->s[i][0] += in->s[i][0];
+            out->s[i][1] += in->s[i][1];
+        }
+
+        s += n;
+    }
+
+    if (st->fadeLeft) {
+        st->fadeLeft--;
+    }
+}
+
+#if DELAY_ADPCM
+
+void processDelayFixed(const AudioBuffer* restrict in,
+        AudioBuffer* restrict out, DelayState* st,
+        const DelayParams* p)
+{
+    // The lines only decode to int16 a range at a time, which the floating
+    // point version already does
+    FloatAudioBuffer fin;
+    FloatAudioBuffer fout = { 0 };
+    samplesToFloat(in, &fin);
+    processDelay(&fin, &fout, st, p);
+    for (unsigned s = 0; s < 2 * CODEC_SAMPLES_PER_FRAME; s++) {
+        out->m[s] = ssat16(fout.m[s]);
+    }
+}
+
+#else
+
+/**
+ * Read the line at a delay in Q16.16 samples behind the write position
+ */
+static inline int32_t readFixed(const CodecIntSample* line, size_t writepos,
+        uint32_t delay)
+{
+    const uint32_t length = (uint32_t)DELAY_LINELEN << 16;
+    const uint32_t pos = ((uint32_t)(DELAY_LINELEN + writepos) << 16) - delay;
+    return delayLineReadFixed(line, SIZE_MAX, pos >= length ? pos - length : pos);
+}
+
+void processDelayFixed(const AudioBuffer* restrict in,
+        AudioBuffer* restrict out, DelayState* st,
+        const DelayParams* p)
+{
+    // Run the length smoothing filter once for the whole frame and ramp the
+    // length linearly over it, rather than filtering per sample.
+    const float decay = powf(0.9999f, CODEC_SAMPLES_PER_FRAME);
+    const float startLength = st->filteredLength * DELAY_LINELEN;
+    st->filteredLength = decay * st->filteredLength + (1.0f - decay) * p->length;
+    const float endLength = st->filteredLength * DELAY_LINELEN;
+
+    // Per-frame setup of the taps, with delays in Q16.16 samples and routing
+    // as pairs of Q15 values for SMLAD
+    uint32_t delay[TAPS];
+    int32_t delayStep[TAPS];
+    uint32_t route[TAPS][2];
+    for (unsigned tap = 0; tap < TAPS; tap++) {
+        delay[tap] = startLength * 65536 / (tap + 1);
+        delayStep[tap] = (endLength - startLength) * 65536 /
+                ((tap + 1) * CODEC_SAMPLES_PER_FRAME);
+        const float level = tap ? p->confusion : 1.0f;
+        for (unsigned c = 0; c < 2; c++) {
+            route[tap][c] = pack16(FLOAT_TO_Q15(level * tapRoutes[tap][c][0]),
+                    FLOAT_TO_Q15(level * tapRoutes[tap][c][1]));
+        }
+    }
+    const int32_t octaveMix = FLOAT_TO_Q15(p->octaveMix);
+    const int32_t input = FLOAT_TO_Q15(p->input);
+    const int32_t feedback = FLOAT_TO_Q15(p->feedback);
+
     for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
-        st->filteredLength = 0.9999f * st->filteredLength + 0.0001f * p->length;
-        const float length = st->filteredLength * DELAY_LINELEN;
-
-        const struct Tap taps[TAPS] = {
-                { length,
-                        { { 1.0f, 0.0f },
-                        { 0.0f, 1.0f } } },
-                { length / 2,
-                        { { 0.0f, -1.0f * p->confusion },
-                        { 0.5f * p->confusion, 0.0f } } },
-                { length / 3,
-                        { { 0.0f, 0.3f * p->confusion },
-                        { -0.6f * p->confusion, 0.0f } } },
-                { length / 4,
-                        { { 0.1f * p->confusion, -0.2f * p->confusion },
-                        { -0.2f * p->confusion, 0.1f * p->confusion } } },
-        };
+        int32_t wet[2] = { 0, 0 };
 
         for (unsigned tap = 0; tap < TAPS; tap++) {
-            if (taps[tap].delay) {
-                float delayed[2] = { linterpolate(st->delayline_l, DELAY_LINELEN,
-                        DELAY_LINELEN + st->writepos - taps[tap].delay),
-                        linterpolate(st->delayline_r, DELAY_LINELEN,
-                                DELAY_LINELEN + st->writepos - taps[tap].delay) };
-                out->s[s][0] += taps[tap].route[0][0] * delayed[0] +
-                        taps[tap].route[0][1] * delayed[1];
-                out->s[s][1] += taps[tap].route[1][0] * delayed[0] +
-                        taps[tap].route[1][1] * delayed[1];
+            if (delay[tap]) {
+                const uint32_t delayed = pack16(
+                        readFixed(st->delayline_l, st->writepos, delay[tap]),
+                        readFixed(st->delayline_r, st->writepos, delay[tap]));
+                wet[0] += smlad(delayed, route[tap][0], 0) >> 15;
+                wet[1] += smlad(delayed, route[tap][1], 0) >> 15;
             }
         }
 
+        // Restart the octaver when the length shrinks below its phase, like
+        // processDelay() does, rather than read at a wrapped around delay.
         // FIXME: There is a discontinuity when octaverPhase wraps.
-        out->s[s][0] += p->octaveMix * linterpolate(st->delayline_l, DELAY_LINELEN,
-                DELAY_LINELEN + st->writepos - length + st->octaverPhase);
-        out->s[s][1] += p->octaveMix * linterpolate(st->delayline_r, DELAY_LINELEN,
-                DELAY_LINELEN + st->writepos - length + st->octaverPhase);
+        if (st->octaverPhase > delay[0] >> 16) {
+            st->octaverPhase = 0;
+        }
+        const uint32_t octaverDelay = delay[0] - (st->octaverPhase << 16);
+        wet[0] += (octaveMix * readFixed(st->delayline_l, st->writepos,
+                octaverDelay)) >> 15;
+        wet[1] += (octaveMix * readFixed(st->delayline_r, st->writepos,
+                octaverDelay)) >> 15;
+
+        writeLines(st,
+                saturateSoftFixed((input * in->s[s][0] + feedback * wet[0]) >> 15),
+                saturateSoftFixed((input * in->s[s][1] + feedback * wet[1]) >> 15));
 
-        st->delayline_l[st->writepos] = saturateSoft(p->input * in->s[s][0] +
-                p->feedback * out->s[s][0]);
-        st->delayline_r[st->writepos] = saturateSoft(p->input * in->s[s][1] +
-                p->feedback * out->s[s][1]);
+        if (++st->octaverPhase >= delay[0] >> 16) {
+            st->octaverPhase = 0;
+        }
+        advance(st);
 
-        st->octaverPhase = (st->octaverPhase + 1) % (size_t)length;
-        st->writepos = (st->writepos + 1) % DELAY_LINELEN;
+        for (unsigned tap = 0; tap < TAPS; tap++) {
+            delay[tap] += delayStep[tap];
+        }
 
         // Always feed through the input audio
-        out->s[s][0] += in->s[s][0];
-        out->s[s][1] += in->s[s][1];
+        out->s[s][0] = ssat16(in->s[s][0] + wet[0]);
+        out->s[s][1] = ssat16(in->s[s][1] + wet[1]);
     }
 }
 
+#endif
+
 void initDelay(DelayState* state)
 {
     memset(state, 0, sizeof(*state));
+    initLfo(&state->lfo);
 }
+
+static void nodeInit(void* state)
+{
+    initDelay(state);
+}
+
+static void nodeProcess(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        void* state, const void* params)
+{
+    processDelay(in, out, state, params);
+}
+
+const FxNodeType delayNode = {
+    .name = "delay",
+    .stateSize = sizeof(DelayState),
+    .heat = ARENA_COLD,
+    .init = nodeInit,
+    .process = nodeProcess
+};
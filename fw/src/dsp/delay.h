@@ -1,15 +1,63 @@
 #pragma once
 
+#include "adpcm.h"
 #include "codec.h"
+#include "delayline.h"
+#include "fxgraph.h"
+#include "lfo.h"
 
-#define DELAY_LINELEN (CODEC_SAMPLERATE/2)
+/**
+ * Storage of the delay lines. 0 keeps int16 samples, 1 keeps 4 bit ADPCM (see
+ * adpcm.h), which makes the lines nearly three times as long in less RAM at a
+ * signal to noise ratio of some 36 dB on guitar (see tests/bench_adpcm.c),
+ * and costs decoding the samples each tap reads. The fixed point version runs
+ * the floating point one with ADPCM.
+ */
+#ifndef DELAY_ADPCM
+#define DELAY_ADPCM 0
+#endif
+
+#if DELAY_ADPCM
+// 1.4 seconds at 48 kHz, 2 seconds at 32 kHz, in 72 KB
+#define DELAY_LINELEN 65536
+// Leaves out the block being written and the one the reads may reach into
+#define DELAY_MAX_LENGTH (DELAY_LINELEN - 2 * ADPCM_BLOCK_LEN)
+#else
+// Half a second, or a quarter at 96 kHz, where two lines of half a second
+// wouldn't fit in RAM. Not a power of two, so positions wrap with a compare.
+#define DELAY_LINELEN \
+        (CODEC_SAMPLERATE / 2 < 24000 ? CODEC_SAMPLERATE / 2 : 24000)
+#define DELAY_MAX_LENGTH DELAY_LINELEN
+// processDelayFixed() reads at positions up to twice the length in Q16.16
+_Static_assert(2 * DELAY_LINELEN <= 65536,
+        "Delay line too long for Q16.16 positions");
+#endif
+
+/// Length of the crossfade to a new length with DelayParams.fade, about 20 ms
+#define DELAY_FADE_FRAMES \
+        ((CODEC_SAMPLERATE / 50 + CODEC_SAMPLES_PER_FRAME - 1) / CODEC_SAMPLES_PER_FRAME)
+
+/// Interpolation of the octaver in the floating point version. The taps and
+/// the fixed point version interpolate linearly.
+#ifndef DELAY_OCTAVER_INTERP
+#define DELAY_OCTAVER_INTERP INTERP_HERMITE
+#endif
 
 typedef struct {
-    CodecIntSample delayline_l[DELAY_LINELEN];
-    CodecIntSample delayline_r[DELAY_LINELEN];
+#if DELAY_ADPCM
+    AdpcmBlock delayline_l[ADPCM_BLOCKS(DELAY_LINELEN)];
+    AdpcmBlock delayline_r[ADPCM_BLOCKS(DELAY_LINELEN)];
+    AdpcmEncoder encoders[2];
+#else
+    CodecIntSample delayline_l[DELAYLINE_STORAGE(DELAY_LINELEN)];
+    CodecIntSample delayline_r[DELAYLINE_STORAGE(DELAY_LINELEN)];
+#endif
     float filteredLength;
+    float fadeLength; ///< Length the crossfade started from
+    unsigned fadeLeft; ///< Frames of the crossfade left
     size_t writepos;
     size_t octaverPhase;
+    LfoState lfo;
 } DelayState;
 
 typedef struct {
@@ -17,7 +65,15 @@ typedef struct {
     float confusion;
     float feedback;
     float octaveMix;
-    float length;
+    float length; ///< Fraction of DELAY_MAX_LENGTH, from 0 to 1
+    /// Fraction of their delay by which the LFO moves the confusion taps, each
+    /// a third of a period apart. 0 for none, below 1.
+    float wobble;
+    LfoParams lfo;
+    /// Go to a new length with a crossfade between read heads at the old and
+    /// the new length rather than gliding there, for exact lengths such as
+    /// from a tap tempo. The fixed point version glides anyway.
+    bool fade;
 } DelayParams;
 
 /**
@@ -39,3 +95,25 @@ void initDelay(DelayState* state);
 void processDelay(const FloatAudioBuffer* restrict in,
         FloatAudioBuffer* restrict out, DelayState* state,
         const DelayParams* params);
+
+/**
+ * Fixed point version of processDelay(), working directly on codec samples.
+ * It shares the state with the floating point version. Unlike processDelay()
+ * it writes the whole output, which is the input plus the delayed signal, and
+ * it leaves the confusion taps still. With DELAY_ADPCM it converts the buffers
+ * and runs processDelay().
+ *
+ * @param in Pointer to input samples
+ * @param out Pointer to output samples
+ * @param state Mutable state of the effect, such as the delay line data
+ * @param param Input parameters to the effect
+ */
+void processDelayFixed(const AudioBuffer* restrict in,
+        AudioBuffer* restrict out, DelayState* state,
+        const DelayParams* params);
+
+/**
+ * Effect graph node running the delay, with a DelayState as state and
+ * DelayParams as parameters
+ */
+extern const FxNodeType delayNode;
@@ -0,0 +1,244 @@
+#pragma once
+
+/**
+ * Delay lines as ring buffers with a power of two capacity, so that positions
+ * wrap with a mask rather than a division.
+ *
+ * A line of some capacity is an array of DELAYLINE_STORAGE(capacity) samples:
+ * the ring itself followed by a guard region mirroring its first
+ * DELAYLINE_GUARD samples. The write functions keep the mirror up to date, so
+ * an interpolating read can take the samples following a masked position
+ * straight from the array without wrapping again.
+ *
+ * Positions are in samples from the start of the ring and must not be
+ * negative. Reading at a delay behind the write position is done at
+ * writepos + capacity - delay. The mask is capacity - 1.
+ *
+ * Besides the linear reads there are reads with any of the kernels in
+ * interpolation.h. A kernel reads samples on both sides of the position, so
+ * with a delay under INTERP_LOOKAHEAD(kernel) + 1 it would take samples that
+ * haven't been written yet.
+ *
+ * A line whose capacity isn't a power of two wraps its positions itself, with
+ * a compare rather than a mask. It writes with delayLineWriteIndex() and reads
+ * with a mask of SIZE_MAX at positions that stay within the array.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "codec.h"
+#include "fixedpoint.h"
+#include "interpolation.h"
+
+/// Samples after the end of the ring that mirror its start
+#define DELAYLINE_GUARD 8
+
+/// Array length for a delay line of a capacity
+#define DELAYLINE_STORAGE(capacity) ((capacity) + DELAYLINE_GUARD)
+
+_Static_assert(DELAYLINE_GUARD >= INTERP_MAX_TAPS - 1,
+        "Guard region too small for the interpolation kernels");
+
+/// For static asserts on capacities
+#define DELAYLINE_IS_POW2(capacity) \
+        ((capacity) >= DELAYLINE_GUARD && ((capacity) & ((capacity) - 1)) == 0)
+
+/**
+ * Index in the mirror for a masked position, or the position itself when it
+ * isn't mirrored, so that writing both doesn't take a branch
+ */
+static inline size_t delayLineMirror(size_t idx, size_t mask)
+{
+    return idx + (idx < DELAYLINE_GUARD ? mask + 1 : 0);
+}
+
+static inline void delayLineWrite(CodecIntSample* line, size_t mask,
+        size_t pos, CodecIntSample v)
+{
+    const size_t idx = pos & mask;
+    line[idx] = v;
+    line[delayLineMirror(idx, mask)] = v;
+}
+
+/**
+ * Write at an index below the capacity, for a line of any capacity
+ */
+static inline void delayLineWriteIndex(CodecIntSample* line, size_t capacity,
+        size_t idx, CodecIntSample v)
+{
+    line[idx] = v;
+    line[delayLineMirror(idx, capacity - 1)] = v;
+}
+
+static inline void delayLineWriteFloat(float* line, size_t mask, size_t pos,
+        float v)
+{
+    const size_t idx = pos & mask;
+    line[idx] = v;
+    line[delayLineMirror(idx, mask)] = v;
+}
+
+/**
+ * Read a non-integer position, interpolating linearly
+ */
+static inline float delayLineRead(const CodecIntSample* line, size_t mask,
+        float pos)
+{
+    const size_t intpos = (size_t)pos;
+    const size_t idx = intpos & mask;
+    const float frac = pos - intpos;
+    return line[idx] * (1.0f - frac) + line[idx + 1] * frac;
+}
+
+static inline float delayLineReadFloat(const float* line, size_t mask,
+        float pos)
+{
+    const size_t intpos = (size_t)pos;
+    const size_t idx = intpos & mask;
+    const float frac = pos - intpos;
+    return line[idx] * (1.0f - frac) + line[idx + 1] * frac;
+}
+
+/**
+ * Read a non-integer position with an interpolation kernel. Pass the kernel as
+ * a constant, so that the compiler picks the coefficients at compile time.
+ */
+static inline float delayLineReadInterp(const CodecIntSample* line,
+        size_t mask, float pos, enum InterpKernel kernel)
+{
+    const size_t intpos = (size_t)pos;
+    float c[INTERP_MAX_TAPS];
+    const unsigned taps = interpCoeffs(kernel, pos - intpos, c);
+    const CodecIntSample* x = &line[(intpos - (taps/2 - 1)) & mask];
+    float v = 0.0f;
+    for (unsigned k = 0; k < taps; k++) {
+        v += c[k] * x[k];
+    }
+    return v;
+}
+
+static inline float delayLineReadInterpFloat(const float* line, size_t mask,
+        float pos, enum InterpKernel kernel)
+{
+    const size_t intpos = (size_t)pos;
+    float c[INTERP_MAX_TAPS];
+    const unsigned taps = interpCoeffs(kernel, pos - intpos, c);
+    const float* x = &line[(intpos - (taps/2 - 1)) & mask];
+    float v = 0.0f;
+    for (unsigned k = 0; k < taps; k++) {
+        v += c[k] * x[k];
+    }
+    return v;
+}
+
+/**
+ * Read a non-integer position through a first order allpass. The allpass
+ * delays the later of two samples by 0.5 to 1.5 samples, where it works best,
+ * so this can read one sample further ahead than the linear read and needs a
+ * delay of at least two samples.
+ */
+static inline float delayLineReadAllpass(const CodecIntSample* line,
+        size_t mask, float pos, AllpassInterp* ap)
+{
+    const size_t intpos = (size_t)(pos + 0.5f);
+    const float d = intpos + 1 - pos;
+    const float a = (1.0f - d) / (1.0f + d);
+    const size_t idx = intpos & mask;
+    ap->last = a * line[idx + 1] + line[idx] - a * ap->last;
+    return ap->last;
+}
+
+static inline float delayLineReadAllpassFloat(const float* line, size_t mask,
+        float pos, AllpassInterp* ap)
+{
+    const size_t intpos = (size_t)(pos + 0.5f);
+    const float d = intpos + 1 - pos;
+    const float a = (1.0f - d) / (1.0f + d);
+    const size_t idx = intpos & mask;
+    ap->last = a * line[idx + 1] + line[idx] - a * ap->last;
+    return ap->last;
+}
+
+/**
+ * Read a position in Q16.16 samples, interpolating linearly in Q15
+ */
+static inline int32_t delayLineReadFixed(const CodecIntSample* line,
+        size_t mask, uint32_t pos)
+{
+    const size_t idx = (pos >> 16) & mask;
+    return lerpQ15(line[idx], line[idx + 1], (pos & 0xffff) >> 1);
+}
+
+/**
+ * Write one channel of a frame, starting at writepos. The caller advances its
+ * write position by CODEC_SAMPLES_PER_FRAME afterwards.
+ */
+static inline void delayLineWriteFrame(CodecIntSample* line, size_t mask,
+        size_t writepos, const FloatAudioBuffer* in, unsigned channel)
+{
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        delayLineWrite(line, mask, writepos + s, in->s[s][channel]);
+    }
+}
+
+static inline void delayLineWriteFrameFloat(float* line, size_t mask,
+        size_t writepos, const FloatAudioBuffer* in, unsigned channel)
+{
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        delayLineWriteFloat(line, mask, writepos + s, in->s[s][channel]);
+    }
+}
+
+/**
+ * Read a frame at a fixed delay behind each sample's write position, for a
+ * frame that was written at writepos. The delay can be non-integer, but has to
+ * be at least zero and at most the capacity.
+ */
+static inline void delayLineReadFrame(const CodecIntSample* line, size_t mask,
+        size_t writepos, float delay, float out[CODEC_SAMPLES_PER_FRAME])
+{
+    const float start = writepos + mask + 1 - delay;
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        out[s] = delayLineRead(line, mask, start + s);
+    }
+}
+
+static inline void delayLineReadFrameFloat(const float* line, size_t mask,
+        size_t writepos, float delay, float out[CODEC_SAMPLES_PER_FRAME])
+{
+    const float start = writepos + mask + 1 - delay;
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        out[s] = delayLineReadFloat(line, mask, start + s);
+    }
+}
+
+/**
+ * Read n samples interpolating linearly, at positions starting from pos and
+ * moving on by step each. This is a delay that changes by 1 - step per sample,
+ * with the whole and fractional parts of the position stepped rather than
+ * split from a float for every sample. The step is negative when the delay
+ * grows faster than time passes, and all positions must be at least zero.
+ */
+static inline void delayLineReadRamp(const CodecIntSample* line, size_t mask,
+        float pos, float step, unsigned n, float* out)
+{
+    size_t idx = (size_t)pos;
+    float frac = pos - idx;
+    // Rounded down, so that the fraction only ever grows
+    ptrdiff_t stepWhole = (ptrdiff_t)step;
+    if (stepWhole > step) {
+        stepWhole--;
+    }
+    const float stepFrac = step - stepWhole;
+    for (unsigned i = 0; i < n; i++) {
+        const CodecIntSample* x = &line[idx & mask];
+        out[i] = x[0] + frac * (x[1] - x[0]);
+        idx += stepWhole;
+        frac += stepFrac;
+        if (frac >= 1.0f) {
+            frac -= 1.0f;
+            idx++;
+        }
+    }
+}
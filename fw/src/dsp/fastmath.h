@@ -0,0 +1,189 @@
+#pragma once
+
+/**
+ * Fast replacements for the libm functions in the audio path, with bounded
+ * errors that are close to float precision, measured by
+ * tests/bench_fastmath.c against libm in double precision:
+ *
+ * - fastExp2(): degree 5 minimax polynomial of the fraction, scaled by the
+ *   integer part in the exponent bits, relative error below 2e-7
+ * - fastLog2(): exponent bits plus an odd series in (m - 1) / (m + 1) of the
+ *   mantissa, absolute error within a rounding step of the result
+ * - fastSin(), fastCos(), fastSinCos(): the nearest entry of sineTable and the
+ *   one a quarter period on, rotated by the rest of the angle with short
+ *   Taylor series, absolute error below 2.5e-7 within -pi..pi. Larger
+ *   angles lose precision like in any float, so keep phases wrapped.
+ * - fastTanh(): cubic Hermite interpolation of tanhTable, with slopes from
+ *   the values, and the exponential tail beyond TANH_TABLE_RANGE, absolute
+ *   error below 2.5e-7
+ *
+ * For oscillators that step the phase by the same angle every sample, a
+ * Phasor rotates a sine and cosine pair with a few multiplies per step.
+ *
+ * None of them handle infinities or NaN.
+ */
+
+#include <math.h>
+#include <stdint.h>
+
+#include "tables.h"
+
+#define FASTMATH_LOG2E 1.44269504f
+#define FASTMATH_LN2 0.693147181f
+#define FASTMATH_2PI 6.28318531f
+
+typedef union {
+    float f;
+    uint32_t u;
+} FastmathBits;
+
+/**
+ * The largest integer at or below x, which on the Cortex-M4 would otherwise
+ * be a library call. x must fit in an int32_t.
+ */
+static inline int32_t fastFloor(float x)
+{
+    const int32_t i = (int32_t)x;
+    return x < i ? i - 1 : i;
+}
+
+/**
+ * 2 to the power of x, for x from -126 to 127
+ */
+static inline float fastExp2(float x)
+{
+    x = x < -126.0f ? -126.0f : x;
+    x = x > 127.0f ? 127.0f : x;
+    const int32_t i = fastFloor(x);
+    const float f = x - i;
+    const float p = 1.0f + f * (0.693151312f + f * (0.24016445f +
+            f * (0.0557999131f + f * (0.00901703032f + f * 0.00186713007f))));
+    const FastmathBits scale = { .u = (uint32_t)(i + 127) << 23 };
+    return p * scale.f;
+}
+
+/**
+ * Base 2 logarithm of a positive, normal x
+ */
+static inline float fastLog2(float x)
+{
+    FastmathBits bits = { .f = x };
+    int32_t e = (int32_t)(bits.u >> 23) - 127;
+    // Mantissa in sqrt(1/2)..sqrt(2), where the series converges fast
+    bits.u = (bits.u & 0x007fffff) | 0x3f800000;
+    if (bits.f > 1.41421356f) {
+        bits.f *= 0.5f;
+        e++;
+    }
+    const float t = (bits.f - 1.0f) / (bits.f + 1.0f);
+    const float t2 = t * t;
+    // 2/ln(2) * (t + t^3/3 + t^5/5 + t^7/7)
+    return e + t * (2.88539008f + t2 * (0.961796694f +
+            t2 * (0.577078016f + t2 * 0.412198583f)));
+}
+
+/**
+ * Sine and cosine of an angle given in full turns
+ */
+static inline void fastSinCosTurns(float turns, float* sine, float* cosine)
+{
+    const float pos = turns * SINE_TABLE_SIZE;
+    const int32_t i = fastFloor(pos + 0.5f);
+    // Rest of the angle in radians, within half a table step
+    const float d = (pos - i) * (FASTMATH_2PI / SINE_TABLE_SIZE);
+    const float d2 = d * d;
+    const float sd = d - d * d2 * (1.0f / 6);
+    const float cd = 1.0f - 0.5f * d2;
+    const float s = sineTable[i & (SINE_TABLE_SIZE - 1)];
+    const float c = sineTable[(i + SINE_TABLE_SIZE / 4) & (SINE_TABLE_SIZE - 1)];
+    *sine = s * cd + c * sd;
+    *cosine = c * cd - s * sd;
+}
+
+static inline void fastSinCos(float x, float* sine, float* cosine)
+{
+    fastSinCosTurns(x * (1 / FASTMATH_2PI), sine, cosine);
+}
+
+static inline float fastSin(float x)
+{
+    float s, c;
+    fastSinCos(x, &s, &c);
+    return s;
+}
+
+static inline float fastCos(float x)
+{
+    float s, c;
+    fastSinCos(x, &s, &c);
+    return c;
+}
+
+/**
+ * Hyperbolic tangent
+ */
+static inline float fastTanh(float x)
+{
+    const float ax = fabsf(x);
+    float y;
+    if (ax >= TANH_TABLE_RANGE) {
+        // 1 - 2 exp(-2|x|), leaving out terms below float precision
+        y = 1.0f - 2.0f * fastExp2(-2 * FASTMATH_LOG2E * ax);
+    }
+    else {
+        const float step = (float)TANH_TABLE_RANGE * 2 / TANH_TABLE_SIZE;
+        const float pos = (ax + TANH_TABLE_RANGE) * (1 / step);
+        const int32_t i = (int32_t)pos;
+        const float t = pos - i;
+        const float y0 = tanhTable[i];
+        const float y1 = tanhTable[i + 1];
+        // Slopes from the derivative 1 - tanh^2, in table steps
+        const float m0 = (1.0f - y0 * y0) * step;
+        const float m1 = (1.0f - y1 * y1) * step;
+        const float dy = y1 - y0;
+        y = y0 + t * (m0 + t * ((3 * dy - 2 * m0 - m1) +
+                t * (m0 + m1 - 2 * dy)));
+    }
+    return copysignf(y, x);
+}
+
+/**
+ * A sine and cosine pair that is rotated by a fixed angle each step, for
+ * oscillators that would otherwise take the sine of a phase every sample. The
+ * amplitude drifts by a few parts in 10^7 per step, so start each run from
+ * phasorInit() or correct it with phasorNormalize() every now and then.
+ */
+typedef struct {
+    float sin;
+    float cos;
+    float stepSin;
+    float stepCos;
+} Phasor;
+
+/**
+ * @param phase Angle to start at, in radians
+ * @param step Angle added by each phasorStep(), in radians
+ */
+static inline void phasorInit(Phasor* p, float phase, float step)
+{
+    fastSinCos(phase, &p->sin, &p->cos);
+    fastSinCos(step, &p->stepSin, &p->stepCos);
+}
+
+static inline void phasorStep(Phasor* p)
+{
+    const float s = p->sin * p->stepCos + p->cos * p->stepSin;
+    p->cos = p->cos * p->stepCos - p->sin * p->stepSin;
+    p->sin = s;
+}
+
+/**
+ * Pull the amplitude back to 1, with one Newton step for 1/sqrt that is
+ * exact enough for the small drift of a Phasor
+ */
+static inline void phasorNormalize(Phasor* p)
+{
+    const float g = 1.5f - 0.5f * (p->sin * p->sin + p->cos * p->cos);
+    p->sin *= g;
+    p->cos *= g;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+/**
+ * FFTs for the effects, through the kiss_fft and kiss_fftr API. The
+ * transforms come from the backend picked at build time with
+ * make FFT_BACKEND=...
+ *
+ * radix4: Iterative radix-4 transform for powers of two. Up to real
+ *         transforms of FFT_TABLE_SIZE the twiddle factors and bit-reversal
+ *         table are read from flash, see tables.h, so that setting up a
+ *         config computes nothing. Larger sizes keep them in the config.
+ *         This is the default.
+ * kiss:   The generic mixed radix kiss_fft.c, for any size, computing its
+ *         twiddle factors when the config is set up.
+ *
+ * Configs are placed in memory given by the caller, see kiss_fftr_alloc().
+ * The makefile sets FFT_BACKEND_RADIX4 to tell which backend that is.
+ */
+
+#include <stdint.h>
+#include <tools/kiss_fftr.h>
+
+#include "tables.h"
+
+#ifndef FFT_BACKEND_RADIX4
+#define FFT_BACKEND_RADIX4 1
+#endif
+
+/// Upper bound on what kiss_fftr_alloc() of kiss_fftr.c needs for a real
+/// transform of nfft samples, which is also the most any backend needs
+#define FFT_KISS_MEMORY(nfft) (sizeof(kiss_fft_cpx) * (nfft) * 3 / 2 + 512)
+
+/// Upper bound on the radix4 config headers, checked in fft_radix4.c
+#define FFT_RADIX4_HEADER_MEMORY (16 * sizeof(void*))
+
+/// What kiss_fftr_alloc() of the radix4 backend needs at most: the headers,
+/// and the tables of sizes beyond FFT_TABLE_SIZE
+#define FFT_RADIX4_MEMORY(nfft) (FFT_RADIX4_HEADER_MEMORY + \
+        ((nfft) > FFT_TABLE_SIZE ? \
+        sizeof(kiss_fft_cpx) * ((nfft) * 3 / 8 + (nfft) / 4 + 1) + \
+        sizeof(uint16_t) * (nfft) / 2 : 0))
+
+/// What kiss_fftr_alloc() needs for a real transform of nfft samples with the
+/// backend linked in
+#if FFT_BACKEND_RADIX4
+#define FFT_REAL_MEMORY(nfft) FFT_RADIX4_MEMORY(nfft)
+#else
+#define FFT_REAL_MEMORY(nfft) FFT_KISS_MEMORY(nfft)
+#endif
+
+/// Name of the backend linked in
+extern const char fftBackendName[];
@@ -0,0 +1,7 @@
+/*
+ * The generic kiss_fft backend is kiss_fft.c itself, this only names it.
+ */
+
+#include "fft.h"
+
+const char fftBackendName[] = "kiss";
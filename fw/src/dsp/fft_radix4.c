@@ -0,0 +1,430 @@
+/*
+ * Radix-4 backend for the kiss_fft and kiss_fftr API, replacing kiss_fft.c and
+ * tools/kiss_fftr.c. kiss_fft.c recurses through mixed radix stages for any
+ * size and works out of place. Only powers of two are needed here, which
+ * allows a plain loop over the stages: an odd power of two gets a radix-2
+ * stage and the rest are radix-4 stages, all in place in the output. The
+ * first stage needs no twiddle factors and reads the input in bit-reversed
+ * order.
+ *
+ * The real transforms are complex transforms of half the size, of the even
+ * samples as real parts and the odd ones as imaginary parts, untangled in
+ * place in the output like kiss_fftr does.
+ *
+ * Twiddle factors and bit-reversed indexes come from the tables in flash
+ * generated at build time, see dsp/tables.h, so that a config is only a few
+ * words. Sizes beyond the tables get theirs computed into the config.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "fft.h"
+#include "tables.h"
+
+const char fftBackendName[] = "radix4";
+
+/// Largest size the bit-reversal indexes fit
+#define MAX_NFFT 65536
+
+struct kiss_fft_state {
+    int nfft;
+    int inverse;
+    unsigned bits; ///< log2(nfft)
+    /// exp(-2 pi i k / nfft) at twiddles[k * step]
+    const kiss_fft_cpx* twiddles;
+    unsigned step;
+    /// Bit-reversed index of k at bitrev[k] >> shift
+    const uint16_t* bitrev;
+    unsigned shift;
+};
+
+struct kiss_fftr_state {
+    kiss_fft_cfg half; ///< Complex transform of nfft/2
+    /// exp(-2 pi i k / nfft) at twiddles[k * step]
+    const kiss_fft_cpx* twiddles;
+    unsigned step;
+};
+
+_Static_assert(sizeof(struct kiss_fftr_state) + sizeof(struct kiss_fft_state) <=
+        FFT_RADIX4_HEADER_MEMORY, "FFT_RADIX4_HEADER_MEMORY too small");
+
+static inline kiss_fft_cpx cadd(kiss_fft_cpx a, kiss_fft_cpx b)
+{
+    return (kiss_fft_cpx) { a.r + b.r, a.i + b.i };
+}
+
+static inline kiss_fft_cpx csub(kiss_fft_cpx a, kiss_fft_cpx b)
+{
+    return (kiss_fft_cpx) { a.r - b.r, a.i - b.i };
+}
+
+static inline kiss_fft_cpx cmul(kiss_fft_cpx a, kiss_fft_cpx b)
+{
+    return (kiss_fft_cpx) { a.r * b.r - a.i * b.i, a.r * b.i + a.i * b.r };
+}
+
+static inline kiss_fft_cpx cconj(kiss_fft_cpx a)
+{
+    return (kiss_fft_cpx) { a.r, -a.i };
+}
+
+static unsigned log2u(unsigned n)
+{
+    unsigned bits = 0;
+    while ((1u << bits) < n) {
+        bits++;
+    }
+    return bits;
+}
+
+/**
+ * Fill in count twiddle factors for size n, for sizes beyond the tables
+ */
+static void computeTwiddles(kiss_fft_cpx* twiddles, unsigned count, unsigned n)
+{
+    const double pi = 3.14159265358979323846;
+    for (unsigned k = 0; k < count; k++) {
+        twiddles[k].r = cos(2 * pi * k / n);
+        twiddles[k].i = -sin(2 * pi * k / n);
+    }
+}
+
+/// Twiddle factors used by a complex transform of n
+#define COMPLEX_TWIDDLES(n) ((n) * 3 / 4)
+
+/**
+ * Bytes taken by the config of a complex transform of n, including the
+ * tables computed for sizes beyond the generated ones
+ */
+static size_t complexMemory(unsigned n)
+{
+    size_t size = sizeof(struct kiss_fft_state);
+    if (n > FFT_TABLE_SIZE / 2) {
+        size += COMPLEX_TWIDDLES(n) * sizeof(kiss_fft_cpx) +
+                n * sizeof(uint16_t);
+    }
+    return size;
+}
+
+static void complexInit(kiss_fft_cfg st, unsigned n, bool inverse)
+{
+    st->nfft = n;
+    st->inverse = inverse;
+    st->bits = log2u(n);
+
+    if (n <= FFT_TABLE_SIZE / 2) {
+        st->twiddles = fftTwiddles;
+        st->step = FFT_TABLE_SIZE / n;
+        st->bitrev = fftBitrev;
+        st->shift = log2u(FFT_TABLE_SIZE / 2) - st->bits;
+        return;
+    }
+
+    kiss_fft_cpx* twiddles = (kiss_fft_cpx*)(st + 1);
+    uint16_t* bitrev = (uint16_t*)(twiddles + COMPLEX_TWIDDLES(n));
+    computeTwiddles(twiddles, COMPLEX_TWIDDLES(n), n);
+    for (unsigned i = 0; i < n; i++) {
+        unsigned r = 0;
+        for (unsigned b = 0; b < st->bits; b++) {
+            r |= ((i >> b) & 1) << (st->bits - 1 - b);
+        }
+        bitrev[i] = r;
+    }
+    st->twiddles = twiddles;
+    st->step = 1;
+    st->bitrev = bitrev;
+    st->shift = 0;
+}
+
+/**
+ * Place a config the way kiss_fft does: in mem if lenmem says it's big
+ * enough, with malloc without lenmem, and else nowhere, telling the size
+ * needed in lenmem.
+ */
+static void* placeConfig(size_t memneeded, void* mem, size_t* lenmem)
+{
+    if (lenmem == NULL) {
+        return malloc(memneeded);
+    }
+    void* st = NULL;
+    if (mem != NULL && *lenmem >= memneeded) {
+        st = mem;
+    }
+    *lenmem = memneeded;
+    return st;
+}
+
+kiss_fft_cfg kiss_fft_alloc(int nfft, int inverse_fft, void* mem,
+        size_t* lenmem)
+{
+    if (nfft < 2 || nfft > MAX_NFFT || (nfft & (nfft - 1))) {
+        fprintf(stderr, "radix4 FFT needs a power of two, not %d\n", nfft);
+        if (lenmem) {
+            *lenmem = 0;
+        }
+        return NULL;
+    }
+
+    kiss_fft_cfg st = placeConfig(complexMemory(nfft), mem, lenmem);
+    if (st) {
+        complexInit(st, nfft, inverse_fft);
+    }
+    return st;
+}
+
+kiss_fftr_cfg kiss_fftr_alloc(int nfft, int inverse_fft, void* mem,
+        size_t* lenmem)
+{
+    if (nfft < 4 || nfft > 2 * MAX_NFFT || (nfft & (nfft - 1))) {
+        fprintf(stderr, "radix4 real FFT needs a power of two, not %d\n",
+                nfft);
+        if (lenmem) {
+            *lenmem = 0;
+        }
+        return NULL;
+    }
+
+    // The untangling only reads the first quarter of the twiddles
+    const unsigned twiddles = nfft > FFT_TABLE_SIZE ? nfft / 4 + 1 : 0;
+    const size_t halfMemory = complexMemory(nfft / 2);
+    kiss_fftr_cfg st = placeConfig(sizeof(struct kiss_fftr_state) +
+            halfMemory + twiddles * sizeof(kiss_fft_cpx), mem, lenmem);
+    if (!st) {
+        return NULL;
+    }
+
+    st->half = (kiss_fft_cfg)(st + 1);
+    complexInit(st->half, nfft / 2, inverse_fft);
+    if (twiddles) {
+        kiss_fft_cpx* computed = (kiss_fft_cpx*)((char*)st->half + halfMemory);
+        computeTwiddles(computed, twiddles, nfft);
+        st->twiddles = computed;
+        st->step = 1;
+    }
+    else {
+        st->twiddles = fftTwiddles;
+        st->step = FFT_TABLE_SIZE / nfft;
+    }
+    return st;
+}
+
+/**
+ * Radix-4 stages combining blocks of m outputs, for m from first up to nfft/4.
+ * The four blocks making up each group of 4m are the transforms of the
+ * samples with index 0, 2, 1 and 3 modulo 4, since the input is bit-reversed.
+ */
+static inline __attribute__((always_inline)) void radix4Stages(
+        kiss_fft_cfg st, kiss_fft_cpx* x, unsigned first, const bool inverse)
+{
+    const unsigned n = st->nfft;
+    const kiss_fft_cpx* tw = st->twiddles;
+
+    for (unsigned m = first; m < n; m *= 4) {
+        const unsigned stride = n / (4 * m) * st->step;
+        for (unsigned k = 0; k < m; k++) {
+            kiss_fft_cpx w1 = tw[k * stride];
+            kiss_fft_cpx w2 = tw[2 * k * stride];
+            kiss_fft_cpx w3 = tw[3 * k * stride];
+            if (inverse) {
+                w1 = cconj(w1);
+                w2 = cconj(w2);
+                w3 = cconj(w3);
+            }
+
+            for (kiss_fft_cpx* g = x + k; g < x + n; g += 4 * m) {
+                const kiss_fft_cpx a = g[0];
+                const kiss_fft_cpx b = cmul(g[2 * m], w1);
+                const kiss_fft_cpx c = cmul(g[m], w2);
+                const kiss_fft_cpx d = cmul(g[3 * m], w3);
+
+                const kiss_fft_cpx s0 = cadd(a, c);
+                const kiss_fft_cpx s1 = csub(a, c);
+                const kiss_fft_cpx s2 = cadd(b, d);
+                const kiss_fft_cpx s3 = csub(b, d);
+
+                g[0] = cadd(s0, s2);
+                g[2 * m] = csub(s0, s2);
+                // Multiply s3 by -j going forward and by j going back
+                if (inverse) {
+                    g[m].r = s1.r - s3.i;
+                    g[m].i = s1.i + s3.r;
+                    g[3 * m].r = s1.r + s3.i;
+                    g[3 * m].i = s1.i - s3.r;
+                }
+                else {
+                    g[m].r = s1.r + s3.i;
+                    g[m].i = s1.i - s3.r;
+                    g[3 * m].r = s1.r - s3.i;
+                    g[3 * m].i = s1.i + s3.r;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * The stages that need no twiddle factors, radix-2 for odd powers of two and
+ * radix-4 for even ones, reading the input in bit-reversed order from src
+ * unless it already is in x. Returns the block size reached.
+ */
+static inline __attribute__((always_inline)) unsigned firstStage(
+        kiss_fft_cfg st, kiss_fft_cpx* x, const kiss_fft_cpx* src,
+        int stride, const bool permute, const bool inverse)
+{
+    const unsigned n = st->nfft;
+    const uint16_t* bitrev = st->bitrev;
+    const unsigned shift = st->shift;
+#define IN(i) (permute ? src[(bitrev[i] >> shift) * stride] : x[i])
+
+    if (st->bits & 1) {
+        for (unsigned i = 0; i < n; i += 2) {
+            const kiss_fft_cpx a = IN(i);
+            const kiss_fft_cpx b = IN(i + 1);
+            x[i] = cadd(a, b);
+            x[i + 1] = csub(a, b);
+        }
+        return 2;
+    }
+
+    for (unsigned i = 0; i < n; i += 4) {
+        const kiss_fft_cpx a = IN(i);
+        const kiss_fft_cpx b = IN(i + 1);
+        const kiss_fft_cpx c = IN(i + 2);
+        const kiss_fft_cpx d = IN(i + 3);
+        const kiss_fft_cpx s0 = cadd(a, b);
+        const kiss_fft_cpx s1 = csub(a, b);
+        const kiss_fft_cpx s2 = cadd(c, d);
+        const kiss_fft_cpx s3 = csub(c, d);
+
+        x[i] = cadd(s0, s2);
+        x[i + 2] = csub(s0, s2);
+        if (inverse) {
+            x[i + 1].r = s1.r - s3.i;
+            x[i + 1].i = s1.i + s3.r;
+            x[i + 3].r = s1.r + s3.i;
+            x[i + 3].i = s1.i - s3.r;
+        }
+        else {
+            x[i + 1].r = s1.r + s3.i;
+            x[i + 1].i = s1.i - s3.r;
+            x[i + 3].r = s1.r - s3.i;
+            x[i + 3].i = s1.i + s3.r;
+        }
+    }
+    return 4;
+#undef IN
+}
+
+static inline __attribute__((always_inline)) void transform(kiss_fft_cfg st,
+        const kiss_fft_cpx* fin, kiss_fft_cpx* fout, int in_stride,
+        const bool inverse)
+{
+    if (fin == fout) {
+        for (unsigned i = 0; i < (unsigned)st->nfft; i++) {
+            const unsigned r = st->bitrev[i] >> st->shift;
+            if (i < r) {
+                const kiss_fft_cpx t = fout[i];
+                fout[i] = fout[r];
+                fout[r] = t;
+            }
+        }
+        radix4Stages(st, fout, firstStage(st, fout, fin, 1, false, inverse),
+                inverse);
+    }
+    else {
+        radix4Stages(st, fout,
+                firstStage(st, fout, fin, in_stride, true, inverse), inverse);
+    }
+}
+
+void kiss_fft_stride(kiss_fft_cfg st, const kiss_fft_cpx* fin,
+        kiss_fft_cpx* fout, int in_stride)
+{
+    // Separate code for each direction, without a branch in the butterflies
+    if (st->inverse) {
+        transform(st, fin, fout, in_stride, true);
+    }
+    else {
+        transform(st, fin, fout, in_stride, false);
+    }
+}
+
+void kiss_fft(kiss_fft_cfg cfg, const kiss_fft_cpx* fin, kiss_fft_cpx* fout)
+{
+    kiss_fft_stride(cfg, fin, fout, 1);
+}
+
+void kiss_fftr(kiss_fftr_cfg st, const kiss_fft_scalar* timedata,
+        kiss_fft_cpx* freqdata)
+{
+    if (st->half->inverse) {
+        fprintf(stderr, "kiss_fftr with an inverse config\n");
+        return;
+    }
+
+    const unsigned n = st->half->nfft;
+    transform(st->half, (const kiss_fft_cpx*)timedata, freqdata, 1, false);
+
+    // Bins k and n - k hold the transforms of the even and odd samples at k
+    // added together, with the odd ones rotated by 90 degrees
+    const kiss_fft_cpx dc = freqdata[0];
+    freqdata[0] = (kiss_fft_cpx) { dc.r + dc.i, 0 };
+    freqdata[n] = (kiss_fft_cpx) { dc.r - dc.i, 0 };
+    for (unsigned k = 1; k <= n / 2; k++) {
+        const kiss_fft_cpx zk = freqdata[k];
+        const kiss_fft_cpx znk = cconj(freqdata[n - k]);
+        const kiss_fft_cpx even = cadd(zk, znk);
+        // Times the twiddle factor and -j
+        const kiss_fft_cpx t = cmul(csub(zk, znk), st->twiddles[k * st->step]);
+        const kiss_fft_cpx odd = { t.i, -t.r };
+
+        freqdata[k].r = 0.5f * (even.r + odd.r);
+        freqdata[k].i = 0.5f * (even.i + odd.i);
+        freqdata[n - k].r = 0.5f * (even.r - odd.r);
+        freqdata[n - k].i = 0.5f * (odd.i - even.i);
+    }
+}
+
+void kiss_fftri(kiss_fftr_cfg st, const kiss_fft_cpx* freqdata,
+        kiss_fft_scalar* timedata)
+{
+    if (!st->half->inverse) {
+        fprintf(stderr, "kiss_fftri with a forward config\n");
+        return;
+    }
+
+    // The reverse of kiss_fftr, unscaled, then an inverse transform in place
+    const unsigned n = st->half->nfft;
+    kiss_fft_cpx* z = (kiss_fft_cpx*)timedata;
+    z[0].r = freqdata[0].r + freqdata[n].r;
+    z[0].i = freqdata[0].r - freqdata[n].r;
+    for (unsigned k = 1; k <= n / 2; k++) {
+        const kiss_fft_cpx fk = freqdata[k];
+        const kiss_fft_cpx fnk = cconj(freqdata[n - k]);
+        const kiss_fft_cpx even = cadd(fk, fnk);
+        // Times the conjugated twiddle factor and j
+        const kiss_fft_cpx t = cmul(csub(fk, fnk),
+                cconj(st->twiddles[k * st->step]));
+        const kiss_fft_cpx odd = { -t.i, t.r };
+
+        z[k] = cadd(even, odd);
+        z[n - k] = cconj(csub(even, odd));
+    }
+    transform(st->half, z, z, 1, true);
+}
+
+void kiss_fft_cleanup(void)
+{
+}
+
+int kiss_fft_next_fast_size(int n)
+{
+    int size = 2;
+    while (size < n) {
+        size *= 2;
+    }
+    return size;
+}
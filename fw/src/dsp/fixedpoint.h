@@ -0,0 +1,116 @@
+#pragma once
+
+/**
+ * Helpers for fixed point processing, directly on 16-bit codec samples.
+ *
+ * Samples are Q15: a CodecIntSample of 0x7fff represents just under 1.0.
+ * Where the Cortex-M4 has a DSP instruction for an operation (__ARM_FEATURE_DSP
+ * is set by the compiler) it is used, and there is an equivalent C version for
+ * host builds.
+ */
+
+#include <stdint.h>
+
+#include "codec.h"
+
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+#define Q15_ONE 0x8000
+#define Q15_MAX INT16_MAX
+#define Q31_ONE 0x80000000LL
+
+/// Convert a float in -1..1 to Q15, at compile time if it's a constant
+#define FLOAT_TO_Q15(f) ((q15_t)((f) >= 1.0f ? Q15_MAX : (f) * Q15_ONE))
+
+/**
+ * Saturate a 32-bit value to the 16-bit sample range
+ */
+static inline int32_t ssat16(int32_t x)
+{
+#ifdef __ARM_FEATURE_DSP
+    int32_t r;
+    __asm__ ("ssat %0, #16, %1" : "=r" (r) : "r" (x));
+    return r;
+#else
+    return x > INT16_MAX ? INT16_MAX : (x < INT16_MIN ? INT16_MIN : x);
+#endif
+}
+
+/**
+ * Pack two 16-bit values into one word, lo in the bottom half-word
+ */
+static inline uint32_t pack16(int16_t lo, int16_t hi)
+{
+    return (uint16_t)lo | ((uint32_t)(uint16_t)hi << 16);
+}
+
+static inline int16_t lo16(uint32_t x)
+{
+    return (int16_t)(x & 0xffff);
+}
+
+static inline int16_t hi16(uint32_t x)
+{
+    return (int16_t)(x >> 16);
+}
+
+/**
+ * Saturating add of two pairs of 16-bit values, e.g. a stereo sample
+ */
+static inline uint32_t qadd16(uint32_t a, uint32_t b)
+{
+#ifdef __ARM_FEATURE_DSP
+    uint32_t r;
+    __asm__ ("qadd16 %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+    return r;
+#else
+    return pack16(ssat16(lo16(a) + lo16(b)), ssat16(hi16(a) + hi16(b)));
+#endif
+}
+
+/**
+ * Dual 16-bit multiply with 32-bit accumulate:
+ * acc + lo(x) * lo(y) + hi(x) * hi(y)
+ */
+static inline int32_t smlad(uint32_t x, uint32_t y, int32_t acc)
+{
+#ifdef __ARM_FEATURE_DSP
+    int32_t r;
+    __asm__ ("smlad %0, %1, %2, %3" : "=r" (r) : "r" (x), "r" (y), "r" (acc));
+    return r;
+#else
+    return acc + (int32_t)lo16(x) * lo16(y) + (int32_t)hi16(x) * hi16(y);
+#endif
+}
+
+/**
+ * Multiply two Q15 values, giving a Q15 result (not saturated)
+ */
+static inline int32_t mulQ15(int32_t a, int32_t b)
+{
+    return (a * b) >> 15;
+}
+
+/**
+ * Linear interpolation between two samples. frac is Q15 in 0..Q15_ONE-1.
+ */
+static inline int32_t lerpQ15(q15_t s0, q15_t s1, int32_t frac)
+{
+    return smlad(pack16(s0, s1), pack16(Q15_ONE - 1 - frac, frac), 0) >> 15;
+}
+
+/**
+ * Sine of a phase where the full uint32_t range is one period, in Q15.
+ * Parabolic approximation with one refinement step, max error about 0.1%.
+ */
+static inline int32_t sinQ15(uint32_t phase)
+{
+    // x in -1..1 (Q15) over the period, with sin(x*pi)
+    const int32_t x = (int32_t)phase >> 16;
+    const int32_t ax = x < 0 ? -x : x;
+    // y = 4x(1 - |x|), then y = y + 0.225 (y|y| - y)
+    const int32_t y = (x * (Q15_ONE - ax)) >> 13;
+    const int32_t ay = y < 0 ? -y : y;
+    return y + ((((y * ay) >> 15) - y) * 7373 >> 15);
+}
@@ -0,0 +1,205 @@
+#include <math.h>
+#include <string.h>
+
+#include "gate.h"
+#include "fastmath.h"
+#include "fixedpoint.h"
+#include "utils.h"
+
+#define FRAME_SECONDS ((float)CODEC_SAMPLES_PER_FRAME / CODEC_SAMPLERATE)
+
+/**
+ * Share of the way to its target that the gain moves in a frame, for a time
+ * constant in seconds
+ */
+static float frameCoeff(float time)
+{
+    if (time <= 0) {
+        return 1.0f;
+    }
+    return 1.0f - fastExp2(-FASTMATH_LOG2E * FRAME_SECONDS / time);
+}
+
+/**
+ * Move the gate on by a frame with the level of its input, from 0 to 1
+ *
+ * @return Gain at the end of the frame
+ */
+static float updateGain(GateState* st, const GateParams* p, float level)
+{
+    if (level >= p->threshold ||
+            (st->open && level >= p->threshold * p->hysteresis)) {
+        st->open = true;
+        st->holdLeft = p->hold / FRAME_SECONDS;
+    }
+    else if (st->holdLeft) {
+        st->holdLeft--;
+    }
+    else {
+        st->open = false;
+    }
+
+    float target = 1.0f;
+    if (!st->open) {
+        // (level / threshold)^(ratio - 1), but no lower than the range
+        float exponent = -126.0f;
+        if (level > 1e-9f) {
+            exponent = (p->ratio - 1) * (fastLog2(level) - fastLog2(p->threshold));
+        }
+        target = fastExp2(CLAMP(exponent, -126.0f, 0.0f));
+        target = target > p->range ? target : p->range;
+    }
+
+    const float coeff = frameCoeff(target > st->gain ? p->attack : p->release);
+    st->gain += coeff * (target - st->gain);
+    // Land on fully open, where the audio is left as it is
+    if (target == 1.0f && st->gain > 0.9999f) {
+        st->gain = 1.0f;
+    }
+    return st->gain;
+}
+
+void processGate(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        GateState* st, const GateParams* p)
+{
+    float level = 0.0f;
+    if (p->detector == GATE_RMS) {
+        for (unsigned s = 0; s < 2 * CODEC_SAMPLES_PER_FRAME; s++) {
+            level += in->m[s] * in->m[s];
+        }
+        level = sqrtf(level / (2 * CODEC_SAMPLES_PER_FRAME)) * (1.0f / 32768);
+    }
+    else {
+        for (unsigned s = 0; s < 2 * CODEC_SAMPLES_PER_FRAME; s++) {
+            const float v = fabsf(in->m[s]);
+            level = v > level ? v : level;
+        }
+        level *= 1.0f / 32768;
+    }
+
+    const float start = st->gain;
+    const float end = updateGain(st, p, level);
+
+    // Delay by the look-ahead, keeping the end of the input for the next
+    // frame. Going backwards works with the output being the input.
+    const unsigned lookahead = p->lookahead < GATE_MAX_LOOKAHEAD ?
+            p->lookahead : GATE_MAX_LOOKAHEAD;
+    if (lookahead) {
+        float last[2][GATE_MAX_LOOKAHEAD];
+        for (unsigned k = 0; k < GATE_MAX_LOOKAHEAD; k++) {
+            last[0][k] = in->s[CODEC_SAMPLES_PER_FRAME - GATE_MAX_LOOKAHEAD + k][0];
+            last[1][k] = in->s[CODEC_SAMPLES_PER_FRAME - GATE_MAX_LOOKAHEAD + k][1];
+        }
+        for (unsigned s = CODEC_SAMPLES_PER_FRAME; s-- > lookahead;) {
+            out->s[s][0] = in->s[s - lookahead][0];
+            out->s[s][1] = in->s[s - lookahead][1];
+        }
+        for (unsigned s = 0; s < lookahead; s++) {
+            out->s[s][0] = st->history[0][GATE_MAX_LOOKAHEAD - lookahead + s];
+            out->s[s][1] = st->history[1][GATE_MAX_LOOKAHEAD - lookahead + s];
+        }
+        memcpy(st->history, last, sizeof(last));
+    }
+    else if (out != in) {
+        *out = *in;
+    }
+
+    if (start == 1.0f && end == 1.0f) {
+        return;
+    }
+
+    // The gain of each sample from its index rather than by adding up steps,
+    // so that the loop has no dependency from one sample to the next
+    const float step = (end - start) / CODEC_SAMPLES_PER_FRAME;
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        const float g = start + step * (s + 1);
+        out->s[s][0] *= g;
+        out->s[s][1] *= g;
+    }
+}
+
+void processGateFixed(const AudioBuffer* in, AudioBuffer* out,
+        GateState* st, const GateParams* p)
+{
+    float level;
+    if (p->detector == GATE_RMS) {
+        int64_t sum = 0;
+        for (unsigned s = 0; s < 2 * CODEC_SAMPLES_PER_FRAME; s++) {
+            sum += in->m[s] * in->m[s];
+        }
+        level = sqrtf((float)sum / (2 * CODEC_SAMPLES_PER_FRAME)) * (1.0f / 32768);
+    }
+    else {
+        int32_t peak = 0;
+        for (unsigned s = 0; s < 2 * CODEC_SAMPLES_PER_FRAME; s++) {
+            const int32_t v = in->m[s] < 0 ? -in->m[s] : in->m[s];
+            peak = v > peak ? v : peak;
+        }
+        level = peak * (1.0f / 32768);
+    }
+
+    // Gains in Q15, where 1 is Q15_ONE
+    const int32_t start = st->gain * Q15_ONE;
+    const int32_t end = updateGain(st, p, level) * Q15_ONE;
+
+    // The look-ahead like in processGate()
+    const unsigned lookahead = p->lookahead < GATE_MAX_LOOKAHEAD ?
+            p->lookahead : GATE_MAX_LOOKAHEAD;
+    if (lookahead) {
+        CodecIntSample last[2][GATE_MAX_LOOKAHEAD];
+        for (unsigned k = 0; k < GATE_MAX_LOOKAHEAD; k++) {
+            last[0][k] = in->s[CODEC_SAMPLES_PER_FRAME - GATE_MAX_LOOKAHEAD + k][0];
+            last[1][k] = in->s[CODEC_SAMPLES_PER_FRAME - GATE_MAX_LOOKAHEAD + k][1];
+        }
+        for (unsigned s = CODEC_SAMPLES_PER_FRAME; s-- > lookahead;) {
+            out->s[s][0] = in->s[s - lookahead][0];
+            out->s[s][1] = in->s[s - lookahead][1];
+        }
+        for (unsigned s = 0; s < lookahead; s++) {
+            out->s[s][0] = st->historyFixed[0][GATE_MAX_LOOKAHEAD - lookahead + s];
+            out->s[s][1] = st->historyFixed[1][GATE_MAX_LOOKAHEAD - lookahead + s];
+        }
+        memcpy(st->historyFixed, last, sizeof(last));
+    }
+    else if (out != in) {
+        *out = *in;
+    }
+
+    if (start == Q15_ONE && end == Q15_ONE) {
+        return;
+    }
+
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        const int32_t g = start +
+                (end - start) * (int32_t)(s + 1) / CODEC_SAMPLES_PER_FRAME;
+        out->s[s][0] = (out->s[s][0] * g) >> 15;
+        out->s[s][1] = (out->s[s][1] * g) >> 15;
+    }
+}
+
+void initGate(GateState* state)
+{
+    memset(state, 0, sizeof(*state));
+    state->gain = 1.0f;
+    state->open = true;
+}
+
+static void nodeInit(void* state)
+{
+    initGate(state);
+}
+
+static void nodeProcess(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        void* state, const void* params)
+{
+    processGate(in, out, state, params);
+}
+
+const FxNodeType gateNode = {
+    .name = "gate",
+    .stateSize = sizeof(GateState),
+    .heat = ARENA_HOT,
+    .init = nodeInit,
+    .process = nodeProcess,
+    .flags = FXNODE_INPLACE
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+/**
+ * Noise gate and downward expander for the input, so that the drive stage
+ * doesn't bring up hum and hiss between notes.
+ *
+ * The level of the input is measured once per frame, as its peak or its RMS
+ * over the frame. The gate opens when the level reaches the threshold and
+ * closes when it falls below the threshold times the hysteresis and has
+ * stayed there for the hold time. While closed, the signal is turned down by
+ * the ratio for every step the level is below the threshold, down to the
+ * range: a ratio of 2 halves the gain for every halving of the level, and a
+ * large ratio makes a plain gate. The gain follows this target with the
+ * attack and release times, and goes over the frame in a straight line.
+ *
+ * With look-ahead, the audio is delayed by a few samples, so that the gain
+ * opening for a frame starts a bit before the sound that opened it.
+ *
+ * A gate that is fully open and has no look-ahead leaves the audio as it is,
+ * and only costs measuring the level.
+ */
+
+#include <stdbool.h>
+
+#include "codec.h"
+#include "fxgraph.h"
+
+/// Most look-ahead in samples, a third of a millisecond at 48 kHz
+#define GATE_MAX_LOOKAHEAD 16
+
+_Static_assert(GATE_MAX_LOOKAHEAD <= CODEC_SAMPLES_PER_FRAME,
+        "Gate look-ahead longer than a frame");
+
+typedef enum {
+    GATE_PEAK, ///< Largest sample of the frame
+    GATE_RMS, ///< Root mean square of the frame, less eager to open on clicks
+} GateDetector;
+
+typedef struct {
+    /// Level that opens the gate, as a fraction of full scale. 0 keeps it open.
+    float threshold;
+    /// The gate closes when the level falls below the threshold times this,
+    /// from 0 to 1
+    float hysteresis;
+    /// Expansion below the threshold while closed, 1 for none
+    float ratio;
+    /// Lowest gain while closed, from 0 to 1
+    float range;
+    float attack; ///< Time constant of the gain opening, in seconds
+    float hold; ///< Seconds the gate stays open after the level falls
+    float release; ///< Time constant of the gain closing, in seconds
+    unsigned lookahead; ///< Samples, up to GATE_MAX_LOOKAHEAD
+    GateDetector detector;
+} GateParams;
+
+typedef struct {
+    float gain; ///< At the end of the last frame
+    bool open;
+    unsigned holdLeft; ///< Frames
+    /// The last input samples, for the look-ahead
+    float history[2][GATE_MAX_LOOKAHEAD];
+    CodecIntSample historyFixed[2][GATE_MAX_LOOKAHEAD];
+} GateState;
+
+/**
+ * Initialize the gate, open, creating a predictable state
+ */
+void initGate(GateState* state);
+
+/**
+ * Run the gate over a buffer of stereo samples.
+ *
+ * @param in Pointer to input samples
+ * @param out Pointer to output samples, which may be the same as the input
+ * @param state Mutable state of the effect
+ * @param param Input parameters to the effect
+ */
+void processGate(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        GateState* state, const GateParams* params);
+
+/**
+ * Fixed point version of processGate(), working directly on codec samples.
+ * It shares the state with the floating point version.
+ */
+void processGateFixed(const AudioBuffer* in, AudioBuffer* out,
+        GateState* state, const GateParams* params);
+
+/**
+ * Effect graph node running the gate, with a GateState as state and
+ * GateParams as parameters
+ */
+extern const FxNodeType gateNode;
@@ -0,0 +1,48 @@
+#include "halfband.h"
+
+_Static_assert(HALFBAND_STAGES == 3, "Update halfbandStages for make_tables.py");
+
+const HalfbandFilter halfbandStages[HALFBAND_STAGES] = {
+    { halfband0, HALFBAND0_TAPS },
+    { halfband1, HALFBAND1_TAPS },
+    { halfband2, HALFBAND2_TAPS },
+};
+
+void halfbandUp(const HalfbandFilter* filter, const float* in, unsigned n,
+        float* out)
+{
+    const float* taps = filter->taps;
+    const unsigned last = filter->tapCount - 1;
+    const unsigned half = filter->tapCount / 2;
+
+    for (unsigned m = 0; m < n; m++) {
+        // The odd phase interpolates halfway between in[m - half] and the
+        // next sample
+        const float* x = in + m;
+        float acc = 0;
+        for (unsigned j = 0; j < half; j++) {
+            acc += taps[j] * (x[-(int)j] + x[(int)j - (int)last]);
+        }
+        out[2*m] = x[-(int)half];
+        out[2*m + 1] = acc;
+    }
+}
+
+void halfbandDown(const HalfbandFilter* filter, const float* in, unsigned n,
+        float* out)
+{
+    const float* taps = filter->taps;
+    const unsigned last = filter->tapCount - 1;
+    const unsigned half = filter->tapCount / 2;
+
+    for (unsigned m = 0; m < n; m++) {
+        // Odd input samples go through the odd phase, and the even one in the
+        // middle through the center tap of 1/2
+        const float* u = in + 2*m + 1;
+        float acc = 0;
+        for (unsigned j = 0; j < half; j++) {
+            acc += taps[j] * (u[-2*(int)j] + u[2*((int)j - (int)last)]);
+        }
+        out[m] = 0.5f * (acc + u[-(int)last]);
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+/**
+ * Polyphase half-band FIR filters for changing the sample rate by two, the
+ * building block of oversampling. Every other tap of a half-band lowpass is
+ * zero except the center one, so each output sample only takes the odd phase:
+ * when upsampling every other output is just a delayed input sample, and when
+ * downsampling every other input sample only meets the center tap. The odd
+ * phase is symmetric, which halves the multiplies again.
+ *
+ * The filters work on blocks. The caller keeps the history and places it
+ * right before the new samples in memory, so that the inner loops run without
+ * wrapping indexes.
+ *
+ * The coefficients of each oversampling stage are generated with the other
+ * tables, see tables.h. Stage 0 runs between the codec rate and twice that,
+ * and has the narrowest transition band, later stages run at higher rates and
+ * take fewer taps.
+ */
+
+#include "tables.h"
+
+/// History needed before the input to halfbandUp(), in input samples
+#define HALFBAND_UP_HISTORY(taps) ((taps) - 1)
+/// History needed before the input to halfbandDown(), in input samples
+#define HALFBAND_DOWN_HISTORY(taps) (2 * ((taps) - 1))
+/// Delay of upsampling followed by downsampling, in samples at the lower rate
+#define HALFBAND_ROUNDTRIP_DELAY(taps) ((taps) - 1)
+
+typedef struct {
+    const float* taps; ///< First half of the odd phase
+    unsigned tapCount; ///< Length of the whole odd phase, even
+} HalfbandFilter;
+
+/// The filter for each oversampling stage
+extern const HalfbandFilter halfbandStages[HALFBAND_STAGES];
+
+/**
+ * Double the sample rate of a block. The delay is tapCount / 2 input samples.
+ *
+ * @param in n new input samples, preceded in memory by
+ *        HALFBAND_UP_HISTORY(tapCount) samples of earlier input
+ * @param out 2 * n output samples
+ */
+void halfbandUp(const HalfbandFilter* filter, const float* in, unsigned n,
+        float* out);
+
+/**
+ * Halve the sample rate of a block. The delay is tapCount / 2 - 1 output
+ * samples.
+ *
+ * @param in 2 * n new input samples, preceded in memory by
+ *        HALFBAND_DOWN_HISTORY(tapCount) samples of earlier input
+ * @param out n output samples
+ */
+void halfbandDown(const HalfbandFilter* filter, const float* in, unsigned n,
+        float* out);
@@ -0,0 +1,190 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fastmath.h"
+#include "harmonizer.h"
+#include "platform.h"
+#include "tables.h"
+#include "utils.h"
+
+#define N HARMONIZER_FFT_SIZE
+#define HOP HARMONIZER_HOP
+#define BINS HARMONIZER_BINS
+
+/// Hops between reports, about five seconds
+#define REPORT_HOPS (5 * CODEC_SAMPLERATE / HOP)
+
+_Static_assert(HOP >= CODEC_SAMPLES_PER_FRAME &&
+        HARMONIZER_RING >= HARMONIZER_PREFILL + HOP &&
+        HARMONIZER_RING >= 2 * HOP, "Harmonizer rings too small");
+
+/// Periodic Hann for both analysis and synthesis, in flash. The squared
+/// windows of four overlapping hops add up to 1.5, and the inverse FFT scales
+/// by N.
+static const float* const window = WINDOW_HANN(HARMONIZER_FFT_SIZE);
+
+/// Phase advance of bin 1 over a hop
+static const float hopPhase = 2 * M_PI * HOP / N;
+
+void initHarmonizer(HarmonizerState* st)
+{
+    memset(st, 0, sizeof(*st));
+    atomic_init(&st->ratio, 1.0f);
+    atomic_init(&st->underruns, 0);
+    ringBufferInit(&st->inRing, st->inData, HARMONIZER_RING);
+    ringBufferInit(&st->outRing, st->outData, HARMONIZER_RING);
+
+    static const float silence[HARMONIZER_PREFILL];
+    ringBufferWrite(&st->outRing, silence, HARMONIZER_PREFILL);
+
+    size_t len = sizeof(st->forwardMemory);
+    st->forward = kiss_fftr_alloc(N, false, st->forwardMemory, &len);
+    len = sizeof(st->inverseMemory);
+    st->inverse = kiss_fftr_alloc(N, true, st->inverseMemory, &len);
+    if (!st->forward || !st->inverse) {
+        printf("harmonizer: FFT needs %u bytes\n", (unsigned)len);
+    }
+
+    loadMeterReset(&st->stats);
+}
+
+void processHarmonizer(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, HarmonizerState* st,
+        const HarmonizerParams* p)
+{
+    atomic_store_explicit(&st->ratio, p->ratio, memory_order_relaxed);
+
+    float mono[CODEC_SAMPLES_PER_FRAME];
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        mono[s] = 0.5f * (in->s[s][0] + in->s[s][1]);
+    }
+    if (ringBufferWritable(&st->inRing) >= CODEC_SAMPLES_PER_FRAME) {
+        ringBufferWrite(&st->inRing, mono, CODEC_SAMPLES_PER_FRAME);
+    }
+
+    // Whatever is missing when the idle loop falls behind is silent
+    float wet[CODEC_SAMPLES_PER_FRAME] = { 0 };
+    const size_t ready = ringBufferReadable(&st->outRing);
+    if (ready >= CODEC_SAMPLES_PER_FRAME) {
+        ringBufferRead(&st->outRing, wet, CODEC_SAMPLES_PER_FRAME);
+    }
+    else {
+        ringBufferRead(&st->outRing, wet, ready);
+        atomic_fetch_add(&st->underruns, 1);
+    }
+
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        out->s[s][0] = RAMP(p->mix, in->s[s][0], wet[s]);
+        out->s[s][1] = RAMP(p->mix, in->s[s][1], wet[s]);
+    }
+}
+
+/**
+ * Move each bin to its frequency times the ratio, keeping track of the phases
+ * of the analysis and the synthesis
+ */
+static void shiftSpectrum(HarmonizerState* st, float ratio)
+{
+    float magnitude[BINS] = { 0 };
+    float frequency[BINS] = { 0 };
+
+    for (unsigned k = 0; k < BINS; k++) {
+        const kiss_fft_cpx x = st->spectrum[k];
+        const float phase = atan2f(x.i, x.r);
+
+        // Deviation from the bin's centre frequency, in bins
+        float delta = phase - st->lastPhase[k] - k * hopPhase;
+        st->lastPhase[k] = phase;
+        delta -= 2 * M_PI * roundf(delta / (2 * M_PI));
+        const float trueBin = k + delta / hopPhase;
+
+        const unsigned target = (unsigned)(k * ratio + 0.5f);
+        if (target < BINS) {
+            magnitude[target] += sqrtf(x.r * x.r + x.i * x.i);
+            frequency[target] = trueBin * ratio;
+        }
+    }
+
+    for (unsigned k = 0; k < BINS; k++) {
+        st->phaseSum[k] += frequency[k] * hopPhase;
+        st->phaseSum[k] -= 2 * M_PI * roundf(st->phaseSum[k] / (2 * M_PI));
+        float sine, cosine;
+        fastSinCos(st->phaseSum[k], &sine, &cosine);
+        st->shifted[k].r = magnitude[k] * cosine;
+        st->shifted[k].i = magnitude[k] * sine;
+    }
+}
+
+/**
+ * Shift one hop of input and add it to the output ring
+ */
+static void processHop(HarmonizerState* st)
+{
+    memmove(st->input, st->input + HOP, (N - HOP) * sizeof(float));
+    ringBufferRead(&st->inRing, st->input + N - HOP, HOP);
+
+    for (unsigned n = 0; n < N; n++) {
+        st->time[n] = st->input[n] * window[n];
+    }
+    kiss_fftr(st->forward, st->time, st->spectrum);
+
+    shiftSpectrum(st, atomic_load_explicit(&st->ratio, memory_order_relaxed));
+
+    kiss_fftri(st->inverse, st->shifted, st->time);
+    const float scale = 1.0f / (1.5f * N);
+    for (unsigned n = 0; n < N; n++) {
+        st->output[n] += st->time[n] * window[n] * scale;
+    }
+
+    ringBufferWrite(&st->outRing, st->output, HOP);
+    memmove(st->output, st->output + HOP, (N - HOP) * sizeof(float));
+    memset(st->output + N - HOP, 0, HOP * sizeof(float));
+}
+
+void harmonizerWork(HarmonizerState* st)
+{
+    if (!st->forward || !st->inverse) {
+        return;
+    }
+    while (ringBufferReadable(&st->inRing) >= HOP &&
+            ringBufferWritable(&st->outRing) >= HOP) {
+        const uint32_t start = cycleCounter();
+        processHop(st);
+        const uint32_t cycles = cycleCounter() - start;
+        const bool underrun = atomic_exchange(&st->underruns, 0) != 0;
+        loadMeterRecord(&st->stats, (uint64_t)cycles *
+                CODEC_SAMPLES_PER_FRAME / HOP, underrun);
+    }
+}
+
+void harmonizerReport(HarmonizerState* st, const char* name)
+{
+    if (st->stats.frames < REPORT_HOPS) {
+        return;
+    }
+    printf("%s: latency %u samples, %u.%u ms\n", name, HARMONIZER_LATENCY,
+            HARMONIZER_LATENCY * 1000 / CODEC_SAMPLERATE,
+            HARMONIZER_LATENCY * 10000 / CODEC_SAMPLERATE % 10);
+    loadMeterPrint(name, &st->stats);
+    loadMeterReset(&st->stats);
+}
+
+static void nodeInit(void* state)
+{
+    initHarmonizer(state);
+}
+
+static void nodeProcess(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        void* state, const void* params)
+{
+    processHarmonizer(in, out, state, params);
+}
+
+const FxNodeType harmonizerNode = {
+    .name = "harmonizer",
+    .stateSize = sizeof(HarmonizerState),
+    .heat = ARENA_HOT,
+    .init = nodeInit,
+    .process = nodeProcess
+};
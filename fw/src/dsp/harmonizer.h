@@ -0,0 +1,111 @@
+#pragma once
+
+/**
+ * Phase vocoder pitch shifter. The input is mixed down to mono and analysed
+ * with overlapping FFTs. Each bin's exact frequency is estimated from its
+ * phase advance since the previous hop, the bins are moved to their
+ * frequency times the pitch ratio, and the result is resynthesized with
+ * inverse FFTs and overlap-add. Mixed with the dry signal it makes a
+ * harmonizer.
+ *
+ * The transforms take far too long for the audio interrupt, so they run in
+ * the idle loop. processHarmonizer() only moves samples: the input goes into a
+ * lock-free ring for harmonizerWork() in the idle loop, which puts shifted
+ * audio in another ring for processHarmonizer() to play. The output ring
+ * starts with enough silence to give harmonizerWork() most of a hop to
+ * finish, which together with the FFT length is HARMONIZER_LATENCY.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "codec.h"
+#include "fft.h"
+#include "fxgraph.h"
+#include "loadmeter.h"
+#include "ringbuffer.h"
+
+#define HARMONIZER_FFT_SIZE 1024
+/// Four hops per FFT, a 75% overlap
+#define HARMONIZER_HOP (HARMONIZER_FFT_SIZE / 4)
+#define HARMONIZER_BINS (HARMONIZER_FFT_SIZE / 2 + 1)
+
+/// Silence the output ring starts with
+#define HARMONIZER_PREFILL (2 * HARMONIZER_HOP - CODEC_SAMPLES_PER_FRAME)
+/// Delay from input to output in samples
+#define HARMONIZER_LATENCY \
+        (HARMONIZER_FFT_SIZE + HARMONIZER_PREFILL - HARMONIZER_HOP)
+
+/// Capacity of each ring
+#define HARMONIZER_RING 1024
+
+typedef struct {
+    float ratio; ///< Pitch ratio, 2.0f for an octave up
+    float mix; ///< 0 for only the dry signal, 1 for only the shifted one
+} HarmonizerParams;
+
+typedef struct {
+    /// Parameters from the audio processing, for harmonizerWork()
+    _Atomic float ratio;
+    RingBuffer inRing;
+    RingBuffer outRing;
+    float inData[HARMONIZER_RING];
+    float outData[HARMONIZER_RING];
+    /// Underruns of the output ring since the last hop
+    atomic_uint underruns;
+
+    // Only used by harmonizerWork()
+    float input[HARMONIZER_FFT_SIZE]; ///< Last FFT_SIZE input samples
+    float output[HARMONIZER_FFT_SIZE]; ///< Overlap-add accumulator
+    float time[HARMONIZER_FFT_SIZE];
+    kiss_fft_cpx spectrum[HARMONIZER_BINS];
+    kiss_fft_cpx shifted[HARMONIZER_BINS];
+    float lastPhase[HARMONIZER_BINS];
+    float phaseSum[HARMONIZER_BINS];
+    kiss_fftr_cfg forward;
+    kiss_fftr_cfg inverse;
+    uint8_t forwardMemory[FFT_REAL_MEMORY(HARMONIZER_FFT_SIZE)];
+    uint8_t inverseMemory[FFT_REAL_MEMORY(HARMONIZER_FFT_SIZE)];
+    /// Time per hop, scaled to a frame to compare with the frame budget.
+    /// Hops are counted as overruns if the output ran dry before them.
+    LoadStats stats;
+} HarmonizerState;
+
+/**
+ * Initialize the harmonizer, creating a predictable state
+ *
+ * @param state State structure to initialize. Should be allocated by the caller
+ * and passed to subsequent calls to processHarmonizer() and harmonizerWork().
+ */
+void initHarmonizer(HarmonizerState* state);
+
+/**
+ * Pass a buffer of stereo samples to the harmonizer and mix what it has
+ * shifted so far into the output. Call from the audio processing.
+ *
+ * @param in Pointer to input samples
+ * @param out Pointer to output samples
+ * @param state Mutable state of the effect
+ * @param param Input parameters to the effect
+ */
+void processHarmonizer(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, HarmonizerState* state,
+        const HarmonizerParams* params);
+
+/**
+ * Shift all hops of input that have come in. Call from the idle loop.
+ */
+void harmonizerWork(HarmonizerState* state);
+
+/**
+ * Print the time spent shifting and the latency every few seconds. Call from
+ * the idle loop.
+ */
+void harmonizerReport(HarmonizerState* state, const char* name);
+
+/**
+ * Effect graph node running the audio side of the harmonizer, with a
+ * HarmonizerState as state and HarmonizerParams as parameters. The
+ * application calls harmonizerWork() on the state.
+ */
+extern const FxNodeType harmonizerNode;
@@ -0,0 +1,129 @@
+#pragma once
+
+/**
+ * Kernels for reading delay lines at fractional positions. Each kernel turns
+ * the fraction of a position into coefficients for a number of consecutive
+ * samples around it, which are then applied as a dot product over contiguous
+ * memory, see delayLineReadInterp() in delayline.h.
+ *
+ * From cheapest to best at high frequencies:
+ *
+ * - INTERP_LINEAR: two points, dulls the top octave and aliases under
+ *   modulation
+ * - INTERP_HERMITE: four point Catmull-Rom cubic
+ * - INTERP_LAGRANGE4, INTERP_LAGRANGE6: four and six point Lagrange
+ *   polynomials, flat further up than Hermite
+ * - INTERP_SINC: eight point windowed sinc from a polyphase table
+ *
+ * There is also a first order allpass, which has a flat magnitude response
+ * but keeps state per read head and is only good for slowly changing delays,
+ * see delayLineReadAllpass().
+ *
+ * tests/bench_interp.c measures the cost and quality of each.
+ */
+
+#include "sinctable.h"
+
+enum InterpKernel {
+    INTERP_LINEAR,
+    INTERP_HERMITE,
+    INTERP_LAGRANGE4,
+    INTERP_LAGRANGE6,
+    INTERP_SINC,
+};
+
+/// Most samples any kernel reads
+#define INTERP_MAX_TAPS INTERP_SINC_TAPS
+
+/// Number of samples a kernel reads
+#define INTERP_TAPS(kernel) ((kernel) == INTERP_LINEAR ? 2 : \
+        (kernel) == INTERP_LAGRANGE6 ? 6 : \
+        (kernel) == INTERP_SINC ? INTERP_SINC_TAPS : 4)
+
+/// Samples a kernel reads after the two around the position. A read head has
+/// to stay this much further behind the newest sample than with INTERP_LINEAR.
+#define INTERP_LOOKAHEAD(kernel) (INTERP_TAPS(kernel) / 2 - 1)
+
+/**
+ * Lagrange polynomial through the points first, first + 1, ... evaluated at
+ * t, as coefficients for each point. Each coefficient is the product of the
+ * distances to all other points, taken from running products from both ends,
+ * times a constant.
+ *
+ * @param scale The constant for each point, one over the product of its
+ *        distances to the other points
+ */
+static inline void interpLagrange(float t, int first, unsigned taps,
+        const float* scale, float* c)
+{
+    float before[INTERP_MAX_TAPS];
+    float after = 1.0f;
+    before[0] = 1.0f;
+    for (unsigned k = 1; k < taps; k++) {
+        before[k] = before[k - 1] * (t - (first + (int)k - 1));
+    }
+    for (int k = taps - 1; k >= 0; k--) {
+        c[k] = before[k] * after * scale[k];
+        after *= t - (first + k);
+    }
+}
+
+/**
+ * Coefficients of a kernel for a fraction between 0 and 1. The first one is
+ * for the sample INTERP_TAPS(kernel)/2 - 1 before the integer position.
+ *
+ * @return Number of coefficients
+ */
+static inline unsigned interpCoeffs(enum InterpKernel kernel, float t,
+        float c[INTERP_MAX_TAPS])
+{
+    switch (kernel) {
+    case INTERP_LINEAR:
+        c[0] = 1.0f - t;
+        c[1] = t;
+        return 2;
+
+    case INTERP_HERMITE: {
+        const float t2 = t * t;
+        const float t3 = t2 * t;
+        c[0] = -0.5f * t3 + t2 - 0.5f * t;
+        c[1] = 1.5f * t3 - 2.5f * t2 + 1.0f;
+        c[2] = -1.5f * t3 + 2.0f * t2 + 0.5f * t;
+        c[3] = 0.5f * t3 - 0.5f * t2;
+        return 4;
+    }
+
+    case INTERP_LAGRANGE4: {
+        static const float scale[4] = { -1.0f/6, 1.0f/2, -1.0f/2, 1.0f/6 };
+        interpLagrange(t, -1, 4, scale, c);
+        return 4;
+    }
+
+    case INTERP_LAGRANGE6: {
+        static const float scale[6] = {
+                -1.0f/120, 1.0f/24, -1.0f/12, 1.0f/12, -1.0f/24, 1.0f/120 };
+        interpLagrange(t, -2, 6, scale, c);
+        return 6;
+    }
+
+    case INTERP_SINC: {
+        // Linear interpolation between the two nearest phases
+        const float p = t * INTERP_SINC_PHASES;
+        const unsigned row = (unsigned)p;
+        const float frac = p - row;
+        for (unsigned k = 0; k < INTERP_SINC_TAPS; k++) {
+            c[k] = interpSincTable[row][k] + frac *
+                    (interpSincTable[row + 1][k] - interpSincTable[row][k]);
+        }
+        return INTERP_SINC_TAPS;
+    }
+    }
+    return 0;
+}
+
+/**
+ * State of a read head using the allpass
+ */
+typedef struct {
+    float last; ///< Previous output
+} AllpassInterp;
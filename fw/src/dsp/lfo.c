@@ -0,0 +1,149 @@
+#include <string.h>
+
+#include "lfo.h"
+#include "utils.h"
+
+/// Wrap an angle into -pi..pi
+static inline float wrapPhase(float phase)
+{
+    while (phase >= M_PI) {
+        phase -= 2*M_PI;
+    }
+    while (phase < -M_PI) {
+        phase += 2*M_PI;
+    }
+    return phase;
+}
+
+/// Next level of the sample and hold, from -1 to 1
+static inline float nextRandom(LfoState* st)
+{
+    // xorshift32
+    uint32_t x = st->random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    st->random = x;
+    return (int32_t)x * (1.0f / 2147483648.0f);
+}
+
+/**
+ * Fraction of the distance to the input level that the envelope covers each
+ * sample, for a time constant in seconds
+ */
+static float envelopeCoeff(float time)
+{
+    if (time <= 0) {
+        return 1.0f;
+    }
+    return 1.0f - fastExp2(-FASTMATH_LOG2E / (time * CODEC_SAMPLERATE));
+}
+
+static void sineFrame(LfoState* st, const LfoParams* p, const float* offsets,
+        unsigned count, float out[][CODEC_SAMPLES_PER_FRAME])
+{
+    float offsetSin[LFO_MAX_OUTPUTS], offsetCos[LFO_MAX_OUTPUTS];
+    for (unsigned k = 0; k < count; k++) {
+        fastSinCos(offsets[k], &offsetSin[k], &offsetCos[k]);
+    }
+
+    Phasor osc = st->sine;
+    fastSinCos(p->speed, &osc.stepSin, &osc.stepCos);
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        for (unsigned k = 0; k < count; k++) {
+            out[k][s] = osc.sin * offsetCos[k] + osc.cos * offsetSin[k];
+        }
+        phasorStep(&osc);
+    }
+    phasorNormalize(&osc);
+    st->sine = osc;
+}
+
+static void triangleFrame(LfoState* st, const LfoParams* p,
+        const float* offsets, unsigned count,
+        float out[][CODEC_SAMPLES_PER_FRAME])
+{
+    for (unsigned k = 0; k < count; k++) {
+        float t = wrapPhase(st->phase + offsets[k]);
+        for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+            // In phase with the sine: rising through 0 at 0, peaks at +-pi/2
+            const float fold = t > M_PI/2 ? M_PI - t :
+                    (t < -M_PI/2 ? -M_PI - t : t);
+            out[k][s] = fold * (float)(2 / M_PI);
+            t += p->speed;
+            if (t >= M_PI) {
+                t -= 2*M_PI;
+            }
+        }
+    }
+}
+
+static void sampleHoldFrame(LfoState* st, const LfoParams* p,
+        const float* offsets, unsigned count,
+        float out[][CODEC_SAMPLES_PER_FRAME])
+{
+    for (unsigned k = 0; k < count; k++) {
+        float t = wrapPhase(st->phase + offsets[k]);
+        for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+            out[k][s] = st->held[k];
+            t += p->speed;
+            if (t >= M_PI) {
+                t -= 2*M_PI;
+                st->held[k] = nextRandom(st);
+            }
+        }
+    }
+}
+
+static void envelopeFrame(LfoState* st, const LfoParams* p,
+        const FloatAudioBuffer* in, unsigned count,
+        float out[][CODEC_SAMPLES_PER_FRAME])
+{
+    const float attack = envelopeCoeff(p->attack);
+    const float release = envelopeCoeff(p->release);
+    float env = st->envelope;
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        const float l = fabsf(in->s[s][0]);
+        const float r = fabsf(in->s[s][1]);
+        const float level = (l > r ? l : r) * (1.0f / 32768);
+        env += (level > env ? attack : release) * (level - env);
+        out[0][s] = env;
+    }
+    st->envelope = env;
+
+    for (unsigned k = 1; k < count; k++) {
+        memcpy(out[k], out[0], sizeof(out[0]));
+    }
+}
+
+void lfoProcess(LfoState* st, const LfoParams* p, const FloatAudioBuffer* in,
+        const float* offsets, unsigned count,
+        float out[][CODEC_SAMPLES_PER_FRAME])
+{
+    switch (p->shape) {
+    case LFO_TRIANGLE:
+        triangleFrame(st, p, offsets, count, out);
+        break;
+    case LFO_SAMPLE_HOLD:
+        sampleHoldFrame(st, p, offsets, count, out);
+        break;
+    case LFO_ENVELOPE:
+        envelopeFrame(st, p, in, count, out);
+        break;
+    default:
+        sineFrame(st, p, offsets, count, out);
+    }
+
+    st->phase = wrapPhase(st->phase + p->speed * CODEC_SAMPLES_PER_FRAME);
+    if (p->shape != LFO_SINE) {
+        // Keep the sine at the phase, so that it picks up from there
+        phasorInit(&st->sine, st->phase, p->speed);
+    }
+}
+
+void initLfo(LfoState* state)
+{
+    memset(state, 0, sizeof(*state));
+    state->sine.cos = 1.0f;
+    state->random = 0x9e3779b9;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+/**
+ * Low frequency oscillator for modulating effects, generating a whole frame of
+ * modulation at a time for several consumers that each follow the same LFO at
+ * their own phase offset, such as the two channels of the vibrato or the taps
+ * of the delay.
+ *
+ * The sine is a coupled form oscillator: a sine and cosine pair rotated by the
+ * speed every sample, which costs four multiplies instead of a sine. Each
+ * output is the pair rotated once more by its offset, two multiplies per
+ * sample. The pair is pulled back to unit amplitude every frame, against the
+ * slow drift of the rotation in float.
+ *
+ * Outputs are from -1 to 1, except for the envelope follower which goes from 0
+ * at silence to 1 at full scale.
+ */
+
+#include <stdint.h>
+
+#include "codec.h"
+#include "fastmath.h"
+
+/// Most outputs of one lfoProcess() call
+#define LFO_MAX_OUTPUTS 4
+
+typedef enum {
+    LFO_SINE,
+    LFO_TRIANGLE,
+    /// A new random level every period
+    LFO_SAMPLE_HOLD,
+    /// Level of the input, the same for all outputs
+    LFO_ENVELOPE,
+} LfoShape;
+
+typedef struct {
+    LfoShape shape;
+    float speed; ///< Radians per sample
+    float attack; ///< Envelope follower rise time constant, in seconds
+    float release; ///< Envelope follower fall time constant, in seconds
+} LfoParams;
+
+typedef struct {
+    Phasor sine; ///< Sine and cosine of the phase
+    float phase; ///< -pi..pi, for the triangle and sample and hold
+    float held[LFO_MAX_OUTPUTS]; ///< Levels of the sample and hold
+    float envelope;
+    uint32_t random;
+} LfoState;
+
+/**
+ * Initialize an LFO at phase 0, creating a predictable state
+ */
+void initLfo(LfoState* state);
+
+/**
+ * Generate one frame of modulation and advance the LFO by a frame.
+ *
+ * @param in Input followed by LFO_ENVELOPE, may be NULL for the other shapes
+ * @param offsets Phase of each output ahead of the LFO, in radians from -pi to
+ *        pi
+ * @param count Number of outputs, at most LFO_MAX_OUTPUTS
+ * @param out A frame of modulation for each output
+ */
+void lfoProcess(LfoState* state, const LfoParams* params,
+        const FloatAudioBuffer* in, const float* offsets, unsigned count,
+        float out[][CODEC_SAMPLES_PER_FRAME]);
@@ -0,0 +1,92 @@
+#!/usr/bin/python
+#
+# Generate the default impulse response of dsp/cabinet.h, run by the build:
+#
+#   make_cabinet.py <output directory> <sample rate>
+#
+# Writes cabinet_ir.h.
+
+import math
+import sys
+
+# Length of the impulse response in seconds
+LENGTH=0.02
+# Share of the impulse response faded out at the end
+FADE=0.25
+
+def lowpass(fs, f, q):
+	w = 2*math.pi*f/fs
+	alpha = math.sin(w)/(2*q)
+	c = math.cos(w)
+	return [(1-c)/2, 1-c, (1-c)/2, 1+alpha, -2*c, 1-alpha]
+
+def highpass(fs, f, q):
+	w = 2*math.pi*f/fs
+	alpha = math.sin(w)/(2*q)
+	c = math.cos(w)
+	return [(1+c)/2, -(1+c), (1+c)/2, 1+alpha, -2*c, 1-alpha]
+
+def peak(fs, f, q, db):
+	w = 2*math.pi*f/fs
+	alpha = math.sin(w)/(2*q)
+	c = math.cos(w)
+	a = 10**(db/40.0)
+	return [1+alpha*a, -2*c, 1-alpha*a, 1+alpha/a, -2*c, 1-alpha/a]
+
+def cabinet(fs):
+	# A closed back 4x12: tight low end with a resonance around 110 Hz, a dip
+	# in the low mids, cone breakup around 2.5 kHz and a steep roll-off above
+	# 5 kHz
+	return [
+		highpass(fs, 70, 0.7),
+		peak(fs, 110, 1.5, 6),
+		peak(fs, 400, 1.0, -4),
+		peak(fs, 2500, 2.0, 5),
+		lowpass(fs, 5000, 0.54),
+		lowpass(fs, 5000, 1.31),
+	]
+
+def biquad(s, x):
+	b0, b1, b2, a0, a1, a2 = [ c / s[3] for c in s ]
+	y = []
+	x1 = x2 = y1 = y2 = 0.0
+	for v in x:
+		out = b0*v + b1*x1 + b2*x2 - a1*y1 - a2*y2
+		x2, x1, y2, y1 = x1, v, y1, out
+		y.append(out)
+	return y
+
+def response(ir, f, fs):
+	w = 2*math.pi*f/fs
+	re = sum([ h*math.cos(w*n) for n, h in enumerate(ir) ])
+	im = sum([ h*math.sin(w*n) for n, h in enumerate(ir) ])
+	return math.sqrt(re*re + im*im)
+
+def impulse(fs):
+	length = int(LENGTH*fs)
+	ir = [1.0] + [0.0]*(length - 1)
+	for s in cabinet(fs):
+		ir = biquad(s, ir)
+	fade = int(FADE*length)
+	for n in range(0, fade):
+		ir[length - fade + n] *= 0.5 + 0.5*math.cos(math.pi*(n + 1)/fade)
+	# Unity gain at the loudest frequency, so that a full scale input doesn't
+	# clip
+	peakGain = max([ response(ir, f, fs) for f in range(20, 20000, 10) ])
+	return [ h / peakGain for h in ir ]
+
+outdir = sys.argv[1]
+fs = int(sys.argv[2])
+
+# Default cabinet impulse response for the sample rate of the build
+with open(outdir + "/cabinet_ir.h", "w") as f:
+	ir = impulse(fs)
+	f.write("// Cabinet impulse response of %g ms at %u Hz, made by make_cabinet.py\n" % (LENGTH*1000, fs))
+	f.write("#if CODEC_SAMPLERATE != %u\n" % fs)
+	f.write("#error \"cabinet_ir.h was made for another sample rate\"\n")
+	f.write("#endif\n")
+	f.write("#define CABINET_DEFAULT_IR_LENGTH %u\n" % len(ir))
+	f.write("static const float cabinetDefaultIr[%u] = {\n" % len(ir))
+	for i in range(0, len(ir), 8):
+		f.write("    %s,\n" % ", ".join([ "%.8ff" % h for h in ir[i:i+8] ]))
+	f.write("};\n")
@@ -0,0 +1,37 @@
+#!/usr/bin/python
+#
+# Generate the polyphase table of INTERP_SINC in dsp/interpolation.h, run by
+# the build:
+#
+#   make_sinctable.py <output directory>
+#
+# Writes sinctable.h.
+
+import math
+import sys
+
+TAPS=8
+PHASES=64
+
+def blackman(x):
+	# Over -TAPS/2..TAPS/2
+	a = math.pi * x / (TAPS/2)
+	return 0.42 + 0.5*math.cos(a) + 0.08*math.cos(2*a)
+
+def sinc(x):
+	return 1.0 if x == 0 else math.sin(math.pi*x) / (math.pi*x)
+
+# Windowed sinc for fractional delays, one row per phase and one extra for
+# interpolating between the last phase and the next sample. Rows are
+# normalized to unity gain at DC.
+with open(sys.argv[1] + "/sinctable.h", "w") as f:
+	f.write("// %u tap Blackman windowed sinc in %u phases, made by make_sinctable.py\n" % (TAPS, PHASES))
+	f.write("#define INTERP_SINC_TAPS %u\n" % TAPS)
+	f.write("#define INTERP_SINC_PHASES %u\n" % PHASES)
+	f.write("static const float interpSincTable[%u][%u] = {\n" % (PHASES + 1, TAPS))
+	for p in range(0, PHASES + 1):
+		t = float(p) / PHASES
+		row = [ sinc(x) * blackman(x) for x in [ j - (TAPS/2 - 1) - t for j in range(0, TAPS) ] ]
+		total = sum(row)
+		f.write("    { %s },\n" % ", ".join([ "%.8ff" % (c / total) for c in row ]))
+	f.write("};\n")
@@ -0,0 +1,134 @@
+#!/usr/bin/python
+#
+# Generate the constant tables declared in dsp/tables.h, run by the build:
+#
+#   make_tables.py <output directory> <largest real FFT> <window sizes...>
+#
+# Writes tabledata.h with the sizes and declarations and tabledata.c with the
+# values.
+
+import math
+import sys
+
+SINE_TABLE_SIZE=1024
+TANH_TABLE_SIZE=512
+TANH_TABLE_RANGE=4
+# Half-band filters for each stage of oversampling, as the number of taps of
+# the odd phase and the Kaiser window beta. The first stage has the narrowest
+# transition band, from 20 kHz to 28 kHz at 48 kHz, and all reach about
+# 90 dB of stopband attenuation.
+HALFBANDS=[ (36, 9.25), (12, 11.0), (8, 9.75) ]
+
+outdir = sys.argv[1]
+fftSize = int(sys.argv[2])
+windowSizes = [ int(n) for n in sys.argv[3:] ]
+
+if fftSize < 4 or fftSize & (fftSize - 1):
+	sys.exit("FFT table size must be a power of two")
+
+def hann(n, N):
+	return 0.5 - 0.5*math.cos(2*math.pi*n/N)
+
+def blackmanHarris(n, N):
+	x = 2*math.pi*n/N
+	return 0.35875 - 0.48829*math.cos(x) + 0.14128*math.cos(2*x) - 0.01168*math.cos(3*x)
+
+def flatTop(n, N):
+	x = 2*math.pi*n/N
+	return 0.21557895 - 0.41663158*math.cos(x) + 0.277263158*math.cos(2*x) - 0.083578947*math.cos(3*x) + 0.006947368*math.cos(4*x)
+
+def besselI0(x):
+	s = 1
+	t = 1
+	for k in range(1, 50):
+		t *= (x/(2*k))**2
+		s += t
+	return s
+
+def halfband(taps, beta):
+	# Odd phase of a windowed sinc half-band lowpass, which interpolates
+	# halfway between samples. Normalized to unity gain, and symmetric so
+	# only the first half is kept.
+	g = []
+	for j in range(0, taps):
+		d = j - (taps - 1)/2.0
+		w = besselI0(beta*math.sqrt(1 - (2*d/taps)**2))/besselI0(beta)
+		g.append(math.sin(math.pi*d)/(math.pi*d)*w)
+	return [ v/sum(g) for v in g[0:taps//2] ]
+
+WINDOWS = [ ("Hann", hann), ("BlackmanHarris", blackmanHarris), ("FlatTop", flatTop) ]
+
+def bitrev(i, bits):
+	r = 0
+	for b in range(0, bits):
+		r |= ((i >> b) & 1) << (bits - 1 - b)
+	return r
+
+def floatLiteral(v):
+	s = "%.9g" % v
+	if not any(c in s for c in ".en"):
+		s += ".0"
+	return s + "f"
+
+def floats(f, values, perLine=8):
+	for i in range(0, len(values), perLine):
+		f.write("    %s,\n" % ", ".join([ floatLiteral(v) for v in values[i:i+perLine] ]))
+
+# Only the first three quarters of the twiddles are used by the transforms
+twiddleCount = fftSize * 3 // 4
+bitrevCount = fftSize // 2
+bitrevBits = bitrevCount.bit_length() - 1
+
+with open(outdir + "/tabledata.h", "w") as f:
+	f.write("// Made by make_tables.py, see dsp/tables.h\n")
+	f.write("#pragma once\n\n")
+	f.write("#include <stdint.h>\n")
+	f.write("#include <kiss_fft.h>\n\n")
+	f.write("#define FFT_TABLE_SIZE %u\n" % fftSize)
+	f.write("extern const kiss_fft_cpx fftTwiddles[%u];\n" % twiddleCount)
+	f.write("extern const uint16_t fftBitrev[%u];\n\n" % bitrevCount)
+	for n in windowSizes:
+		for name, w in WINDOWS:
+			f.write("extern const float window%s%u[%u];\n" % (name, n, n))
+	f.write("\n#define SINE_TABLE_SIZE %u\n" % SINE_TABLE_SIZE)
+	f.write("extern const float sineTable[%u];\n" % (SINE_TABLE_SIZE + 1))
+	f.write("#define TANH_TABLE_SIZE %u\n" % TANH_TABLE_SIZE)
+	f.write("#define TANH_TABLE_RANGE %u\n" % TANH_TABLE_RANGE)
+	f.write("extern const float tanhTable[%u];\n\n" % (TANH_TABLE_SIZE + 1))
+	f.write("#define HALFBAND_STAGES %u\n" % len(HALFBANDS))
+	for i, (taps, beta) in enumerate(HALFBANDS):
+		f.write("#define HALFBAND%u_TAPS %u\n" % (i, taps))
+		f.write("extern const float halfband%u[%u];\n" % (i, taps//2))
+
+with open(outdir + "/tabledata.c", "w") as f:
+	f.write("// Made by make_tables.py, see dsp/tables.h\n")
+	f.write("#include \"tabledata.h\"\n\n")
+
+	f.write("const kiss_fft_cpx fftTwiddles[%u] = {\n" % twiddleCount)
+	for k in range(0, twiddleCount, 4):
+		f.write("    %s,\n" % ", ".join([ "{ %s, %s }" % (floatLiteral(math.cos(2*math.pi*j/fftSize)), floatLiteral(-math.sin(2*math.pi*j/fftSize))) for j in range(k, min(k + 4, twiddleCount)) ]))
+	f.write("};\n\n")
+
+	f.write("const uint16_t fftBitrev[%u] = {\n" % bitrevCount)
+	for i in range(0, bitrevCount, 16):
+		f.write("    %s,\n" % ", ".join([ "%u" % bitrev(j, bitrevBits) for j in range(i, min(i + 16, bitrevCount)) ]))
+	f.write("};\n\n")
+
+	for n in windowSizes:
+		for name, w in WINDOWS:
+			f.write("const float window%s%u[%u] = {\n" % (name, n, n))
+			floats(f, [ w(i, n) for i in range(0, n) ])
+			f.write("};\n\n")
+
+	f.write("const float sineTable[%u] = {\n" % (SINE_TABLE_SIZE + 1))
+	floats(f, [ math.sin(2*math.pi*i/SINE_TABLE_SIZE) for i in range(0, SINE_TABLE_SIZE + 1) ])
+	f.write("};\n\n")
+
+	f.write("const float tanhTable[%u] = {\n" % (TANH_TABLE_SIZE + 1))
+	floats(f, [ math.tanh(TANH_TABLE_RANGE*(2.0*i/TANH_TABLE_SIZE - 1)) for i in range(0, TANH_TABLE_SIZE + 1) ])
+	f.write("};\n")
+
+	for i, (taps, beta) in enumerate(HALFBANDS):
+		f.write("\nconst float halfband%u[%u] = {\n" % (i, taps//2))
+		floats(f, halfband(taps, beta))
+		f.write("};\n")
@@ -1,5 +1,11 @@
 /**
- * This is a naive time-domain pitch shifter effect.
+ * Time-domain pitch shifter. Each channel has a read head moving through a
+ * delay line at a rate that sets the pitch, reading between samples with a
+ * windowed sinc. When the head gets too close to the write position, or too
+ * far behind it, it jumps by about a grain. The exact jump is picked by
+ * comparing the waveform the head just played with the waveforms around the
+ * new position (WSOLA), so that the splice lines up in phase, and the old and
+ * new positions are crossfaded.
  */
 
 #include <math.h>
@@ -9,54 +15,189 @@
 #include "pitcher.h"
 #include "utils.h"
 
-void processPitcher(const FloatAudioBuffer* restrict in,
-        FloatAudioBuffer* restrict out, PitcherState* st,
-        const PitcherParams* p)
+#define MASK (PITCHER_CAPACITY - 1)
+#define LOOKAHEAD INTERP_LOOKAHEAD(PITCHER_INTERP)
+
+/// A head moving towards the write position jumps back below this delay. The
+/// delay keeps shrinking by up to a sample per sample while a splice waits for
+/// the next frame and while the old head fades out.
+#define LOW (PITCHER_FADE + CODEC_SAMPLES_PER_FRAME + LOOKAHEAD + 2)
+/// A head falling behind jumps forward above this delay
+#define HIGH (LOW + PITCHER_GRAIN + PITCHER_SEARCH/2 + 1)
+/// Jump without a search when beyond these
+#define LOW_FORCE (LOW - CODEC_SAMPLES_PER_FRAME)
+#define HIGH_FORCE (HIGH + CODEC_SAMPLES_PER_FRAME)
+
+/// Longest delay read, by a head fading out or a search
+#define MAX_DELAY (HIGH_FORCE + \
+        (PITCHER_FADE > PITCHER_WINDOW ? PITCHER_FADE : PITCHER_WINDOW) + \
+        INTERP_MAX_TAPS)
+
+_Static_assert(DELAYLINE_IS_POW2(PITCHER_CAPACITY) &&
+        PITCHER_CAPACITY >= MAX_DELAY, "Bad pitcher line length");
+
+/// Fastest read rate, an octave up
+#define MAX_RATE 2.0f
+
+static inline float readHead(const CodecIntSample* line, size_t now,
+        float delay)
 {
-    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
-        st->readphase[0] += p->speed + p->phasediff;
-        if (st->readphase[0] >= SCAN_LENGTH) {
-            st->readphase[0] -= SCAN_LENGTH;
-        }
-        else if (st->readphase[0] < 0.0f) {
-            st->readphase[0] += SCAN_LENGTH;
+    return delayLineReadInterp(line, MASK, now + PITCHER_CAPACITY - delay,
+            PITCHER_INTERP);
+}
+
+/**
+ * Correlation of two stretches of the line ending at a and b, taking every
+ * step'th sample
+ */
+static int64_t correlate(const CodecIntSample* line, size_t a, size_t b,
+        unsigned step, unsigned count)
+{
+    int64_t sum = 0;
+    for (unsigned k = 0; k < count; k++) {
+        sum += (int32_t)line[(a - k * step) & MASK] *
+                line[(b - k * step) & MASK];
+    }
+    return sum;
+}
+
+/**
+ * Offset to a jump that best matches the waveform at the new position to the
+ * one just played. A coarse pass over every fourth offset is refined around
+ * the best one.
+ */
+static int findSplice(const CodecIntSample* line, size_t now, float delay,
+        int jump)
+{
+    const size_t head = now + PITCHER_CAPACITY - (size_t)delay;
+    int best = 0;
+    int64_t bestCorr = INT64_MIN;
+
+    for (int lag = -PITCHER_SEARCH/2; lag <= PITCHER_SEARCH/2; lag += 4) {
+        const int64_t corr = correlate(line, head, head - jump - lag, 4,
+                PITCHER_WINDOW/4);
+        if (corr > bestCorr) {
+            bestCorr = corr;
+            best = lag;
         }
-        st->readphase[1] += p->speed - p->phasediff;
-        if (st->readphase[1] >= SCAN_LENGTH) {
-            st->readphase[1] -= SCAN_LENGTH;
+    }
+
+    const int coarse = best;
+    bestCorr = INT64_MIN;
+    for (int lag = coarse - 3; lag <= coarse + 3; lag++) {
+        if (lag < -PITCHER_SEARCH/2 || lag > PITCHER_SEARCH/2) {
+            continue;
         }
-        else if (st->readphase[1] < 0.0f) {
-            st->readphase[1] += SCAN_LENGTH;
+        const int64_t corr = correlate(line, head, head - jump - lag, 2,
+                PITCHER_WINDOW/2);
+        if (corr > bestCorr) {
+            bestCorr = corr;
+            best = lag;
         }
+    }
+    return best;
+}
+
+/**
+ * Jump the head if it has run out of line, searching for the splice if there
+ * are searches left in this frame
+ */
+static void moveHead(PitcherHead* h, const CodecIntSample* line, size_t now,
+        unsigned* searches)
+{
+    int jump;
+    if (h->delay < LOW) {
+        jump = PITCHER_GRAIN;
+    }
+    else if (h->delay > HIGH) {
+        jump = -PITCHER_GRAIN;
+    }
+    else {
+        return;
+    }
+
+    int lag = 0;
+    if (*searches) {
+        (*searches)--;
+        lag = findSplice(line, now, h->delay, jump);
+    }
+    else if (h->delay >= LOW_FORCE && h->delay <= HIGH_FORCE) {
+        // Try again in the next frame
+        return;
+    }
+
+    h->oldDelay = h->delay;
+    h->delay += jump + lag;
+    h->fadePos = 0;
+}
+
+void processPitcher(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, PitcherState* st,
+        const PitcherParams* p)
+{
+    // No head reads the samples of this frame before they are processed, nor
+    // the ones overwritten, so the whole frame can be written first
+    delayLineWriteFrame(st->delayline_l, MASK, st->writepos, in, 0);
+    delayLineWriteFrame(st->delayline_r, MASK, st->writepos, in, 1);
 
-        // Mix two offsets in and out with a triangular window
-        const float mix[2] = {
-                fabs(st->readphase[0] - SCAN_LENGTH/2) / (SCAN_LENGTH/2),
-                fabs(st->readphase[1] - SCAN_LENGTH/2) / (SCAN_LENGTH/2),
-        };
+    const CodecIntSample* lines[2] = { st->delayline_l, st->delayline_r };
+    const float rates[2] = {
+            CLAMP(1.0f + p->speed + p->phasediff, 0.0f, MAX_RATE),
+            CLAMP(1.0f + p->speed - p->phasediff, 0.0f, MAX_RATE),
+    };
+    unsigned searches = PITCHER_SEARCHES_PER_FRAME;
 
-        out->s[s][0] =
-                RAMP(p->wet,
-                        RAMP(mix[0],
-                                linterpolate(st->delayline_l, DELAY_LINE_LENGTH, st->writepos + st->readphase[0]),
-                                linterpolate(st->delayline_l, DELAY_LINE_LENGTH, st->writepos + st->readphase[0] + SCAN_LENGTH/2)),
-                                in->s[s][0]);
-        out->s[s][1] =
-                RAMP(p->wet,
-                        RAMP(mix[1],
-                                linterpolate(st->delayline_r, DELAY_LINE_LENGTH, st->writepos + st->readphase[1]),
-                                linterpolate(st->delayline_r, DELAY_LINE_LENGTH, st->writepos + st->readphase[1] + SCAN_LENGTH/2)),
-                                in->s[s][1]);
+    for (unsigned c = 0; c < 2; c++) {
+        PitcherHead* h = &st->heads[c];
+        const float step = 1.0f - rates[c];
 
+        for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+            const size_t now = st->writepos + s;
+            if (h->fadePos == PITCHER_FADE) {
+                moveHead(h, lines[c], now, &searches);
+            }
 
+            float v = readHead(lines[c], now, h->delay);
+            if (h->fadePos < PITCHER_FADE) {
+                const float old = readHead(lines[c], now, h->oldDelay);
+                v = RAMP((float)h->fadePos / PITCHER_FADE, old, v);
+                h->oldDelay += step;
+                h->fadePos++;
+            }
+            h->delay += step;
 
-        st->delayline_l[st->writepos] = in->s[s][0];
-        st->delayline_r[st->writepos] = in->s[s][1];
-        st->writepos = (st->writepos + 1) % DELAY_LINE_LENGTH;
+            out->s[s][c] = RAMP(p->wet, v, in->s[s][c]);
+        }
     }
+
+    st->writepos = (st->writepos + CODEC_SAMPLES_PER_FRAME) & MASK;
 }
 
 void initPitcher(PitcherState* state)
 {
     memset(state, 0, sizeof(*state));
+    for (unsigned c = 0; c < 2; c++) {
+        state->heads[c].delay = (LOW + HIGH) / 2;
+        state->heads[c].oldDelay = state->heads[c].delay;
+        state->heads[c].fadePos = PITCHER_FADE;
+    }
 }
+
+static void nodeInit(void* state)
+{
+    initPitcher(state);
+}
+
+static void nodeProcess(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        void* state, const void* params)
+{
+    processPitcher(in, out, state, params);
+}
+
+const FxNodeType pitcherNode = {
+    .name = "pitcher",
+    .stateSize = sizeof(PitcherState),
+    .heat = ARENA_HOT,
+    .init = nodeInit,
+    .process = nodeProcess
+};
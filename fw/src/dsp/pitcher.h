@@ -2,15 +2,45 @@
 
 #include <stdlib.h>
 #include "codec.h"
+#include "delayline.h"
+#include "fxgraph.h"
 
-#define DELAY_LINE_LENGTH (CODEC_SAMPLERATE/25)
-#define SCAN_LENGTH (DELAY_LINE_LENGTH - 2)
+/// Distance a read head jumps when it runs out of line, about 20 ms
+#define PITCHER_GRAIN (CODEC_SAMPLERATE/50)
+/// Length of the crossfade after a jump, about 10 ms
+#define PITCHER_FADE (CODEC_SAMPLERATE/100)
+/// Range of offsets to the jump tried for the best splice, about 5 ms
+#define PITCHER_SEARCH (CODEC_SAMPLERATE/200)
+/// Length of the waveforms compared for the splice
+#define PITCHER_WINDOW (CODEC_SAMPLERATE/200)
+
+/// Correlation searches allowed per frame. A search takes about
+/// (PITCHER_SEARCH/4 + 1) * PITCHER_WINDOW/4 + 7 * PITCHER_WINDOW/2 multiply
+/// adds, 4500 at 48 kHz. A channel that can't search in a frame tries again in
+/// the next one, and jumps without searching if it can't wait any longer.
+#ifndef PITCHER_SEARCHES_PER_FRAME
+#define PITCHER_SEARCHES_PER_FRAME 1
+#endif
+
+/// Interpolation of the read heads
+#ifndef PITCHER_INTERP
+#define PITCHER_INTERP INTERP_SINC
+#endif
+
+/// Power of two ring holding the longest delay of a read head
+#define PITCHER_CAPACITY (CODEC_SAMPLERATE <= 48000 ? 4096 : 8192)
+
+typedef struct {
+    float delay; ///< Samples behind the write position
+    float oldDelay; ///< Delay of the head fading out after a jump
+    unsigned fadePos; ///< Samples into the crossfade, PITCHER_FADE when done
+} PitcherHead;
 
 typedef struct {
-    CodecIntSample delayline_l[DELAY_LINE_LENGTH];
-    CodecIntSample delayline_r[DELAY_LINE_LENGTH];
+    CodecIntSample delayline_l[DELAYLINE_STORAGE(PITCHER_CAPACITY)];
+    CodecIntSample delayline_r[DELAYLINE_STORAGE(PITCHER_CAPACITY)];
     size_t writepos;
-    float readphase[2];
+    PitcherHead heads[2];
 } PitcherState;
 
 typedef struct {
@@ -28,7 +58,10 @@ typedef struct {
 void initPitcher(PitcherState* state);
 
 /**
- * Run the pitch shifter effect over a buffer of stereo samples.
+ * Run the pitch shifter effect over a buffer of stereo samples. The pitch is
+ * raised by a factor of 1 + speed, plus phasediff in the left channel and
+ * minus phasediff in the right one, between no change and an octave up.
+ * Negative speeds lower it, down to silence at -1.
  *
  * @param in Pointer to input samples
  * @param out Pointer to output samples
@@ -38,3 +71,9 @@ void initPitcher(PitcherState* state);
 void processPitcher(const FloatAudioBuffer* restrict in,
         FloatAudioBuffer* restrict out, PitcherState* state,
         const PitcherParams* params);
+
+/**
+ * Effect graph node running the pitch shifter, with a PitcherState as state and
+ * PitcherParams as parameters
+ */
+extern const FxNodeType pitcherNode;
@@ -0,0 +1,308 @@
+#include <string.h>
+
+#include "reverb.h"
+#include "fastmath.h"
+#include "fixedpoint.h"
+#include "utils.h"
+
+/// Wraps the write position, at the capacity of the longest line so that it
+/// wraps every line at once
+#define POSITION_MASK (2048 - 1)
+
+/// Keeps the Hadamard matrix orthogonal, 1 / sqrt(REVERB_LINES)
+#define HADAMARD_SCALE 0.35355339f
+
+/// Gain of the diffusing allpass filters
+#define DIFFUSION 0.6f
+
+/// Level of the reverb at a mix of 1, about that of the dry signal at a decay
+/// of a second or two
+#define OUTPUT_GAIN 0.25f
+
+struct Line {
+    uint16_t offset; ///< In ReverbState.lines
+    uint16_t mask; ///< Capacity - 1
+    uint16_t length; ///< Delay in samples
+};
+
+/// The network, with lengths that share no factors so that their echoes don't
+/// pile up, then the diffusers
+static const struct Line lines[REVERB_LINES + REVERB_DIFFUSERS] = {
+    { 0, 1023, 601 },
+    { 1024, 1023, 709 },
+    { 2048, 1023, 823 },
+    { 3072, 1023, 953 },
+    { 4096, 2047, 1123 },
+    { 6144, 2047, 1361 },
+    { 8192, 2047, 1627 },
+    { 10240, 2047, 1949 },
+    { 12288, 127, 113 },
+    { 12416, 255, 167 },
+    { 12672, 511, 307 },
+    { 13184, 511, 443 },
+};
+
+_Static_assert(13184 + 512 == REVERB_STORAGE, "Reverb lines don't fill the storage");
+// The diffusers run a sample at a time, so only the network needs this
+_Static_assert(601 >= CODEC_SAMPLES_PER_FRAME, "Reverb lines shorter than a frame");
+
+/// Signs of the line outputs in the left and right outputs, two rows of the
+/// Hadamard matrix
+static const int8_t outputSigns[2][REVERB_LINES] = {
+    { 1, -1, 1, -1, 1, -1, 1, -1 },
+    { 1, 1, -1, -1, 1, 1, -1, -1 },
+};
+
+static inline size_t readIndex(const ReverbState* st, const struct Line* line,
+        unsigned s)
+{
+    return line->offset + ((st->writepos + s - line->length) & line->mask);
+}
+
+static inline size_t writeIndex(const ReverbState* st, const struct Line* line,
+        unsigned s)
+{
+    return line->offset + ((st->writepos + s) & line->mask);
+}
+
+/**
+ * Read the frame's worth of samples a line delays, in at most two runs
+ * either side of the end of the ring
+ */
+static inline void readFrame(const ReverbState* st, const struct Line* line,
+        int32_t* out)
+{
+    const CodecIntSample* ring = &st->lines[line->offset];
+    const size_t start = (st->writepos - line->length) & line->mask;
+    const size_t capacity = (size_t)line->mask + 1;
+    const unsigned first = capacity - start < CODEC_SAMPLES_PER_FRAME ?
+            capacity - start : CODEC_SAMPLES_PER_FRAME;
+    for (unsigned s = 0; s < first; s++) {
+        out[s] = ring[start + s];
+    }
+    for (unsigned s = first; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        out[s] = ring[s - first];
+    }
+}
+
+/**
+ * Gains of the lines for the decay time, including the scaling of the
+ * Hadamard matrix
+ */
+static void lineGains(const ReverbParams* p, float* gains)
+{
+    // -60 dB, a factor of 2^(-3 * log2(10)), over the decay time
+    const float decay = p->decay > 0.01f ? p->decay : 0.01f;
+    const float perSample = -3 * 3.32192809f / (decay * CODEC_SAMPLERATE);
+    for (unsigned i = 0; i < REVERB_LINES; i++) {
+        gains[i] = HADAMARD_SCALE * fastExp2(perSample * lines[i].length);
+    }
+}
+
+/**
+ * Coefficient of the damping lowpass filters, down to a cutoff of about
+ * 800 Hz at 48 kHz
+ */
+static float dampingCoeff(const ReverbParams* p)
+{
+    return 1.0f - 0.9f * (CLAMP(p->damping, 0.0f, 1.0f));
+}
+
+/// Fraction bits of the samples in the network of the fixed point version
+#define FIXED_FRACTION 12
+
+static inline void hadamard(float* x)
+{
+    for (unsigned h = 1; h < REVERB_LINES; h *= 2) {
+        for (unsigned i = 0; i < REVERB_LINES; i += 2 * h) {
+            for (unsigned j = i; j < i + h; j++) {
+                const float a = x[j];
+                const float b = x[j + h];
+                x[j] = a + b;
+                x[j + h] = a - b;
+            }
+        }
+    }
+}
+
+static inline void hadamardFixed(int32_t* x)
+{
+    for (unsigned h = 1; h < REVERB_LINES; h *= 2) {
+        for (unsigned i = 0; i < REVERB_LINES; i += 2 * h) {
+            for (unsigned j = i; j < i + h; j++) {
+                const int32_t a = x[j];
+                const int32_t b = x[j + h];
+                x[j] = a + b;
+                x[j + h] = a - b;
+            }
+        }
+    }
+}
+
+/**
+ * Run a frame of the mono input through the diffusers, in place. The samples
+ * stored are rounded towards zero, as rounding to the nearest would let the
+ * last step of a decaying tail go round forever.
+ */
+static void diffuse(ReverbState* st, float* x)
+{
+    for (unsigned d = 0; d < REVERB_DIFFUSERS; d++) {
+        const struct Line* line = &lines[REVERB_LINES + d];
+        for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+            const float delayed = st->lines[readIndex(st, line, s)];
+            const int32_t w = ssat16((int32_t)(x[s] + DIFFUSION * delayed));
+            st->lines[writeIndex(st, line, s)] = w;
+            x[s] = delayed - DIFFUSION * w;
+        }
+    }
+}
+
+void processReverb(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, ReverbState* st,
+        const ReverbParams* p)
+{
+    float gains[REVERB_LINES];
+    lineGains(p, gains);
+    const float damp = dampingCoeff(p);
+    const float mix = OUTPUT_GAIN * p->mix;
+
+    float input[CODEC_SAMPLES_PER_FRAME];
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        input[s] = 0.5f * (in->s[s][0] + in->s[s][1]);
+    }
+    diffuse(st, input);
+
+    // Every line is at least a frame long, so the whole frame can be read
+    // before writing any of it
+    int32_t delayed[REVERB_LINES][CODEC_SAMPLES_PER_FRAME];
+    for (unsigned i = 0; i < REVERB_LINES; i++) {
+        readFrame(st, &lines[i], delayed[i]);
+    }
+
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        float wet[2] = { 0.0f, 0.0f };
+        float x[REVERB_LINES];
+        for (unsigned i = 0; i < REVERB_LINES; i++) {
+            const float v = delayed[i][s];
+            wet[0] += outputSigns[0][i] * v;
+            wet[1] += outputSigns[1][i] * v;
+            st->lowpass[i] += damp * (gains[i] * v - st->lowpass[i]);
+            x[i] = st->lowpass[i];
+        }
+        hadamard(x);
+
+        // A tail whose loss each time round is less than a step of the
+        // samples would be stuck at a level where rounding makes up for the
+        // loss. Adding the error of rounding a sample to the next one instead
+        // keeps the average right, so the tail keeps decaying.
+        for (unsigned i = 0; i < REVERB_LINES; i++) {
+            const float v = x[i] + input[s] + st->quantError[i];
+            const int32_t rounded = fastFloor(v + 0.5f);
+            st->quantError[i] = v - rounded;
+            st->lines[writeIndex(st, &lines[i], s)] = ssat16(rounded);
+        }
+
+        out->s[s][0] = in->s[s][0] + mix * wet[0];
+        out->s[s][1] = in->s[s][1] + mix * wet[1];
+    }
+    st->writepos = (st->writepos + CODEC_SAMPLES_PER_FRAME) & POSITION_MASK;
+}
+
+/**
+ * Fixed point version of diffuse()
+ */
+static void diffuseFixed(ReverbState* st, int32_t* x)
+{
+    const int32_t g = FLOAT_TO_Q15(DIFFUSION);
+    for (unsigned d = 0; d < REVERB_DIFFUSERS; d++) {
+        const struct Line* line = &lines[REVERB_LINES + d];
+        for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+            const int32_t delayed = st->lines[readIndex(st, line, s)];
+            // Dividing rounds towards zero, unlike a shift
+            const int32_t w = ssat16(x[s] + g * delayed / Q15_ONE);
+            st->lines[writeIndex(st, line, s)] = w;
+            x[s] = delayed - g * w / Q15_ONE;
+        }
+    }
+}
+
+void processReverbFixed(const AudioBuffer* restrict in,
+        AudioBuffer* restrict out, ReverbState* st,
+        const ReverbParams* p)
+{
+    float floatGains[REVERB_LINES];
+    lineGains(p, floatGains);
+    int32_t gains[REVERB_LINES];
+    for (unsigned i = 0; i < REVERB_LINES; i++) {
+        gains[i] = FLOAT_TO_Q15(floatGains[i]);
+    }
+    const int32_t damp = FLOAT_TO_Q15(dampingCoeff(p));
+    const int32_t mix = FLOAT_TO_Q15(OUTPUT_GAIN * p->mix);
+
+    int32_t input[CODEC_SAMPLES_PER_FRAME];
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        input[s] = (in->s[s][0] + in->s[s][1]) >> 1;
+    }
+    diffuseFixed(st, input);
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        input[s] *= 1 << FIXED_FRACTION;
+    }
+
+    int32_t delayed[REVERB_LINES][CODEC_SAMPLES_PER_FRAME];
+    for (unsigned i = 0; i < REVERB_LINES; i++) {
+        readFrame(st, &lines[i], delayed[i]);
+    }
+
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        int32_t wet[2] = { 0, 0 };
+        int32_t x[REVERB_LINES];
+        for (unsigned i = 0; i < REVERB_LINES; i++) {
+            wet[0] += outputSigns[0][i] * delayed[i][s];
+            wet[1] += outputSigns[1][i] * delayed[i][s];
+            // Below a third of full scale after the gain, so that the sum of
+            // the Hadamard matrix fits in 32 bits with the fraction bits
+            const int32_t v = (gains[i] * delayed[i][s]) >> (15 - FIXED_FRACTION);
+            st->lowpassFixed[i] += ((int64_t)(v - st->lowpassFixed[i]) * damp) >> 15;
+            x[i] = st->lowpassFixed[i];
+        }
+        hadamardFixed(x);
+
+        // Rounding with the error carried on, like in processReverb()
+        for (unsigned i = 0; i < REVERB_LINES; i++) {
+            const int32_t v = x[i] + input[s] + st->quantErrorFixed[i];
+            const int32_t rounded = (v + (1 << (FIXED_FRACTION - 1))) >> FIXED_FRACTION;
+            st->quantErrorFixed[i] = v - rounded * (1 << FIXED_FRACTION);
+            st->lines[writeIndex(st, &lines[i], s)] = ssat16(rounded);
+        }
+
+        // Drop two bits of the sum of eight lines to keep the product in 32
+        // bits
+        out->s[s][0] = ssat16(in->s[s][0] + ((mix * (wet[0] >> 2)) >> 13));
+        out->s[s][1] = ssat16(in->s[s][1] + ((mix * (wet[1] >> 2)) >> 13));
+    }
+    st->writepos = (st->writepos + CODEC_SAMPLES_PER_FRAME) & POSITION_MASK;
+}
+
+void initReverb(ReverbState* state)
+{
+    memset(state, 0, sizeof(*state));
+}
+
+static void nodeInit(void* state)
+{
+    initReverb(state);
+}
+
+static void nodeProcess(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        void* state, const void* params)
+{
+    processReverb(in, out, state, params);
+}
+
+const FxNodeType reverbNode = {
+    .name = "reverb",
+    .stateSize = sizeof(ReverbState),
+    .heat = ARENA_HOT,
+    .init = nodeInit,
+    .process = nodeProcess
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+/**
+ * Reverb from a feedback delay network. The input, summed to mono, is smeared
+ * by a few allpass filters in series and fed to eight delay lines, whose
+ * outputs are damped by a one-pole lowpass each, mixed through a Hadamard
+ * matrix and fed back. The left and right outputs are two orthogonal
+ * combinations of the line outputs, so they are uncorrelated.
+ *
+ * All lines keep int16 samples in one block sized to fit in what the
+ * applications leave of the CCM, about 27 KB. Each line is a power of two long
+ * and read at a whole number of samples, without interpolation. Their lengths
+ * are fixed in samples, so the room gets bigger at lower sample rates, and
+ * those of the network are at least a frame, so that a whole frame can be read
+ * from every line before any of it is written.
+ */
+
+#include "codec.h"
+#include "fxgraph.h"
+
+/// Lines in the feedback network, mixed by a Hadamard matrix
+#define REVERB_LINES 8
+
+/// Allpass filters the input goes through before the network
+#define REVERB_DIFFUSERS 4
+
+/// Samples of all lines together: four of 1024 and four of 2048 for the
+/// network, and 128, 256, 512 and 512 for the diffusers
+#define REVERB_STORAGE (4 * 1024 + 4 * 2048 + 128 + 256 + 2 * 512)
+
+typedef struct {
+    CodecIntSample lines[REVERB_STORAGE];
+    float lowpass[REVERB_LINES]; ///< Of the damping filters
+    float quantError[REVERB_LINES]; ///< Of rounding the last sample written
+    /// The same in the fixed point version, with 12 fraction bits
+    int32_t lowpassFixed[REVERB_LINES];
+    int32_t quantErrorFixed[REVERB_LINES];
+    size_t writepos;
+} ReverbState;
+
+typedef struct {
+    float decay; ///< Seconds for the tail to fall by 60 dB
+    float damping; ///< 0 to 1, how much faster high frequencies die out
+    float mix; ///< Level of the reverb added to the dry signal, 0 to 1
+} ReverbParams;
+
+/**
+ * Initialize the reverb effect, creating a predictable state
+ *
+ * @param state State structure to initialize. Should be allocated by the caller
+ * and passed to subsequent calls to processReverb().
+ */
+void initReverb(ReverbState* state);
+
+/**
+ * Run the reverb effect over a buffer of stereo samples. The output is the
+ * input plus the reverb.
+ *
+ * @param in Pointer to input samples
+ * @param out Pointer to output samples
+ * @param state Mutable state of the effect, such as the delay line data
+ * @param param Input parameters to the effect
+ */
+void processReverb(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, ReverbState* state,
+        const ReverbParams* params);
+
+/**
+ * Fixed point version of processReverb(), working directly on codec samples.
+ * It shares the state with the floating point version.
+ */
+void processReverbFixed(const AudioBuffer* restrict in,
+        AudioBuffer* restrict out, ReverbState* state,
+        const ReverbParams* params);
+
+/**
+ * Effect graph node running the reverb, with a ReverbState as state and
+ * ReverbParams as parameters
+ */
+extern const FxNodeType reverbNode;
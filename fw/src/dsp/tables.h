@@ -0,0 +1,30 @@
+#pragma once
+
+/**
+ * Constant tables generated at build time by make_tables.py, for the sizes
+ * configured in the makefile, so that they are in flash and take no time to
+ * set up:
+ *
+ * fftTwiddles: exp(-2 pi i k / FFT_TABLE_SIZE), the twiddle factors of the
+ *     radix4 FFT backend for real transforms of up to FFT_TABLE_SIZE and
+ *     complex ones of half that. Smaller sizes take every n'th entry.
+ * fftBitrev: Bit-reversed indexes for complex transforms of FFT_TABLE_SIZE / 2.
+ *     Smaller sizes shift them down.
+ * windowHann<n>, windowBlackmanHarris<n>, windowFlatTop<n>: Periodic windows
+ *     for the sizes in WINDOW_SIZES, peaking at 1.
+ * sineTable: One period of a sine in SINE_TABLE_SIZE steps, plus the first
+ *     value again for interpolating.
+ * tanhTable: tanh from -TANH_TABLE_RANGE to TANH_TABLE_RANGE in
+ *     TANH_TABLE_SIZE steps, plus the last value.
+ * halfband<n>: First half of the symmetric odd phase of the half-band filter
+ *     for oversampling stage n, HALFBAND<n>_TAPS long in full, see halfband.h.
+ */
+
+#include "tabledata.h"
+
+#define TABLES_CONCAT(a, b) a ## b
+/// Window tables by size, e.g. WINDOW_HANN(HARMONIZER_FFT_SIZE). A size
+/// missing from WINDOW_SIZES gives an undeclared windowHann<n>.
+#define WINDOW_HANN(n) TABLES_CONCAT(windowHann, n)
+#define WINDOW_BLACKMAN_HARRIS(n) TABLES_CONCAT(windowBlackmanHarris, n)
+#define WINDOW_FLAT_TOP(n) TABLES_CONCAT(windowFlatTop, n)
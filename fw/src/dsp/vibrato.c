@@ -2,33 +2,100 @@
 
 #include "vibrato.h"
 #include "codec.h"
+#include "fixedpoint.h"
 #include "utils.h"
 #include "waveshaper.h"
 
+#define MASK (VIBRATO_LINELEN - 1)
+
+_Static_assert(DELAYLINE_IS_POW2(VIBRATO_LINELEN) &&
+        VIBRATO_LINELEN >= 2 * (VIBRATO_MAX_DEPTH + INTERP_TAPS(VIBRATO_INTERP)) +
+        CODEC_SAMPLES_PER_FRAME, "Bad vibrato line length");
+
+/// Read position of the centre of the modulation, VIBRATO_MAX_DEPTH behind
+/// the write position, and further by what the kernel reads ahead
+#define CENTRE(writepos, kernel) ((writepos) + VIBRATO_LINELEN - \
+        VIBRATO_MAX_DEPTH - INTERP_LOOKAHEAD(kernel))
+
 void processVibrato(const FloatAudioBuffer* restrict in,
         FloatAudioBuffer* restrict out, VibratoState* st,
         const VibratoParams* p)
 {
+    // Depths are below VIBRATO_MAX_DEPTH, so no read goes past the sample
+    // being processed, and the line is long enough to not overwrite any
+    // sample still read in this frame. So the whole frame can be written first.
+    delayLineWriteFrameFloat(st->delayline_l, MASK, st->writepos, in, 0);
+    delayLineWriteFrameFloat(st->delayline_r, MASK, st->writepos, in, 1);
+
+    const LfoParams lfo = { .shape = p->shape, .speed = p->speed };
+    const float offsets[2] = { p->phasediff, -p->phasediff };
+    float mod[2][CODEC_SAMPLES_PER_FRAME];
+    lfoProcess(&st->lfo, &lfo, NULL, offsets, 2, mod);
+
     for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
-        st->delayline_l[st->writepos] = in->s[s][0];
-        st->delayline_r[st->writepos] = in->s[s][1];
-
-        const float offset0 = p->depth * sinf(st->phase + p->phasediff);
-        const float offset1 = p->depth * sinf(st->phase - p->phasediff);
-        out->s[s][0] = linterpolateFloat(st->delayline_l, VIBRATO_LINELEN, offset0 +
-                (st->writepos + (VIBRATO_LINELEN/2)));
-        out->s[s][1] = linterpolateFloat(st->delayline_r, VIBRATO_LINELEN, offset1 +
-                (st->writepos + (VIBRATO_LINELEN/2)));
-
-        st->writepos = (st->writepos + 1) % VIBRATO_LINELEN;
-        st->phase += p->speed;
-        if (st->phase >= M_PI) {
-            st->phase -= 2*M_PI;
-        }
+        const float offset0 = p->depth * mod[0][s];
+        const float offset1 = p->depth * mod[1][s];
+        out->s[s][0] = delayLineReadInterpFloat(st->delayline_l, MASK,
+                offset0 + CENTRE(st->writepos, VIBRATO_INTERP), VIBRATO_INTERP);
+        out->s[s][1] = delayLineReadInterpFloat(st->delayline_r, MASK,
+                offset1 + CENTRE(st->writepos, VIBRATO_INTERP), VIBRATO_INTERP);
+
+        st->writepos = (st->writepos + 1) & MASK;
     }
 }
 
 void initVibrato(VibratoState* state)
+{
+    memset(state, 0, sizeof(*state));
+    initLfo(&state->lfo);
+}
+
+void processVibratoFixed(const AudioBuffer* restrict in,
+        AudioBuffer* restrict out, FixedVibratoState* st,
+        const VibratoParams* p)
+{
+    // Radians to fractions of a full turn of the uint32_t phase
+    const float turn = 4294967296.0f / (2 * M_PI);
+    const uint32_t speed = p->speed * turn;
+    const uint32_t phasediff = p->phasediff * turn;
+    // Depth in Q8.8 samples, so depth * sin in Q15 is Q16.16 after a shift
+    const int32_t depth = p->depth * 256;
+
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        delayLineWrite(st->delayline_l, MASK, st->writepos, in->s[s][0]);
+        delayLineWrite(st->delayline_r, MASK, st->writepos, in->s[s][1]);
+
+        const uint32_t centre = (uint32_t)CENTRE(st->writepos, INTERP_LINEAR) << 16;
+        const int32_t offset0 = (depth * sinQ15(st->phase + phasediff)) >> 7;
+        const int32_t offset1 = (depth * sinQ15(st->phase - phasediff)) >> 7;
+        out->s[s][0] = delayLineReadFixed(st->delayline_l, MASK, centre + offset0);
+        out->s[s][1] = delayLineReadFixed(st->delayline_r, MASK, centre + offset1);
+
+        st->writepos = (st->writepos + 1) & MASK;
+        st->phase += speed;
+    }
+}
+
+void initVibratoFixed(FixedVibratoState* state)
 {
     memset(state, 0, sizeof(*state));
 }
+
+static void nodeInit(void* state)
+{
+    initVibrato(state);
+}
+
+static void nodeProcess(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        void* state, const void* params)
+{
+    processVibrato(in, out, state, params);
+}
+
+const FxNodeType vibratoNode = {
+    .name = "vibrato",
+    .stateSize = sizeof(VibratoState),
+    .heat = ARENA_HOT,
+    .init = nodeInit,
+    .process = nodeProcess
+};
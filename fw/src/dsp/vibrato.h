@@ -1,21 +1,44 @@
 #pragma once
 
 #include "codec.h"
+#include "delayline.h"
+#include "fxgraph.h"
+#include "lfo.h"
 
 #define VIBRATO_MAX_DEPTH 50
-#define VIBRATO_LINELEN (VIBRATO_MAX_DEPTH * 2)
+
+/// Interpolation of the floating point version, the fixed point one is linear
+#ifndef VIBRATO_INTERP
+#define VIBRATO_INTERP INTERP_HERMITE
+#endif
+/// Power of two holding twice the depth plus what the interpolation reads
+/// around it, and a frame, which is written to the line before reading any of it
+#define VIBRATO_LINELEN (2 * (VIBRATO_MAX_DEPTH + INTERP_MAX_TAPS) + \
+        CODEC_SAMPLES_PER_FRAME <= 256 ? 256 : 512)
 
 typedef struct {
-    float delayline_l[VIBRATO_LINELEN];
-    float delayline_r[VIBRATO_LINELEN];
+    float delayline_l[DELAYLINE_STORAGE(VIBRATO_LINELEN)];
+    float delayline_r[DELAYLINE_STORAGE(VIBRATO_LINELEN)];
     size_t writepos;
-    float phase;
+    LfoState lfo;
 } VibratoState;
 
+/**
+ * State for the fixed point vibrato, which keeps codec samples in its delay
+ * lines and the LFO phase as a fraction of a full turn.
+ */
+typedef struct {
+    CodecIntSample delayline_l[DELAYLINE_STORAGE(VIBRATO_LINELEN)];
+    CodecIntSample delayline_r[DELAYLINE_STORAGE(VIBRATO_LINELEN)];
+    size_t writepos;
+    uint32_t phase;
+} FixedVibratoState;
+
 typedef struct {
-    float speed;
-    float depth;
-    float phasediff;
+    float speed; ///< Radians per sample
+    float depth; ///< Samples, below VIBRATO_MAX_DEPTH
+    float phasediff; ///< Radians the left channel leads and the right lags
+    LfoShape shape; ///< The fixed point version is always a sine
 } VibratoParams;
 
 /**
@@ -37,3 +60,21 @@ void initVibrato(VibratoState* state);
 void processVibrato(const FloatAudioBuffer* restrict in,
         FloatAudioBuffer* restrict out, VibratoState* state,
         const VibratoParams* params);
+
+/**
+ * Initialize the fixed point vibrato effect, creating a predictable state
+ */
+void initVibratoFixed(FixedVibratoState* state);
+
+/**
+ * Fixed point version of processVibrato(), working directly on codec samples.
+ */
+void processVibratoFixed(const AudioBuffer* restrict in,
+        AudioBuffer* restrict out, FixedVibratoState* state,
+        const VibratoParams* params);
+
+/**
+ * Effect graph node running the vibrato, with a VibratoState as state and
+ * VibratoParams as parameters
+ */
+extern const FxNodeType vibratoNode;
@@ -3,6 +3,7 @@
 
 #include "wahwah.h"
 #include "codec.h"
+#include "fastmath.h"
 #include "utils.h"
 #include "waveshaper.h"
 
@@ -10,17 +11,59 @@ void processWahwah(const FloatAudioBuffer* restrict in,
         FloatAudioBuffer* restrict out, WahwahState* state,
         const WahwahParams* params)
 {
-    // Set centre wah bandpass frequency to 200..800 Hz
-    const float wah = RAMP(params->wah, HZ2OMEGA(200), HZ2OMEGA(800));
-    // Set bandpass Q to 1..32, on an exponential scale
-    const float q = exp2f(RAMP(params->q, 0.0f, 5.0f));
-
-    FloatBiquadCoeffs coeffs;
-    bqMakeBandpass(&coeffs, wah, q);
-    bqProcess(in, out, &coeffs, &state->bqstate);
+    float peak = params->wah;
+    if (params->sweep) {
+        // The filter follows the LFO at the end of each frame, and the
+        // cascade ramps to it over the frame
+        float mod[1][CODEC_SAMPLES_PER_FRAME];
+        const float offset = 0;
+        lfoProcess(&state->lfo, &params->lfo, in, &offset, 1, mod);
+        peak = CLAMP(peak + params->sweep * mod[0][CODEC_SAMPLES_PER_FRAME - 1],
+                0.0f, 1.0f);
+    }
+
+    // Only redesign the filter when the peak or resonance change; the cascade
+    // interpolates to the new coefficients over the frame.
+    if (peak != state->peak || params->q != state->q) {
+        // Set centre wah bandpass frequency to 200..800 Hz
+        const float wah = RAMP(peak, HZ2OMEGA(200), HZ2OMEGA(800));
+        // Set bandpass Q to 1..32, on an exponential scale
+        const float q = fastExp2(RAMP(params->q, 0.0f, 5.0f));
+
+        FloatBiquadCoeffs coeffs;
+        bqMakeBandpass(&coeffs, wah, q);
+        bqCascadeSetStage(&state->filter, 0, &coeffs);
+        state->peak = peak;
+        state->q = params->q;
+    }
+
+    bqCascadeProcess(in, out, &state->filter);
 }
 
 void initWahwah(WahwahState* state)
 {
     memset(state, 0, sizeof(*state));
+    bqCascadeInit(&state->filter, 1);
+    initLfo(&state->lfo);
+    // Out of range, so the filter is designed on the first frame
+    state->peak = -1.0f;
+}
+
+static void nodeInit(void* state)
+{
+    initWahwah(state);
 }
+
+static void nodeProcess(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        void* state, const void* params)
+{
+    processWahwah(in, out, state, params);
+}
+
+const FxNodeType wahwahNode = {
+    .name = "wahwah",
+    .stateSize = sizeof(WahwahState),
+    .heat = ARENA_HOT,
+    .init = nodeInit,
+    .process = nodeProcess
+};
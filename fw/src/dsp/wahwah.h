@@ -2,16 +2,25 @@
 
 #include "biquad.h"
 #include "codec.h"
-
-typedef struct {
-    FloatBiquadState bqstate;
-} WahwahState;
+#include "fxgraph.h"
+#include "lfo.h"
 
 typedef struct {
     float wah; ///< peak, 0..1
     float q; ///< resonance, 0..1
+    /// How far the LFO moves the peak from wah, 0 for none. With an
+    /// LFO_ENVELOPE this is an auto-wah that opens up when playing harder.
+    float sweep;
+    LfoParams lfo;
 } WahwahParams;
 
+typedef struct {
+    FloatBiquadCascade filter;
+    LfoState lfo;
+    float peak; ///< Peak the filter was last designed for, 0..1
+    float q; ///< Resonance the filter was last designed for
+} WahwahState;
+
 /**
  * Initialize the wah-wah effect, creating a predictable state
  *
@@ -31,3 +40,9 @@ void initWahwah(WahwahState* state);
 void processWahwah(const FloatAudioBuffer* restrict in,
         FloatAudioBuffer* restrict out, WahwahState* state,
         const WahwahParams* params);
+
+/**
+ * Effect graph node running the wah-wah, with a WahwahState as state and
+ * WahwahParams as parameters
+ */
+extern const FxNodeType wahwahNode;
@@ -0,0 +1,348 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "fastmath.h"
+#include "platform.h"
+#include "waveshaper.h"
+
+/// Frames between reports, about five seconds
+#define REPORT_FRAMES (5 * CODEC_SAMPLERATE / CODEC_SAMPLES_PER_FRAME)
+
+/// Below this input step ADAA takes the curve at the midpoint instead of
+/// dividing by the step, which would amplify rounding errors
+#define ADAA_EPSILON 1e-3f
+
+static const char* const curveNames[] = {
+    [DRIVE_CURVE_MIX] = "mix",
+    [DRIVE_CURVE_SOFT] = "soft",
+    [DRIVE_CURVE_TUBE] = "tube",
+    [DRIVE_CURVE_TANH] = "tanh",
+    [DRIVE_CURVE_HARD] = "hard",
+};
+
+// The curves and their antiderivatives, on samples scaled to full scale 1.
+// All but tanh reach exactly 1 at an input of 1. They all take the mix of
+// DRIVE_CURVE_MIX, so that the block loops can take any of them.
+
+static inline float curveSoft(float x, float mix)
+{
+    // Same as saturateSoft()
+    (void)mix;
+    const float a = 0.2f;
+    x = CLAMP(x, -1.0f, 1.0f);
+    return (1 + a) * x - a * x * x * x;
+}
+
+static inline float integralSoft(float x, float mix)
+{
+    (void)mix;
+    const float ax = fabsf(x);
+    if (ax > 1) {
+        return ax - 0.45f;
+    }
+    const float x2 = x * x;
+    return 0.6f * x2 - 0.05f * x2 * x2;
+}
+
+static inline float curveTube(float x, float mix)
+{
+    // Same as tubeSaturate() with k = 2
+    (void)mix;
+    const float y = 3 * x / (1 + 2 * fabsf(x));
+    return CLAMP(y, -1.0f, 1.0f);
+}
+
+static inline float integralTube(float x, float mix)
+{
+    (void)mix;
+    const float ax = fabsf(x);
+    if (ax > 1) {
+        // 1.5 - 0.75 ln(3) at 1, then a straight line
+        return ax - 0.323959062f;
+    }
+    return 1.5f * ax - 0.75f * FASTMATH_LN2 * fastLog2(1 + 2 * ax);
+}
+
+static inline float curveMix(float x, float mix)
+{
+    return RAMP(mix, curveSoft(x, mix), curveTube(x, mix));
+}
+
+static inline float integralMix(float x, float mix)
+{
+    return RAMP(mix, integralSoft(x, mix), integralTube(x, mix));
+}
+
+static inline float curveHard(float x, float mix)
+{
+    (void)mix;
+    return CLAMP(x, -1.0f, 1.0f);
+}
+
+static inline float integralHard(float x, float mix)
+{
+    (void)mix;
+    const float ax = fabsf(x);
+    return ax > 1 ? ax - 0.5f : 0.5f * x * x;
+}
+
+static inline float curveTanh(float x, float mix)
+{
+    (void)mix;
+    return fastTanh(x);
+}
+
+/// The antiderivative of tanh is ln(cosh(x)) = |x| + ln(1 + exp(-2|x|)) - ln(2).
+/// This is all but the |x| part, which is left to the caller.
+static inline float integralTanhPart(float x)
+{
+    return FASTMATH_LN2 * fastLog2(1 + fastExp2(-2 * FASTMATH_LOG2E * fabsf(x)));
+}
+
+typedef float (*CurveFunction)(float x, float mix);
+
+static inline __attribute__((always_inline)) void shapeBlock(float* x,
+        unsigned n, float mix, CurveFunction curve)
+{
+    for (unsigned i = 0; i < n; i++) {
+        x[i] = curve(x[i], mix);
+    }
+}
+
+/**
+ * First order ADAA of a curve that stays at 1 beyond 1: each output is the
+ * average of the curve between the last input and this one, from the
+ * difference of the antiderivative. Each antiderivative is taken once and kept
+ * for the next sample.
+ */
+static inline __attribute__((always_inline)) void shapeBlockAdaa(float* x,
+        unsigned n, float mix, float x1, CurveFunction curve,
+        CurveFunction integral)
+{
+    float i1 = integral(x1, mix);
+    for (unsigned i = 0; i < n; i++) {
+        const float v = x[i];
+        const float iv = integral(v, mix);
+        const float dx = v - x1;
+        if ((v >= 1 && x1 >= 1) || (v <= -1 && x1 <= -1)) {
+            x[i] = v > 0 ? 1 : -1;
+        }
+        else if (fabsf(dx) < ADAA_EPSILON) {
+            x[i] = curve(0.5f * (v + x1), mix);
+        }
+        else {
+            x[i] = (iv - i1) / dx;
+        }
+        x1 = v;
+        i1 = iv;
+    }
+}
+
+/**
+ * ADAA of tanh, which never quite saturates. The |x| parts of the
+ * antiderivative cancel exactly when both inputs have the same sign, leaving
+ * small numbers that don't lose precision in the difference.
+ */
+static void shapeBlockAdaaTanh(float* x, unsigned n, float x1)
+{
+    float i1 = integralTanhPart(x1);
+    for (unsigned i = 0; i < n; i++) {
+        const float v = x[i];
+        const float iv = integralTanhPart(v);
+        const float dx = v - x1;
+        if (fabsf(dx) < ADAA_EPSILON) {
+            x[i] = fastTanh(0.5f * (v + x1));
+        }
+        else {
+            x[i] = (fabsf(v) - fabsf(x1) + iv - i1) / dx;
+        }
+        x1 = v;
+        i1 = iv;
+    }
+}
+
+/**
+ * Apply the curve to a block of one channel at the oversampled rate
+ *
+ * @param last The input before the block, updated to the last one
+ */
+static void shape(float* x, unsigned n, float* last, const DriveParams* p)
+{
+    const float x1 = *last;
+    const float mix = p->tubeMix;
+    // Also kept without ADAA, so that turning it on doesn't click
+    *last = x[n - 1];
+
+    switch (p->curve) {
+    case DRIVE_CURVE_SOFT:
+        if (p->adaa) {
+            shapeBlockAdaa(x, n, mix, x1, curveSoft, integralSoft);
+        }
+        else {
+            shapeBlock(x, n, mix, curveSoft);
+        }
+        break;
+    case DRIVE_CURVE_TUBE:
+        if (p->adaa) {
+            shapeBlockAdaa(x, n, mix, x1, curveTube, integralTube);
+        }
+        else {
+            shapeBlock(x, n, mix, curveTube);
+        }
+        break;
+    case DRIVE_CURVE_TANH:
+        if (p->adaa) {
+            shapeBlockAdaaTanh(x, n, x1);
+        }
+        else {
+            shapeBlock(x, n, mix, curveTanh);
+        }
+        break;
+    case DRIVE_CURVE_HARD:
+        if (p->adaa) {
+            shapeBlockAdaa(x, n, mix, x1, curveHard, integralHard);
+        }
+        else {
+            shapeBlock(x, n, mix, curveHard);
+        }
+        break;
+    default:
+        if (p->adaa) {
+            shapeBlockAdaa(x, n, mix, x1, curveMix, integralMix);
+        }
+        else {
+            shapeBlock(x, n, mix, curveMix);
+        }
+    }
+}
+
+static unsigned oversampleStages(const DriveParams* p)
+{
+    unsigned stages = 0;
+    while (stages < HALFBAND_STAGES && p->oversample >= 2u << stages) {
+        stages++;
+    }
+    return stages;
+}
+
+void initDrive(DriveState* st)
+{
+    memset(st, 0, sizeof(*st));
+    loadMeterReset(&st->stats);
+    atomic_init(&st->reportReady, false);
+}
+
+void processDrive(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        DriveState* st, const DriveParams* p)
+{
+    const uint32_t start = cycleCounter();
+
+    st->clip = willClip(in);
+
+    const unsigned stages = oversampleStages(p);
+    if (stages != st->stages) {
+        memset(st->upHistory, 0, sizeof(st->upHistory));
+        memset(st->downHistory, 0, sizeof(st->downHistory));
+        st->stages = stages;
+    }
+
+    const float gain = p->gainExp / INT16_MAX;
+    for (unsigned c = 0; c < 2; c++) {
+        // The signal of this channel is always in the work buffer w, after
+        // room for the history of the next filter
+        unsigned w = 0;
+        unsigned n = CODEC_SAMPLES_PER_FRAME;
+        float* x = st->work[w] + DRIVE_WORK_HISTORY;
+        for (unsigned s = 0; s < n; s++) {
+            x[s] = in->s[s][c] * gain;
+        }
+
+        for (unsigned stage = 0; stage < stages; stage++) {
+            const HalfbandFilter* filter = &halfbandStages[stage];
+            const unsigned h = HALFBAND_UP_HISTORY(filter->tapCount);
+            float* next = st->work[!w] + DRIVE_WORK_HISTORY;
+            memcpy(x - h, st->upHistory[stage][c], h * sizeof(float));
+            halfbandUp(filter, x, n, next);
+            memcpy(st->upHistory[stage][c], x + n - h, h * sizeof(float));
+            w = !w;
+            x = next;
+            n *= 2;
+        }
+
+        shape(x, n, &st->adaaLast[c], p);
+
+        for (unsigned stage = stages; stage-- > 0; ) {
+            const HalfbandFilter* filter = &halfbandStages[stage];
+            const unsigned h = HALFBAND_DOWN_HISTORY(filter->tapCount);
+            float* next = st->work[!w] + DRIVE_WORK_HISTORY;
+            memcpy(x - h, st->downHistory[stage][c], h * sizeof(float));
+            halfbandDown(filter, x, n / 2, next);
+            memcpy(st->downHistory[stage][c], x + n - h, h * sizeof(float));
+            w = !w;
+            x = next;
+            n /= 2;
+        }
+
+        for (unsigned s = 0; s < n; s++) {
+            out->s[s][c] = x[s] * INT16_MAX;
+        }
+    }
+
+    loadMeterRecord(&st->stats, cycleCounter() - start, false);
+    if (st->stats.frames >= REPORT_FRAMES &&
+            !atomic_load_explicit(&st->reportReady, memory_order_acquire)) {
+        st->reportStats = st->stats;
+        st->reportParams = *p;
+        loadMeterReset(&st->stats);
+        atomic_store_explicit(&st->reportReady, true, memory_order_release);
+    }
+}
+
+unsigned driveLatency(const DriveParams* p)
+{
+    // Each stage delays by HALFBAND_ROUNDTRIP_DELAY samples at its lower rate
+    const unsigned stages = oversampleStages(p);
+    unsigned tenths = 0;
+    for (unsigned stage = 0; stage < stages; stage++) {
+        tenths += 10 * HALFBAND_ROUNDTRIP_DELAY(halfbandStages[stage].tapCount) >> stage;
+    }
+    if (p->adaa) {
+        tenths += 5 >> stages;
+    }
+    return tenths;
+}
+
+void driveReport(DriveState* st, const char* name)
+{
+    if (!atomic_load_explicit(&st->reportReady, memory_order_acquire)) {
+        return;
+    }
+    const DriveParams* p = &st->reportParams;
+    const unsigned latency = driveLatency(p);
+    printf("%s: %ux oversampling, %s curve%s, latency %u.%u samples\n", name,
+            1u << oversampleStages(p),
+            p->curve <= DRIVE_CURVE_HARD ? curveNames[p->curve] : "mix",
+            p->adaa ? " with ADAA" : "", latency / 10, latency % 10);
+    loadMeterPrint(name, &st->reportStats);
+    atomic_store_explicit(&st->reportReady, false, memory_order_release);
+}
+
+static void nodeInit(void* state)
+{
+    initDrive(state);
+}
+
+static void nodeProcess(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        void* state, const void* params)
+{
+    processDrive(in, out, state, params);
+}
+
+const FxNodeType driveNode = {
+    .name = "drive",
+    .stateSize = sizeof(DriveState),
+    .heat = ARENA_HOT,
+    .init = nodeInit,
+    .process = nodeProcess,
+    .flags = FXNODE_INPLACE
+};
@@ -1,6 +1,11 @@
 #pragma once
 
 #include <math.h>
+#include <stdatomic.h>
+#include "fixedpoint.h"
+#include "fxgraph.h"
+#include "halfband.h"
+#include "loadmeter.h"
 #include "utils.h"
 
 static inline float tubeSaturate(float _x)
@@ -34,3 +39,119 @@ static inline float saturateSoft(float x)
     x = x / b;
     return b * ((1 + a) * x - a * x * x * x);
 }
+
+/**
+ * Fixed point version of saturateSoft(), on a sample value that may be
+ * outside of the 16-bit range.
+ */
+static inline int32_t saturateSoftFixed(int32_t x)
+{
+    // x^3 polynomial with a = 0.2, all in Q15
+    x = ssat16(x);
+    const int32_t x3 = (((x * x) >> 15) * x) >> 15;
+    return ssat16(((x * 39322) >> 15) - ((x3 * 6554) >> 15));
+}
+
+/**
+ * Fixed point version of tubeSaturate(), on a sample value that may be
+ * outside of the 16-bit range.
+ */
+static inline int32_t tubeSaturateFixed(int32_t x)
+{
+    // With depth 0.5, k = 2 and the curve is 3x / (1 + 2|x|), which reaches
+    // full scale at |x| = 1 so larger inputs just clip.
+    const uint32_t ax = x < 0 ? -x : x;
+    if (ax >= Q15_ONE) {
+        return x < 0 ? INT16_MIN : INT16_MAX;
+    }
+    const uint32_t y = (3u * ax * Q15_ONE) / (Q15_ONE + 2 * ax);
+    return x < 0 ? -ssat16(y) : ssat16(y);
+}
+
+/// Curves of the drive stage, all on samples scaled to full scale 1 and
+/// reaching it at an input of 1 or soon after
+enum DriveCurve {
+    DRIVE_CURVE_MIX, ///< Mix of soft and tube by tubeMix
+    DRIVE_CURVE_SOFT, ///< saturateSoft(), a cubic
+    DRIVE_CURVE_TUBE, ///< tubeSaturate(), a rational curve with a harder knee
+    DRIVE_CURVE_TANH,
+    DRIVE_CURVE_HARD, ///< saturateClip()
+};
+
+/// Highest oversampling factor of the drive stage
+#define DRIVE_MAX_OVERSAMPLE (1 << HALFBAND_STAGES)
+
+/// Oversampling and ADAA of the drive stage in the applications, which can be
+/// overridden in CFLAGS. See driveReport() for what they cost.
+#ifndef DRIVE_OVERSAMPLE
+#define DRIVE_OVERSAMPLE 2
+#endif
+#ifndef DRIVE_ADAA
+#define DRIVE_ADAA 1
+#endif
+
+/// Longest history of any half-band filter, kept in front of the work buffers
+#define DRIVE_WORK_HISTORY HALFBAND_DOWN_HISTORY(HALFBAND0_TAPS)
+
+typedef struct {
+    float gainExp; ///< Linear gain before saturation
+    float tubeMix; ///< 0 for soft saturation only, 1 for tube only
+    enum DriveCurve curve;
+    /// Apply the curve with first order antiderivative anti-aliasing, which
+    /// suppresses aliasing further at the cost of half a sample of delay at
+    /// the oversampled rate, and of evaluating the antiderivative
+    bool adaa;
+    /// Oversampling factor, 1, 2, 4 or DRIVE_MAX_OVERSAMPLE, rounded down to
+    /// one of those
+    uint8_t oversample;
+} DriveParams;
+
+typedef struct {
+    bool clip; ///< The last input had samples outside of the 16-bit range
+
+    unsigned stages; ///< Oversampling stages the histories are for
+    float upHistory[HALFBAND_STAGES][2][HALFBAND_UP_HISTORY(HALFBAND0_TAPS)];
+    float downHistory[HALFBAND_STAGES][2][HALFBAND_DOWN_HISTORY(HALFBAND0_TAPS)];
+    float adaaLast[2]; ///< Last input to the curve, for ADAA
+    /// Ping-pong buffers for one channel at each rate, with room in front
+    /// for the filter history
+    float work[2][DRIVE_WORK_HISTORY + DRIVE_MAX_OVERSAMPLE * CODEC_SAMPLES_PER_FRAME];
+
+    /// Time per frame, handed over to driveReport() every few seconds
+    LoadStats stats;
+    LoadStats reportStats;
+    DriveParams reportParams;
+    atomic_bool reportReady;
+} DriveState;
+
+void initDrive(DriveState* state);
+
+/**
+ * Output stage of the applications: gain followed by a saturating curve, run
+ * oversampled by params->oversample. The signal is upsampled in stages of two
+ * with the half-band filters in halfband.h, the curve is applied at the
+ * highest rate, and the filters bring it back down, all over a whole frame of
+ * one channel at a time. Changing the oversampling factor clears the filters.
+ *
+ * The input may be the same buffer as the output.
+ */
+void processDrive(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        DriveState* state, const DriveParams* params);
+
+/**
+ * Delay of the drive stage with the given parameters, in tenths of a sample
+ */
+unsigned driveLatency(const DriveParams* params);
+
+/**
+ * Print the setup and load statistics of the drive stage every few seconds,
+ * for choosing the oversampling factor against the frame budget. Call from
+ * the idle loop.
+ */
+void driveReport(DriveState* state, const char* name);
+
+/**
+ * Final gain and saturation stage running processDrive(). The state is a
+ * DriveState and the params DriveParams.
+ */
+extern const FxNodeType driveNode;
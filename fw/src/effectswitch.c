@@ -0,0 +1,239 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "platform.h"
+#include "effectswitch.h"
+#include "dsp/fixedpoint.h"
+#include "utils.h"
+
+#define NO_EFFECT 0xff
+
+void effectSwitchInit(EffectSwitch* sw, unsigned effect, unsigned fadeFrames)
+{
+    sw->current = effect;
+    sw->previous = effect;
+    sw->fadeFrames = fadeFrames ? fadeFrames : 1;
+    sw->fadePos = sw->fadeFrames;
+    sw->sequential = false;
+    sw->groups = NULL;
+    sw->restart = NULL;
+    loadMeterReset(&sw->fadeStats);
+    atomic_init(&sw->reportReady, false);
+}
+
+static unsigned groupOf(const EffectSwitch* sw, unsigned effect)
+{
+    return sw->groups ? sw->groups[effect] : 0;
+}
+
+/**
+ * Make sure the state of an effect is valid before running it
+ */
+static void claim(EffectSwitch* sw, unsigned effect)
+{
+    const unsigned group = groupOf(sw, effect);
+    if (group && sw->owner[group] != effect) {
+        sw->restart(effect);
+        sw->owner[group] = effect;
+    }
+}
+
+void effectSwitchSetGroups(EffectSwitch* sw, const uint8_t* groups,
+        void (*restart)(unsigned effect))
+{
+    sw->groups = groups;
+    sw->restart = restart;
+    memset(sw->owner, NO_EFFECT, sizeof(sw->owner));
+    claim(sw, sw->current);
+}
+
+/**
+ * Start a crossfade if the selection changed and none is running. Returns
+ * true if the frame is part of a crossfade.
+ */
+static bool startFrame(EffectSwitch* sw, unsigned selected)
+{
+    if (sw->fadePos >= sw->fadeFrames && selected != sw->current) {
+        sw->previous = sw->current;
+        sw->current = selected;
+        sw->fadePos = 0;
+
+        const unsigned group = groupOf(sw, selected);
+        sw->sequential = group && group == groupOf(sw, sw->previous);
+        if (!sw->sequential) {
+            claim(sw, selected);
+        }
+    }
+    return sw->fadePos < sw->fadeFrames;
+}
+
+static void endFrame(EffectSwitch* sw, uint32_t start)
+{
+    loadMeterRecord(&sw->fadeStats, cycleCounter() - start, false);
+    if (++sw->fadePos == sw->fadeFrames &&
+            !atomic_load_explicit(&sw->reportReady, memory_order_acquire)) {
+        sw->reportStats = sw->fadeStats;
+        loadMeterReset(&sw->fadeStats);
+        atomic_store_explicit(&sw->reportReady, true, memory_order_release);
+    }
+}
+
+/**
+ * Equal power gains of the effect fading in at the start and end of this
+ * frame. The effect fading out has the gain of the same curve mirrored.
+ */
+static void fadeGains(const EffectSwitch* sw, float gain[2])
+{
+    for (unsigned i = 0; i < 2; i++) {
+        gain[i] = sinf((float)M_PI/2 * (sw->fadePos + i) / sw->fadeFrames);
+    }
+}
+
+/**
+ * For a sequential switch, pick the effect to run this frame and its gains at
+ * the start and end of the frame. The new effect is set up half way through.
+ */
+static unsigned sequentialFrame(EffectSwitch* sw, float gain[2])
+{
+    const unsigned half = sw->fadeFrames / 2;
+    if (sw->fadePos < half) {
+        for (unsigned i = 0; i < 2; i++) {
+            gain[i] = cosf((float)M_PI/2 * (sw->fadePos + i) / half);
+        }
+        return sw->previous;
+    }
+
+    if (sw->fadePos == half) {
+        claim(sw, sw->current);
+    }
+    for (unsigned i = 0; i < 2; i++) {
+        gain[i] = sinf((float)M_PI/2 * (sw->fadePos - half + i) /
+                (sw->fadeFrames - half));
+    }
+    return sw->current;
+}
+
+static void applyGain(FloatAudioBuffer* buf, const float gain[2])
+{
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        const float g = RAMP((float)s / CODEC_SAMPLES_PER_FRAME, gain[0], gain[1]);
+        buf->s[s][0] *= g;
+        buf->s[s][1] *= g;
+    }
+}
+
+static void applyGainFixed(AudioBuffer* buf, const float gain[2])
+{
+    const int32_t g0 = FLOAT_TO_Q15(gain[0]);
+    const int32_t g1 = FLOAT_TO_Q15(gain[1]);
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        const int32_t g = g0 + (g1 - g0) * (int32_t)s / CODEC_SAMPLES_PER_FRAME;
+        buf->s[s][0] = mulQ15(buf->s[s][0], g);
+        buf->s[s][1] = mulQ15(buf->s[s][1], g);
+    }
+}
+
+void effectSwitchProcess(EffectSwitch* sw, unsigned selected,
+        const FloatAudioBuffer* restrict in, FloatAudioBuffer* restrict out,
+        EffectFunction fn, const void* ctx)
+{
+    const bool fading = startFrame(sw, selected);
+    memset(out, 0, sizeof(*out));
+
+    if (fading && sw->sequential) {
+        // Only one effect runs, the extra cost is setting up the new one
+        const uint32_t start = cycleCounter();
+        float gain[2];
+        const unsigned effect = sequentialFrame(sw, gain);
+        const uint32_t setup = cycleCounter() - start;
+        fn(effect, in, out, ctx);
+        const uint32_t gainStart = cycleCounter();
+        applyGain(out, gain);
+        endFrame(sw, gainStart - setup);
+        return;
+    }
+
+    fn(sw->current, in, out, ctx);
+    if (!fading) {
+        return;
+    }
+
+    const uint32_t start = cycleCounter();
+
+    FloatAudioBuffer old = { .m = { 0 } };
+    fn(sw->previous, in, &old, ctx);
+
+    float inGain[2], outGain[2];
+    fadeGains(sw, inGain);
+    outGain[0] = sqrtf(1.0f - inGain[0] * inGain[0]);
+    outGain[1] = sqrtf(1.0f - inGain[1] * inGain[1]);
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        const float t = (float)s / CODEC_SAMPLES_PER_FRAME;
+        const float gi = RAMP(t, inGain[0], inGain[1]);
+        const float go = RAMP(t, outGain[0], outGain[1]);
+        out->s[s][0] = gi * out->s[s][0] + go * old.s[s][0];
+        out->s[s][1] = gi * out->s[s][1] + go * old.s[s][1];
+    }
+
+    endFrame(sw, start);
+}
+
+void effectSwitchProcessFixed(EffectSwitch* sw, unsigned selected,
+        const AudioBuffer* restrict in, AudioBuffer* restrict out,
+        FixedEffectFunction fn, const void* ctx)
+{
+    const bool fading = startFrame(sw, selected);
+    memset(out, 0, sizeof(*out));
+
+    if (fading && sw->sequential) {
+        // Only one effect runs, the extra cost is setting up the new one
+        const uint32_t start = cycleCounter();
+        float gain[2];
+        const unsigned effect = sequentialFrame(sw, gain);
+        const uint32_t setup = cycleCounter() - start;
+        fn(effect, in, out, ctx);
+        const uint32_t gainStart = cycleCounter();
+        applyGainFixed(out, gain);
+        endFrame(sw, gainStart - setup);
+        return;
+    }
+
+    fn(sw->current, in, out, ctx);
+    if (!fading) {
+        return;
+    }
+
+    const uint32_t start = cycleCounter();
+
+    AudioBuffer old = { .m = { 0 } };
+    fn(sw->previous, in, &old, ctx);
+
+    // Gains in Q15, stepped per sample
+    float inGain[2];
+    fadeGains(sw, inGain);
+    const int32_t gi0 = FLOAT_TO_Q15(inGain[0]);
+    const int32_t gi1 = FLOAT_TO_Q15(inGain[1]);
+    const int32_t go0 = FLOAT_TO_Q15(sqrtf(1.0f - inGain[0] * inGain[0]));
+    const int32_t go1 = FLOAT_TO_Q15(sqrtf(1.0f - inGain[1] * inGain[1]));
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        const int32_t gi = gi0 + (gi1 - gi0) * (int32_t)s / CODEC_SAMPLES_PER_FRAME;
+        const int32_t go = go0 + (go1 - go0) * (int32_t)s / CODEC_SAMPLES_PER_FRAME;
+        const uint32_t gains = pack16(gi, go);
+        for (unsigned ch = 0; ch < 2; ch++) {
+            out->s[s][ch] = ssat16(smlad(pack16(out->s[s][ch], old.s[s][ch]),
+                    gains, 0) >> 15);
+        }
+    }
+
+    endFrame(sw, start);
+}
+
+void effectSwitchReport(EffectSwitch* sw, const char* name)
+{
+    if (!atomic_load_explicit(&sw->reportReady, memory_order_acquire)) {
+        return;
+    }
+    loadMeterPrint(name, &sw->reportStats);
+    atomic_store_explicit(&sw->reportReady, false, memory_order_release);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+/**
+ * Switching between effects without clicks or dropouts. When a new effect is
+ * selected, the old and the new effect both run for a number of frames and
+ * their outputs are mixed with an equal power crossfade, after which the old
+ * effect is retired. A new selection made during a crossfade waits until it
+ * is finished, so at most two effects ever run at the same time.
+ *
+ * Effects whose states share memory in an arena overlay can't run at the same
+ * time. Switching between two of them fades out the old effect over the first
+ * half of the crossfade, then initializes the new one and fades it in. An
+ * effect is also initialized before it runs if another one has used its memory
+ * since last time.
+ *
+ * The time spent on the effect that is fading out, including the mixing, is
+ * the extra cost of a crossfade and is kept in a LoadStats.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "codec.h"
+#include "loadmeter.h"
+
+/// Default crossfade length in frames, about 20 ms
+#define EFFECTSWITCH_FADE_FRAMES \
+        ((CODEC_SAMPLERATE / 50 + CODEC_SAMPLES_PER_FRAME - 1) / CODEC_SAMPLES_PER_FRAME)
+
+/// Number of memory groups, see effectSwitchSetGroups()
+#define EFFECTSWITCH_MAX_GROUPS 4
+
+/**
+ * Run one effect on a frame. The output buffer is cleared before the call.
+ *
+ * @param effect The application's identifier of the effect to run
+ * @param ctx Whatever the application passed to effectSwitchProcess
+ */
+typedef void (*EffectFunction)(unsigned effect,
+        const FloatAudioBuffer* restrict in, FloatAudioBuffer* restrict out,
+        const void* ctx);
+typedef void (*FixedEffectFunction)(unsigned effect,
+        const AudioBuffer* restrict in, AudioBuffer* restrict out,
+        const void* ctx);
+
+typedef struct {
+    unsigned current; ///< Effect that is running, or fading in
+    unsigned previous; ///< Effect that is fading out
+    unsigned fadeFrames;
+    unsigned fadePos; ///< Frames into the crossfade, fadeFrames when done
+    bool sequential; ///< Fading out and then in, instead of crossfading
+    const uint8_t* groups;
+    void (*restart)(unsigned effect);
+    uint8_t owner[EFFECTSWITCH_MAX_GROUPS]; ///< Effect that last used a group
+    LoadStats fadeStats; ///< Extra time taken by frames in crossfades
+    /// Crossfade times, handed over to effectSwitchReport() when a crossfade
+    /// has finished
+    LoadStats reportStats;
+    atomic_bool reportReady;
+} EffectSwitch;
+
+/**
+ * @param effect The effect to start with, without a crossfade
+ * @param fadeFrames Length of each crossfade, at least one frame
+ */
+void effectSwitchInit(EffectSwitch* sw, unsigned effect, unsigned fadeFrames);
+
+/**
+ * Tell which effects share memory. Call after effectSwitchInit(), before
+ * processing starts.
+ *
+ * @param groups For each effect, 0 if its state has memory of its own, or a
+ *        group number below EFFECTSWITCH_MAX_GROUPS shared by the effects in
+ *        the same arena overlay
+ * @param restart Initializes the state of an effect, called in the audio
+ *        processing when the effect's group was last used by another effect
+ */
+void effectSwitchSetGroups(EffectSwitch* sw, const uint8_t* groups,
+        void (*restart)(unsigned effect));
+
+/**
+ * Process one frame with the selected effect, crossfading from the previous
+ * one if the selection changed. Call from the audio processing.
+ */
+void effectSwitchProcess(EffectSwitch* sw, unsigned selected,
+        const FloatAudioBuffer* restrict in, FloatAudioBuffer* restrict out,
+        EffectFunction fn, const void* ctx);
+
+/**
+ * Same as effectSwitchProcess, directly on the codec samples
+ */
+void effectSwitchProcessFixed(EffectSwitch* sw, unsigned selected,
+        const AudioBuffer* restrict in, AudioBuffer* restrict out,
+        FixedEffectFunction fn, const void* ctx);
+
+/**
+ * Print the load statistics of the crossfades since the last report, once
+ * one has finished. Call from the idle loop, before publishing a new
+ * selection.
+ */
+void effectSwitchReport(EffectSwitch* sw, const char* name);
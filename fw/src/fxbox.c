@@ -8,159 +8,337 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
 #include "codec.h"
 #include "dsp/delay.h"
+#include "dsp/gate.h"
+#include "dsp/harmonizer.h"
 #include "dsp/pitcher.h"
+#include "dsp/reverb.h"
 #include "dsp/vibrato.h"
 #include "dsp/wahwah.h"
 #include "dsp/waveshaper.h"
+#include "effectswitch.h"
+#include "fxgraph.h"
 #include "platform.h"
+#include "taptempo.h"
+#include "triplebuffer.h"
 #include "utils.h"
 
+/// Input with a momentary switch to ground for tap tempo, or -1 for none. All
+/// inputs are taken by knobs, so one of them has to make way for it.
+#ifndef FXBOX_TAP_BUTTON
+#define FXBOX_TAP_BUTTON -1
+#endif
+
+/// Fixed reading of the knob that makes way for the tap button, from 0 to
+/// 65535. Half way unless set.
+#ifndef FXBOX_TAP_KNOB_VALUE
+#define FXBOX_TAP_KNOB_VALUE 0x8000
+#endif
+
 enum Effects {
     EFFECT_WAHWAH,
     EFFECT_VIBRATO,
     EFFECT_DELAY,
     EFFECT_PITCHER,
     EFFECT_QUIET,
-    EFFECT_NONE2,
+    EFFECT_HARMONIZER,
+    EFFECT_REVERB,
     EFFECTS_COUNT
 };
 
-static enum Effects currentEffect = EFFECTS_COUNT;
-static WahwahState wahwahState;
-static VibratoState vibratoState;
-static DelayState delayState;
-static PitcherState pitcherState;
+/**
+ * Everything the audio processing needs from the controls, computed in the
+ * idle loop and handed over through a triple buffer.
+ */
+typedef struct {
+    enum Effects effect;
+    GateParams gate;
+    WahwahParams wahwah;
+    VibratoParams vibrato;
+    DelayParams delay;
+    PitcherParams pitcher;
+    HarmonizerParams harmonizer;
+    ReverbParams reverb;
+    DriveParams drive;
+} FxParams;
+
+static FxParams params[3];
+static TripleBuffer paramBuffer;
+static enum Effects selectedEffect = EFFECTS_COUNT;
+static EffectSwitch effectSwitch;
+static TapTempo tapTempo;
+
+static DriveState driveState;
 
+/// Effects on the selector. Those without a node type are feedthrough,
+/// except for EFFECT_QUIET.
+static const FxNode effects[EFFECTS_COUNT] = {
+    [EFFECT_WAHWAH] = { .type = &wahwahNode,
+            .params = offsetof(FxParams, wahwah) },
+    [EFFECT_VIBRATO] = { .type = &vibratoNode,
+            .params = offsetof(FxParams, vibrato) },
+    [EFFECT_DELAY] = { .type = &delayNode,
+            .params = offsetof(FxParams, delay) },
+    [EFFECT_PITCHER] = { .type = &pitcherNode,
+            .params = offsetof(FxParams, pitcher) },
+    [EFFECT_HARMONIZER] = { .type = &harmonizerNode,
+            .params = offsetof(FxParams, harmonizer) },
+    [EFFECT_REVERB] = { .type = &reverbNode,
+            .params = offsetof(FxParams, reverb) },
+};
 
-static void feedthrough(const FloatAudioBuffer* restrict in,
-        FloatAudioBuffer* restrict out)
+/// The delay and pitch shifter states share memory. With the radix4 FFT the
+/// harmonizer leaves room in CCM for the reverb, with kiss_fft the reverb
+/// shares their memory too.
+static const uint8_t effectGroups[EFFECTS_COUNT] = {
+    [EFFECT_DELAY] = 1,
+    [EFFECT_PITCHER] = 1,
+    [EFFECT_REVERB] = !FFT_BACKEND_RADIX4
+};
+
+/// States of the effects, allocated from the arena
+static void* effectStates[EFFECTS_COUNT];
+
+/**
+ * Run one of the effects, called by the effect switch
+ */
+static void runEffect(unsigned effect, const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, const void* ctx)
 {
-    *out = *in;
+    const FxNode* node = &effects[effect];
+    if (node->type && effectStates[effect]) {
+        node->type->process(in, out, effectStates[effect],
+                (const char*)ctx + node->params);
+    }
+    else if (effect != EFFECT_QUIET) {
+        *out = *in;
+    }
 }
 
-static void process(const AudioBuffer* restrict in, AudioBuffer* restrict out)
+/**
+ * Initialize an effect whose memory another effect has used
+ */
+static void restartEffect(unsigned effect)
 {
-    setLed(LED_GREEN, true);
+    if (effectStates[effect]) {
+        effects[effect].type->init(effectStates[effect]);
+    }
+}
 
-    FloatAudioBuffer fin;
-    samplesToFloat(in, &fin);
-    FloatAudioBuffer fout = { .m = { 0 } };
+static void switchProcess(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        void* state, const void* params)
+{
+    const FxParams* p = params;
+    effectSwitchProcess(state, p->effect, in, out, runEffect, p);
+}
 
-    const float knobs[5] = {
-            // Foot pedal: toe around 1800->1.0f, heel around 57000->0.0f
-            CLAMP(RAMP_U16(knob(0), 1.033f, -0.155f), 0.0f, 1.0f),
-            RAMP_U16(knob(1), 1.0f, 0.0f),
-            RAMP_U16(knob(2), 1.0f, 0.0f),
-            RAMP_U16(knob(3), 1.0f, 0.0f),
-            RAMP_U16(knob(4), 1.0f, 0.0f)
-    };
+/// Crossfades to a newly selected effect
+static const FxNodeType switchNode = {
+    .process = switchProcess
+};
 
-    switch (currentEffect) {
-    case EFFECT_QUIET:
-        // Fade out whatever is still in the output buffers
-        for (unsigned s = 0; s < 2 * CODEC_SAMPLES_PER_FRAME; s++) {
-            out->m[s] = out->m[s] >> 1;
-        }
-        break;
+enum Edges {
+    EDGE_GATE = FXGRAPH_INPUT + 1,
+    EDGE_EFFECT,
+    EDGE_OUTPUT
+};
 
-    case EFFECT_WAHWAH: {
-        const WahwahParams params = {
-                .wah = knobs[0],
-                .q = knobs[1]
-        };
-        processWahwah(&fin, &fout, &wahwahState, &params);
-        break;
-    }
-    case EFFECT_VIBRATO: {
-        const VibratoParams params = {
-                .speed = exp2f(RAMP(knobs[1], 0.0001f, 0.005f)) - 1.0f,
-                .depth = knobs[0] * (VIBRATO_MAX_DEPTH-1),
-                .phasediff = knobs[3] * M_PI/4
-        };
-        processVibrato(&fin, &fout, &vibratoState, &params);
-        break;
-    }
-    case EFFECT_DELAY: {
-        const DelayParams params = {
-                .input = knobs[4],
-                .confusion = knobs[1],
-                .feedback = knobs[3],
-                .octaveMix = 0.5f * knobs[1],
-                .length = knobs[0]
-        };
-        processDelay(&fin, &fout, &delayState, &params);
-        break;
-    }
-    case EFFECT_PITCHER: {
-        const PitcherParams params = {
-                .speed = knobs[0],
-                .wet = knobs[1],
-                .phasediff = 0.02f * knobs[3]
-        };
-        processPitcher(&fin, &fout, &pitcherState, &params);
-        break;
-    }
-    default:
-        feedthrough(&fin, &fout);
-    }
+static const FxNode graphNodes[] = {
+    { &gateNode, NULL, offsetof(FxParams, gate), FXGRAPH_INPUT, EDGE_GATE, 0 },
+    { &switchNode, &effectSwitch, 0, EDGE_GATE, EDGE_EFFECT, 0 },
+    { &driveNode, &driveState, offsetof(FxParams, drive),
+            EDGE_EFFECT, EDGE_OUTPUT, 0 },
+};
 
-    if (willClip(&fout)) {
-        setLed(LED_RED, true);
-    }
-    else {
-        setLed(LED_RED, false);
-    }
+static FxGraph graph;
+static FloatAudioBuffer graphSlots[2];
 
-    const float gain = knobs[2];
-    const float gainExp = exp2f(6*gain);
-    const float tubeMix = CLAMP(2*gain, 0.0f, 1.0f);
-    for (unsigned s = 0; s < 2 * CODEC_SAMPLES_PER_FRAME; s++) {
-        fout.m[s] *= gainExp;
-        fout.m[s] = RAMP(tubeMix, saturateSoft(fout.m[s]), tubeSaturate(fout.m[s]));
-    }
+static void process(const AudioBuffer* restrict in, AudioBuffer* restrict out)
+{
+    setLed(LED_GREEN, true);
 
-    floatToSamples(&fout, out);
+    const FxParams* p = &params[tripleBufferReadSlot(&paramBuffer)];
+    fxGraphProcess(&graph, in, out, p, 0);
+    setLed(LED_RED, driveState.clip);
 
     setLed(LED_GREEN, false);
 }
 
+/**
+ * Reading of a knob, or the fixed one if its input is the tap button
+ */
+static uint16_t controlKnob(unsigned n)
+{
+    if ((int)n == FXBOX_TAP_BUTTON) {
+        return FXBOX_TAP_KNOB_VALUE;
+    }
+    return knob(n);
+}
+
+/**
+ * Compute the parameters for all effects from the controls and hand them over
+ * to the audio processing.
+ */
 static void idleCallback()
 {
+    HarmonizerState* harmonizer = effectStates[EFFECT_HARMONIZER];
+    if (harmonizer) {
+        harmonizerWork(harmonizer);
+        harmonizerReport(harmonizer, "harmonizer");
+    }
+    effectSwitchReport(&effectSwitch, "crossfade");
+    driveReport(&driveState, "drive");
+#if FXBOX_TAP_BUTTON >= 0
+    if (tapTempoUpdate(&tapTempo, !button(FXBOX_TAP_BUTTON), sampleCounter())) {
+        tapTempoReport(&tapTempo, "tempo");
+    }
+#endif
+
     // Switch the active effect if the selector knob has been turned, with some
     // hysteresis.
-    const uint16_t fxSelector = knob(5);
+    const uint16_t fxSelector = controlKnob(5);
     for (enum Effects fx = 0; fx < EFFECTS_COUNT; fx++) {
         if (fxSelector >= fx * (UINT16_MAX/EFFECTS_COUNT) &&
                 fxSelector <= (fx + 1) * (UINT16_MAX/EFFECTS_COUNT)) {
-            if (currentEffect != fx) {
-                // Switch effects via silence, trying to avoid a pop. While
-                // we're looping here the audio processing will continue in
-                // interrupt context.
-                currentEffect = EFFECT_QUIET;
-                for (unsigned i = 0; i < 100000; i++) __asm__("nop");
-                currentEffect = fx;
-            }
+            selectedEffect = fx;
             break;
         }
     }
+
+    const float knobs[5] = {
+            // Foot pedal: toe around 1800->1.0f, heel around 57000->0.0f
+            CLAMP(RAMP_U16(controlKnob(0), 1.033f, -0.155f), 0.0f, 1.0f),
+            RAMP_U16(controlKnob(1), 1.0f, 0.0f),
+            RAMP_U16(controlKnob(2), 1.0f, 0.0f),
+            RAMP_U16(controlKnob(3), 1.0f, 0.0f),
+            RAMP_U16(controlKnob(4), 1.0f, 0.0f)
+    };
+
+    // With a tempo tapped, the delay length and vibrato speed knobs pick note
+    // values, and the delay wobbles once a bar
+    const bool synced = tapTempo.period > 0;
+    const float delayLength = synced ? tapTempoLength(&tapTempo,
+            tapTempoSubdivision(knobs[0]), DELAY_MAX_LENGTH) / DELAY_MAX_LENGTH :
+            knobs[0];
+
+    const float gain = knobs[2];
+    params[tripleBufferWriteSlot(&paramBuffer)] = (FxParams) {
+        .effect = selectedEffect,
+        // Turns down the hum and hiss between notes, more so the more the
+        // drive brings them up
+        .gate = {
+                .threshold = 0.003f * gain,
+                .hysteresis = 0.5f,
+                .ratio = 3.0f,
+                .range = 0.05f,
+                .attack = 0.001f,
+                .hold = 0.05f,
+                .release = 0.1f,
+                .lookahead = GATE_MAX_LOOKAHEAD,
+                .detector = GATE_RMS
+        },
+        .wahwah = {
+                .wah = knobs[0],
+                .q = knobs[1],
+                // Auto-wah on top of the pedal
+                .sweep = knobs[3],
+                .lfo = { .shape = LFO_ENVELOPE, .attack = 0.005f,
+                        .release = 0.2f }
+        },
+        .vibrato = {
+                .speed = synced ?
+                        tapTempoSpeed(&tapTempo, tapTempoSubdivision(knobs[1])) :
+                        exp2f(RAMP(knobs[1], 0.0001f, 0.005f)) - 1.0f,
+                .depth = knobs[0] * (VIBRATO_MAX_DEPTH-1),
+                .phasediff = knobs[3] * M_PI/4
+        },
+        .delay = {
+                .input = knobs[4],
+                .confusion = knobs[1],
+                .feedback = knobs[3],
+                .octaveMix = 0.5f * knobs[1],
+                .length = delayLength,
+                .wobble = 0.002f,
+                .lfo = { .shape = LFO_SINE, .speed = synced ?
+                        tapTempoSpeed(&tapTempo, 4) : HZ2OMEGA(0.3f) },
+                .fade = synced
+        },
+        .pitcher = {
+                .speed = knobs[0],
+                .wet = knobs[1],
+                .phasediff = 0.02f * knobs[3]
+        },
+        .harmonizer = {
+                // In semitones, from an octave down to an octave up
+                .ratio = exp2f(roundf(RAMP(knobs[0], -12.0f, 12.0f)) / 12),
+                .mix = knobs[1]
+        },
+        .reverb = {
+                // From a third of a second to 8 seconds, and the pedal
+                // swells it in
+                .decay = exp2f(RAMP(knobs[3], -1.5f, 3.0f)),
+                .damping = knobs[1],
+                .mix = knobs[0]
+        },
+        .drive = {
+                .gainExp = exp2f(6*gain),
+                .tubeMix = CLAMP(2*gain, 0.0f, 1.0f),
+                .adaa = DRIVE_ADAA,
+                .oversample = DRIVE_OVERSAMPLE
+        }
+    };
+    tripleBufferPublish(&paramBuffer);
 }
 
 int main()
 {
+#if FXBOX_TAP_BUTTON >= 0
+    KnobConfig knobConfig[KNOB_COUNT];
+    for (unsigned n = 0; n < KNOB_COUNT; n++) {
+        knobConfig[n] = (KnobConfig) { .analog = true };
+    }
+    knobConfig[FXBOX_TAP_BUTTON] = (KnobConfig) { .pullup = true };
+    platformInit(knobConfig);
+#else
     platformInit(NULL);
+#endif
 
     printf("Starting fxbox\n");
 
+    for (unsigned fx = 0; fx < EFFECTS_COUNT; fx++) {
+        if (effects[fx].type && !effectGroups[fx]) {
+            effectStates[fx] = fxNodeAlloc(effects[fx].type);
+        }
+    }
+    arenaOverlayBegin(ARENA_COLD);
+    effectStates[EFFECT_DELAY] = fxNodeAlloc(&delayNode);
+    arenaOverlayNext();
+    effectStates[EFFECT_PITCHER] = fxNodeAlloc(&pitcherNode);
+#if !FFT_BACKEND_RADIX4
+    arenaOverlayNext();
+    effectStates[EFFECT_REVERB] = fxNodeAlloc(&reverbNode);
+#endif
+    arenaOverlayEnd();
+
+    if (!fxGraphInit(&graph, graphNodes, sizeof(graphNodes)/sizeof(*graphNodes),
+            EDGE_OUTPUT, graphSlots, sizeof(graphSlots)/sizeof(*graphSlots))) {
+        printf("Invalid effect graph, needs %u slots\n", graph.slotsNeeded);
+    }
+
+    // Have a set of parameters ready before the first frame
+    tapTempoInit(&tapTempo);
+    tripleBufferInit(&paramBuffer);
+    idleCallback();
+    effectSwitchInit(&effectSwitch, selectedEffect, EFFECTSWITCH_FADE_FRAMES);
+    effectSwitchSetGroups(&effectSwitch, effectGroups, restartEffect);
+
+    arenaPrintMap();
+
     platformRegisterIdleCallback(idleCallback);
     codecRegisterProcessFunction(process);
 
-    initDelay(&delayState);
-    initVibrato(&vibratoState);
-    initWahwah(&wahwahState);
-    initPitcher(&pitcherState);
-
     platformMainloop();
 
     return 0;
@@ -7,25 +7,103 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
 #include "codec.h"
 #include "dsp/biquad.h"
 #include "dsp/delay.h"
+#include "dsp/gate.h"
 #include "dsp/vibrato.h"
 #include "dsp/waveshaper.h"
+#include "fxgraph.h"
 #include "platform.h"
+#include "triplebuffer.h"
 #include "utils.h"
 
-static VibratoState vibratoState;
-static FloatBiquadState bqstate;
-static DelayState delayState;
+/**
+ * Everything the audio processing needs from the controls, computed in the
+ * idle loop and handed over through a triple buffer.
+ */
+typedef struct {
+    uint8_t switches;
+    GateParams gate;
+    VibratoParams vibrato;
+    FloatBiquadCoeffs bandpass;
+    DelayParams delay;
+    DriveParams drive;
+} Fxbox2Params;
+
+static Fxbox2Params params[3];
+static TripleBuffer paramBuffer;
+
+static FloatBiquadCascade bandpass;
+static DriveState driveState;
+
+static void differenceProcess(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        void* state, const void* params)
+{
+    (void)state;
+    (void)params;
+
+    // Output the difference between channels
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        float a = in->s[s][0];
+        float b = in->s[s][1];
+        out->s[s][0] = a - b;
+        out->s[s][1] = b - a;
+    }
+}
+
+static const FxNodeType differenceNode = {
+    .process = differenceProcess,
+    .flags = FXNODE_INPLACE
+};
+
+enum Edges {
+    EDGE_GATE = FXGRAPH_INPUT + 1,
+    EDGE_VIBRATO,
+    EDGE_BANDPASS,
+    EDGE_DELAY,
+    EDGE_DIFFERENCE,
+    EDGE_OUTPUT
+};
+
+/// The effects in series after the gate, each turned on by one of the
+/// switches. The graph allocates the gate, vibrato and delay states.
+static const FxNode graphNodes[] = {
+    { &gateNode, NULL, offsetof(Fxbox2Params, gate),
+            FXGRAPH_INPUT, EDGE_GATE, 0 },
+    { &vibratoNode, NULL, offsetof(Fxbox2Params, vibrato),
+            EDGE_GATE, EDGE_VIBRATO, 0x01 },
+    { &bqCascadeNode, &bandpass, offsetof(Fxbox2Params, bandpass),
+            EDGE_VIBRATO, EDGE_BANDPASS, 0x02 },
+    { &delayNode, NULL, offsetof(Fxbox2Params, delay),
+            EDGE_BANDPASS, EDGE_DELAY, 0x04 },
+    { &differenceNode, NULL, 0, EDGE_DELAY, EDGE_DIFFERENCE, 0x08 },
+    { &driveNode, &driveState, offsetof(Fxbox2Params, drive),
+            EDGE_DIFFERENCE, EDGE_OUTPUT, 0 },
+};
+
+static FxGraph graph;
+static FloatAudioBuffer graphSlots[5];
 
 static void process(const AudioBuffer* restrict in, AudioBuffer* restrict out)
 {
     setLed(LED_GREEN, true);
 
-    FloatAudioBuffer b1, b2, b3;
-    samplesToFloat(in, &b1);
-    FloatAudioBuffer* outBuf = &b1;
+    const Fxbox2Params* p = &params[tripleBufferReadSlot(&paramBuffer)];
+    fxGraphProcess(&graph, in, out, p, p->switches);
+    setLed(LED_RED, driveState.clip);
+
+    setLed(LED_GREEN, false);
+}
+
+/**
+ * Compute the parameters for all effects from the controls and hand them over
+ * to the audio processing.
+ */
+static void idleCallback()
+{
+    driveReport(&driveState, "drive");
 
     const float knobs[6] = {
             RAMP_U16(knob(0), 0.0f, 16.15f),
@@ -36,60 +114,45 @@ static void process(const AudioBuffer* restrict in, AudioBuffer* restrict out)
             RAMP_U16(knob(5), 0.0f, 1.0f)
     };
 
-    uint8_t switches = ~(unsigned)roundf(knobs[0]) & 0x0f;
-
-    const VibratoParams vParams = {
+    Fxbox2Params* p = &params[tripleBufferWriteSlot(&paramBuffer)];
+    p->switches = ~(unsigned)roundf(knobs[0]) & 0x0f;
+    p->vibrato = (VibratoParams) {
             .speed = exp2f(RAMP(knobs[1], 0.0001f, 0.005f)) - 1.0f,
             .depth = knobs[2] * (VIBRATO_MAX_DEPTH-1),
             .phasediff = knobs[3] * M_PI/4
     };
-    processVibrato(&b1, &b2, &vibratoState, &vParams);
-    outBuf = (switches & 0x01) ? &b2 : &b1;
-
-    FloatBiquadCoeffs coeffs;
-    bqMakeBandpass(&coeffs, RAMP(knobs[4], HZ2OMEGA(20), HZ2OMEGA(800)),
+    bqMakeBandpass(&p->bandpass, RAMP(knobs[4], HZ2OMEGA(20), HZ2OMEGA(800)),
             exp2f(RAMP(knobs[1], 0.0f, 5.0f)));
-    bqProcess(outBuf, &b3, &coeffs, &bqstate);
-    outBuf = (switches & 0x02) ? &b3 : outBuf;
-
-    const DelayParams dParams = {
+    p->delay = (DelayParams) {
             .input = knobs[1],
             .confusion = 0.3,
             .feedback = knobs[2],
             .octaveMix = 0.5f * knobs[4],
-            .length = knobs[3]
+            .length = knobs[3],
+            .wobble = 0.002f,
+            .lfo = { .shape = LFO_SINE, .speed = HZ2OMEGA(0.3f) }
     };
-    FloatAudioBuffer b4 = { .m = { } };
-    processDelay(outBuf, &b4, &delayState, &dParams);
-    outBuf = (switches & 0x04) ? &b4 : outBuf;
-
-    if (switches &0x08) {
-        // Output the difference between channels
-        for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
-            float a = outBuf->s[s][0];
-            float b = outBuf->s[s][1];
-            outBuf->s[s][0] = a - b;
-            outBuf->s[s][1] = b - a;
-        }
-    }
-
-    setLed(LED_RED, willClip(outBuf));
-
     const float gain = knobs[5];
-    const float gainExp = exp2f(6*gain);
-    const float tubeMix = CLAMP(2*gain, 0.0f, 1.0f);
-    for (unsigned s = 0; s < 2 * CODEC_SAMPLES_PER_FRAME; s++) {
-        outBuf->m[s] *= gainExp;
-        outBuf->m[s] = RAMP(tubeMix, saturateSoft(outBuf->m[s]), tubeSaturate(outBuf->m[s]));
-    }
-
-    floatToSamples(outBuf, out);
-
-    setLed(LED_GREEN, false);
-}
-
-static void idleCallback()
-{
+    // Turns down the hum and hiss between notes, more so the more the drive
+    // brings them up
+    p->gate = (GateParams) {
+            .threshold = 0.003f * gain,
+            .hysteresis = 0.5f,
+            .ratio = 3.0f,
+            .range = 0.05f,
+            .attack = 0.001f,
+            .hold = 0.05f,
+            .release = 0.1f,
+            .lookahead = GATE_MAX_LOOKAHEAD,
+            .detector = GATE_RMS
+    };
+    p->drive = (DriveParams) {
+            .gainExp = exp2f(6*gain),
+            .tubeMix = CLAMP(2*gain, 0.0f, 1.0f),
+            .adaa = DRIVE_ADAA,
+            .oversample = DRIVE_OVERSAMPLE
+    };
+    tripleBufferPublish(&paramBuffer);
 }
 
 int main()
@@ -100,12 +163,20 @@ int main()
 
     printf("Starting fxbox 2\n");
 
+    bqCascadeInit(&bandpass, 1);
+    if (!fxGraphInit(&graph, graphNodes, sizeof(graphNodes)/sizeof(*graphNodes),
+            EDGE_OUTPUT, graphSlots, sizeof(graphSlots)/sizeof(*graphSlots))) {
+        printf("Invalid effect graph, needs %u slots\n", graph.slotsNeeded);
+    }
+    arenaPrintMap();
+
+    // Have a set of parameters ready before the first frame
+    tripleBufferInit(&paramBuffer);
+    idleCallback();
+
     platformRegisterIdleCallback(idleCallback);
     codecRegisterProcessFunction(process);
 
-    initVibrato(&vibratoState);
-    initDelay(&delayState);
-
     platformMainloop();
 
     return 0;
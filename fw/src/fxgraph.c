@@ -0,0 +1,191 @@
+#include <string.h>
+
+#include "fxgraph.h"
+#include "utils.h"
+
+#define NO_SLOT 0xff
+
+/**
+ * Order the nodes so that every node comes after the one producing its input.
+ * Returns false if that's impossible, or an edge is produced more than once.
+ */
+static bool sortNodes(FxGraph* graph)
+{
+    bool produced[FXGRAPH_MAX_EDGES] = { [FXGRAPH_INPUT] = true };
+    bool placed[FXGRAPH_MAX_NODES] = { false };
+
+    for (unsigned pos = 0; pos < graph->nodeCount; pos++) {
+        unsigned n = 0;
+        while (n < graph->nodeCount &&
+                (placed[n] || !produced[graph->nodes[n].in])) {
+            n++;
+        }
+        if (n == graph->nodeCount) {
+            return false;
+        }
+        const uint8_t out = graph->nodes[n].out;
+        if (produced[out]) {
+            return false;
+        }
+        produced[out] = true;
+        placed[n] = true;
+        graph->order[pos] = n;
+    }
+    return produced[graph->output];
+}
+
+/**
+ * Give each edge a slot, reusing slots of edges that are no longer read.
+ * Returns the number of slots needed.
+ */
+static unsigned assignSlots(FxGraph* graph)
+{
+    const int never = -1;
+    const int forever = graph->nodeCount;
+
+    // Position of the last node reading each edge
+    int lastUse[FXGRAPH_MAX_EDGES];
+    for (unsigned e = 0; e < FXGRAPH_MAX_EDGES; e++) {
+        lastUse[e] = never;
+    }
+    for (unsigned pos = 0; pos < graph->nodeCount; pos++) {
+        const FxNode* node = &graph->nodes[graph->order[pos]];
+        lastUse[node->in] = pos;
+        if (lastUse[node->out] < (int)pos) {
+            // Written but possibly never read, still needs a slot here
+            lastUse[node->out] = pos;
+        }
+    }
+    lastUse[graph->output] = forever;
+
+    // A disabled node passes on its input buffer, which then has to live as
+    // long as the node's output would have
+    for (int pos = graph->nodeCount - 1; pos >= 0; pos--) {
+        const FxNode* node = &graph->nodes[graph->order[pos]];
+        if (node->enableMask && lastUse[node->out] > lastUse[node->in]) {
+            lastUse[node->in] = lastUse[node->out];
+        }
+    }
+
+    // Last position each slot is in use
+    int busyUntil[FXGRAPH_MAX_EDGES];
+    for (unsigned s = 0; s < FXGRAPH_MAX_EDGES; s++) {
+        busyUntil[s] = never;
+    }
+    memset(graph->edgeSlot, NO_SLOT, sizeof(graph->edgeSlot));
+    unsigned slots = 1;
+    graph->edgeSlot[FXGRAPH_INPUT] = 0;
+    busyUntil[0] = lastUse[FXGRAPH_INPUT];
+
+    for (unsigned pos = 0; pos < graph->nodeCount; pos++) {
+        const FxNode* node = &graph->nodes[graph->order[pos]];
+        const uint8_t inSlot = graph->edgeSlot[node->in];
+        unsigned slot;
+        if ((node->type->flags & FXNODE_INPLACE) && lastUse[node->in] == (int)pos) {
+            slot = inSlot;
+        }
+        else {
+            slot = 0;
+            while (busyUntil[slot] >= (int)pos) {
+                slot++;
+            }
+        }
+        graph->edgeSlot[node->out] = slot;
+        busyUntil[slot] = lastUse[node->out];
+        if (slot >= slots) {
+            slots = slot + 1;
+        }
+    }
+    return slots;
+}
+
+bool fxGraphInit(FxGraph* graph, const FxNode* nodes, unsigned nodeCount,
+        uint8_t output, FloatAudioBuffer* slots, unsigned slotCount)
+{
+    graph->nodes = nodes;
+    graph->nodeCount = nodeCount;
+    graph->output = output;
+    graph->slots = slots;
+    graph->slotsNeeded = 0;
+    graph->valid = false;
+
+    if (nodeCount > FXGRAPH_MAX_NODES || output >= FXGRAPH_MAX_EDGES) {
+        return false;
+    }
+    for (unsigned n = 0; n < nodeCount; n++) {
+        if (nodes[n].in >= FXGRAPH_MAX_EDGES || nodes[n].out >= FXGRAPH_MAX_EDGES ||
+                nodes[n].out == FXGRAPH_INPUT) {
+            return false;
+        }
+    }
+    if (!sortNodes(graph)) {
+        return false;
+    }
+
+    graph->slotsNeeded = assignSlots(graph);
+    if (graph->slotsNeeded > slotCount) {
+        return false;
+    }
+
+    for (unsigned n = 0; n < nodeCount; n++) {
+        if (nodes[n].state) {
+            graph->states[n] = nodes[n].state;
+            if (nodes[n].type->init) {
+                nodes[n].type->init(nodes[n].state);
+            }
+        }
+        else if (nodes[n].type->stateSize) {
+            graph->states[n] = fxNodeAlloc(nodes[n].type);
+            if (!graph->states[n]) {
+                return false;
+            }
+        }
+        else {
+            graph->states[n] = NULL;
+        }
+    }
+    graph->valid = true;
+    return true;
+}
+
+void* fxNodeAlloc(const FxNodeType* type)
+{
+    void* state = arenaAlloc(type->stateSize, type->heat, type->name);
+    if (state && type->init) {
+        type->init(state);
+    }
+    return state;
+}
+
+void fxGraphProcess(FxGraph* graph, const AudioBuffer* restrict in,
+        AudioBuffer* restrict out, const void* params, uint32_t enabled)
+{
+    if (!graph->valid) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+
+    // Buffer holding each edge this frame, which differs from the edge's own
+    // slot after disabled nodes
+    FloatAudioBuffer* edges[FXGRAPH_MAX_EDGES];
+    edges[FXGRAPH_INPUT] = &graph->slots[graph->edgeSlot[FXGRAPH_INPUT]];
+    samplesToFloat(in, edges[FXGRAPH_INPUT]);
+
+    for (unsigned pos = 0; pos < graph->nodeCount; pos++) {
+        const FxNode* node = &graph->nodes[graph->order[pos]];
+        if (node->enableMask && !(enabled & node->enableMask)) {
+            edges[node->out] = edges[node->in];
+            continue;
+        }
+        FloatAudioBuffer* buf = &graph->slots[graph->edgeSlot[node->out]];
+        if (buf != edges[node->in]) {
+            memset(buf, 0, sizeof(*buf));
+        }
+        node->type->process(edges[node->in], buf,
+                graph->states[graph->order[pos]],
+                (const char*)params + node->params);
+        edges[node->out] = buf;
+    }
+
+    floatToSamples(edges[graph->output], out);
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+/**
+ * Static effect graph. An application describes its signal chain as an array
+ * of nodes, each running one effect from one edge to another, and the graph
+ * takes care of converting to and from float, of ordering the nodes and of
+ * the buffers in between.
+ *
+ * Edges are numbered by the application, with FXGRAPH_INPUT being the codec
+ * input. Every other edge must be the output of exactly one node, while any
+ * number of nodes may read an edge. At init the nodes are sorted so that each
+ * runs after the node producing its input, and each edge gets a buffer slot
+ * from an array provided by the application. Slots are reused once nothing
+ * reads them any more, and nodes with FXNODE_INPLACE write straight over their
+ * input when they are its last reader.
+ *
+ * A node with an enableMask only runs when one of its bits is set in the
+ * enabled argument of fxGraphProcess. Otherwise its output is its input.
+ *
+ * Nodes without a state pointer get their state from the arena, as big and as
+ * hot as their type says.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "codec.h"
+
+#define FXGRAPH_MAX_NODES 16
+#define FXGRAPH_MAX_EDGES 16
+
+/// Edge carrying the codec input
+#define FXGRAPH_INPUT 0
+
+/// The process function works with in and out being the same buffer
+#define FXNODE_INPLACE 0x01
+
+/**
+ * A kind of node, usually wrapping the init and process functions of one of
+ * the DSP blocks.
+ */
+typedef struct {
+    const char* name;
+    size_t stateSize;
+    enum ArenaHeat heat;
+    /// Called by fxGraphInit for the node's state, or NULL
+    void (*init)(void* state);
+    /// Process one frame. out is cleared first unless it's the same as in.
+    void (*process)(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+            void* state, const void* params);
+    uint8_t flags;
+} FxNodeType;
+
+typedef struct {
+    const FxNodeType* type;
+    void* state; ///< State owned by the application, or NULL to allocate it
+    /// Offset of the node's parameters in the block passed to fxGraphProcess
+    size_t params;
+    uint8_t in;
+    uint8_t out;
+    /// Bits in the enabled argument of fxGraphProcess that turn the node on,
+    /// or 0 to always run it
+    uint32_t enableMask;
+} FxNode;
+
+typedef struct {
+    const FxNode* nodes;
+    unsigned nodeCount;
+    uint8_t output; ///< Edge that goes to the codec
+    uint8_t order[FXGRAPH_MAX_NODES]; ///< Nodes in processing order
+    uint8_t edgeSlot[FXGRAPH_MAX_EDGES];
+    void* states[FXGRAPH_MAX_NODES];
+    FloatAudioBuffer* slots;
+    unsigned slotsNeeded;
+    bool valid;
+} FxGraph;
+
+/**
+ * Sort the nodes, assign slots to the edges and initialize the states of all
+ * nodes. The nodes and slots must stay around for as long as the graph is
+ * used.
+ *
+ * @param output The edge to send to the codec
+ * @param slots Buffers for the edges. After the call, slotsNeeded in the
+ *        graph tells how many it takes.
+ * @return False if the graph has a cycle, an edge without exactly one producer,
+ *         needs more slots than provided or the arena is out of memory. The
+ *         graph then outputs silence.
+ */
+bool fxGraphInit(FxGraph* graph, const FxNode* nodes, unsigned nodeCount,
+        uint8_t output, FloatAudioBuffer* slots, unsigned slotCount);
+
+/**
+ * Run all nodes on one frame.
+ *
+ * @param params Parameter block that the nodes' params offsets refer to
+ * @param enabled Bits for turning on nodes with an enableMask
+ */
+void fxGraphProcess(FxGraph* graph, const AudioBuffer* restrict in,
+        AudioBuffer* restrict out, const void* params, uint32_t enabled);
+
+/**
+ * Allocate a state for a node type from the arena and initialize it, for
+ * applications running nodes themselves.
+ *
+ * @return NULL if the arena is out of memory
+ */
+void* fxNodeAlloc(const FxNodeType* type);
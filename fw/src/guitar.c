@@ -8,13 +8,47 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
 #include "codec.h"
+#include "dsp/cabinet.h"
 #include "dsp/delay.h"
+#include "dsp/gate.h"
+#include "dsp/reverb.h"
 #include "dsp/vibrato.h"
 #include "dsp/waveshaper.h"
+#include "effectswitch.h"
+#include "fxgraph.h"
 #include "platform.h"
+#include "taptempo.h"
+#include "triplebuffer.h"
 #include "utils.h"
 
+/// Set to 1 to run the effect chain in fixed point, directly on the codec
+/// samples, e.g. with make CFLAGS=-DGUITAR_FIXED_POINT=1
+#ifndef GUITAR_FIXED_POINT
+#define GUITAR_FIXED_POINT 0
+#endif
+
+/// Input with a momentary switch to ground for tap tempo, or -1 for none. The
+/// board has no spare input, so one of the knobs or effect buttons has to make
+/// way for it.
+#ifndef GUITAR_TAP_BUTTON
+#define GUITAR_TAP_BUTTON -1
+#endif
+
+/// Fixed reading of the knob that makes way for the tap button, from 0 to
+/// 65535. Half way unless set, for a gain knob e.g. a moderate drive. An
+/// effect button that makes way reads as released.
+#ifndef GUITAR_TAP_KNOB_VALUE
+#define GUITAR_TAP_KNOB_VALUE 0x8000
+#endif
+
+/// Set to 0 to leave out the room reverb at the end of the chain. The board
+/// has no knob to spare for it, so its settings are fixed.
+#ifndef GUITAR_REVERB
+#define GUITAR_REVERB 1
+#endif
+
 enum Effects {
     EFFECT_NONE,
     EFFECT_VIBRATO,
@@ -23,99 +57,291 @@ enum Effects {
     EFFECTS_COUNT
 };
 
-static enum Effects currentEffect = EFFECT_DELAY;
-static VibratoState vibratoState;
-static DelayState delayState;
+/**
+ * Everything the audio processing needs from the controls, computed in the
+ * idle loop and handed over through a triple buffer.
+ */
+typedef struct {
+    enum Effects effect;
+    GateParams gate;
+    VibratoParams vibrato;
+    DelayParams delay;
+    ReverbParams reverb;
+#if GUITAR_FIXED_POINT
+    int32_t gainExp; ///< Q8.8
+    int32_t tubeMix; ///< Q15
+#else
+    DriveParams drive;
+#endif
+} GuitarParams;
 
+static GuitarParams params[3];
+static TripleBuffer paramBuffer;
+static EffectSwitch effectSwitch;
+static TapTempo tapTempo;
 
-static void feedthrough(const FloatAudioBuffer* restrict in,
-        FloatAudioBuffer* restrict out)
-{
-    *out = *in;
-}
+/// States of the effects, allocated from the arena
+static void* effectStates[EFFECTS_COUNT];
 
-static void process(const AudioBuffer* restrict in, AudioBuffer* restrict out)
-{
-    setLed(LED_GREEN, true);
+#if GUITAR_FIXED_POINT
+static GateState* gateState;
+#if GUITAR_REVERB
+static ReverbState* reverbState;
+#endif
+#endif
 
-    FloatAudioBuffer fin;
-    samplesToFloat(in, &fin);
-    FloatAudioBuffer fout = { .m = { 0 } };
+#if GUITAR_FIXED_POINT
 
-    const float knobs[4] = {
-            RAMP_U16(knob(0), 0.0f, 1.0f),
-            RAMP_U16(knob(1), 0.0f, 1.0f),
-            RAMP_U16(knob(2), 0.0f, 1.0f),
-            RAMP_U16(knob(3), 0.0f, 1.0f),
-    };
+/**
+ * Run one of the effects, called by the effect switch
+ */
+static void runEffect(unsigned effect, const AudioBuffer* restrict in,
+        AudioBuffer* restrict out, const void* ctx)
+{
+    const GuitarParams* p = ctx;
 
-    switch (currentEffect) {
+    switch (effect) {
     case EFFECT_QUIET:
-        // Fade out whatever is still in the output buffers
-        for (unsigned s = 0; s < 2 * CODEC_SAMPLES_PER_FRAME; s++) {
-            out->m[s] = out->m[s] >> 1;
-        }
+        // Output stays cleared
         break;
-    case EFFECT_VIBRATO: {
-        const VibratoParams params = {
-                .speed = exp2f(RAMP(knobs[1], 0.0001f, 0.005f)) - 1.0f,
-                .depth = knobs[0] * (VIBRATO_MAX_DEPTH-1),
-                .phasediff = knobs[2] * M_PI/4
-        };
-        processVibrato(&fin, &fout, &vibratoState, &params);
+    case EFFECT_VIBRATO:
+        processVibratoFixed(in, out, effectStates[effect], &p->vibrato);
         break;
-    }
-    case EFFECT_DELAY: {
-        const DelayParams params = {
-                .input = knobs[1],
-                .confusion = knobs[0],
-                .feedback = knobs[1],
-                .octaveMix = 0.5f * knobs[0],
-                .length = knobs[2]
-        };
-        processDelay(&fin, &fout, &delayState, &params);
+    case EFFECT_DELAY:
+        processDelayFixed(in, out, effectStates[effect], &p->delay);
         break;
-    }
     default:
-        feedthrough(&fin, &fout);
+        *out = *in;
     }
+}
 
-    if (willClip(&fout)) {
-        setLed(LED_RED, true);
+static void process(const AudioBuffer* restrict in, AudioBuffer* restrict out)
+{
+    setLed(LED_GREEN, true);
+
+    const GuitarParams* p = &params[tripleBufferReadSlot(&paramBuffer)];
+
+    AudioBuffer gated;
+    if (gateState) {
+        processGateFixed(in, &gated, gateState, &p->gate);
     }
     else {
-        setLed(LED_RED, false);
+        gated = *in;
     }
 
-    const float gain = knobs[3];
-    const float gainExp = exp2f(6*gain);
-    const float tubeMix = CLAMP(2*gain, 0.0f, 1.0f);
+    // Crossfades to a newly selected effect
+    AudioBuffer fxout;
+    effectSwitchProcessFixed(&effectSwitch, p->effect, &gated, &fxout, runEffect, p);
+
+    AudioBuffer driven;
+    bool clip = false;
     for (unsigned s = 0; s < 2 * CODEC_SAMPLES_PER_FRAME; s++) {
-        fout.m[s] *= gainExp;
-        fout.m[s] = RAMP(tubeMix, saturateSoft(fout.m[s]), tubeSaturate(fout.m[s]));
+        const int32_t v = (fxout.m[s] * p->gainExp) >> 8;
+        clip |= v != ssat16(v);
+        const int32_t soft = saturateSoftFixed(v);
+        driven.m[s] = soft + (((tubeSaturateFixed(v) - soft) * p->tubeMix) >> 15);
     }
+    setLed(LED_RED, clip);
 
-    floatToSamples(&fout, out);
+#if GUITAR_REVERB
+    if (reverbState) {
+        processReverbFixed(&driven, out, reverbState, &p->reverb);
+    }
+    else
+#endif
+    {
+        *out = driven;
+    }
 
     setLed(LED_GREEN, false);
 }
 
+#else
+
+static DriveState driveState;
+
+/// Effects on the switch. Those without a node type are feedthrough, except
+/// for EFFECT_QUIET.
+static const FxNode effects[EFFECTS_COUNT] = {
+    [EFFECT_VIBRATO] = { .type = &vibratoNode,
+            .params = offsetof(GuitarParams, vibrato) },
+    [EFFECT_DELAY] = { .type = &delayNode,
+            .params = offsetof(GuitarParams, delay) },
+};
+
+/**
+ * Run one of the effects, called by the effect switch
+ */
+static void runEffect(unsigned effect, const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, const void* ctx)
+{
+    const FxNode* node = &effects[effect];
+    if (node->type && effectStates[effect]) {
+        node->type->process(in, out, effectStates[effect],
+                (const char*)ctx + node->params);
+    }
+    else if (effect != EFFECT_QUIET) {
+        *out = *in;
+    }
+}
+
+static void switchProcess(const FloatAudioBuffer* in, FloatAudioBuffer* out,
+        void* state, const void* params)
+{
+    const GuitarParams* p = params;
+    effectSwitchProcess(state, p->effect, in, out, runEffect, p);
+}
+
+/// Crossfades to a newly selected effect
+static const FxNodeType switchNode = {
+    .process = switchProcess
+};
+
+enum Edges {
+    EDGE_GATE = FXGRAPH_INPUT + 1,
+    EDGE_EFFECT,
+    EDGE_DRIVE,
+    EDGE_CABINET,
+    EDGE_OUTPUT = GUITAR_REVERB ? EDGE_CABINET + 1 : EDGE_CABINET
+};
+
+static const FxNode graphNodes[] = {
+    { &gateNode, NULL, offsetof(GuitarParams, gate),
+            FXGRAPH_INPUT, EDGE_GATE, 0 },
+    { &switchNode, &effectSwitch, 0, EDGE_GATE, EDGE_EFFECT, 0 },
+    { &driveNode, &driveState, offsetof(GuitarParams, drive),
+            EDGE_EFFECT, EDGE_DRIVE, 0 },
+    { &cabinetNode, NULL, 0, EDGE_DRIVE, EDGE_CABINET, 0 },
+#if GUITAR_REVERB
+    { &reverbNode, NULL, offsetof(GuitarParams, reverb),
+            EDGE_CABINET, EDGE_OUTPUT, 0 },
+#endif
+};
+
+static FxGraph graph;
+static FloatAudioBuffer graphSlots[2];
+
+static void process(const AudioBuffer* restrict in, AudioBuffer* restrict out)
+{
+    setLed(LED_GREEN, true);
+
+    const GuitarParams* p = &params[tripleBufferReadSlot(&paramBuffer)];
+    fxGraphProcess(&graph, in, out, p, 0);
+    setLed(LED_RED, driveState.clip);
+
+    setLed(LED_GREEN, false);
+}
+
+#endif
+
+/**
+ * Reading of a knob, or the fixed one if its input is the tap button
+ */
+static uint16_t controlKnob(unsigned n)
+{
+    if ((int)n == GUITAR_TAP_BUTTON) {
+        return GUITAR_TAP_KNOB_VALUE;
+    }
+    return knob(n);
+}
+
+/**
+ * State of an effect button, released if its input is the tap button
+ */
+static bool controlButton(unsigned n)
+{
+    return (int)n != GUITAR_TAP_BUTTON && button(n);
+}
+
+/**
+ * Compute the parameters for all effects from the controls and hand them over
+ * to the audio processing.
+ */
 static void idleCallback()
 {
-    enum Effects selected = button(4) + (button(5) << 1);
-    if (currentEffect != selected) {
-        // Switch effects via silence, trying to avoid a pop. While
-        // we're looping here the audio processing will continue in
-        // interrupt context.
-        currentEffect = EFFECT_QUIET;
-        for (unsigned i = 0; i < 100000; i++) __asm__("nop");
-        currentEffect = selected;
+    effectSwitchReport(&effectSwitch, "crossfade");
+#if !GUITAR_FIXED_POINT
+    driveReport(&driveState, "drive");
+#endif
+
+#if GUITAR_TAP_BUTTON >= 0
+    if (tapTempoUpdate(&tapTempo, !button(GUITAR_TAP_BUTTON), sampleCounter())) {
+        tapTempoReport(&tapTempo, "tempo");
     }
+#endif
+
+    const float knobs[4] = {
+            RAMP_U16(controlKnob(0), 0.0f, 1.0f),
+            RAMP_U16(controlKnob(1), 0.0f, 1.0f),
+            RAMP_U16(controlKnob(2), 0.0f, 1.0f),
+            RAMP_U16(controlKnob(3), 0.0f, 1.0f),
+    };
+
+    // With a tempo tapped, the delay length and vibrato speed knobs pick note
+    // values, and the delay wobbles once a bar
+    const bool synced = tapTempo.period > 0;
+    const float delayLength = synced ? tapTempoLength(&tapTempo,
+            tapTempoSubdivision(knobs[2]), DELAY_MAX_LENGTH) / DELAY_MAX_LENGTH :
+            knobs[2];
+
+    const float gain = knobs[3];
+    params[tripleBufferWriteSlot(&paramBuffer)] = (GuitarParams) {
+        .effect = controlButton(4) + (controlButton(5) << 1),
+        // Turns down the hum and hiss between notes, more so the more the
+        // drive brings them up
+        .gate = {
+                .threshold = 0.003f * gain,
+                .hysteresis = 0.5f,
+                .ratio = 3.0f,
+                .range = 0.05f,
+                .attack = 0.001f,
+                .hold = 0.05f,
+                .release = 0.1f,
+                .lookahead = GATE_MAX_LOOKAHEAD,
+                .detector = GATE_RMS
+        },
+        .vibrato = {
+                .speed = synced ?
+                        tapTempoSpeed(&tapTempo, tapTempoSubdivision(knobs[1])) :
+                        exp2f(RAMP(knobs[1], 0.0001f, 0.005f)) - 1.0f,
+                .depth = knobs[0] * (VIBRATO_MAX_DEPTH-1),
+                .phasediff = knobs[2] * M_PI/4
+        },
+        .delay = {
+                .input = knobs[1],
+                .confusion = knobs[0],
+                .feedback = knobs[1],
+                .octaveMix = 0.5f * knobs[0],
+                .length = delayLength,
+                .wobble = 0.002f,
+                .lfo = { .shape = LFO_SINE, .speed = synced ?
+                        tapTempoSpeed(&tapTempo, 4) : HZ2OMEGA(0.3f) },
+                .fade = synced
+        },
+        // A small room
+        .reverb = {
+                .decay = 1.2f,
+                .damping = 0.5f,
+                .mix = 0.3f
+        },
+#if GUITAR_FIXED_POINT
+        .gainExp = exp2f(6*gain) * 256,
+        .tubeMix = FLOAT_TO_Q15(CLAMP(2*gain, 0.0f, 1.0f))
+#else
+        .drive = {
+                .gainExp = exp2f(6*gain),
+                .tubeMix = CLAMP(2*gain, 0.0f, 1.0f),
+                .adaa = DRIVE_ADAA,
+                .oversample = DRIVE_OVERSAMPLE
+        }
+#endif
+    };
+    tripleBufferPublish(&paramBuffer);
 }
 
 int main()
 {
-    const KnobConfig knobConfig[KNOB_COUNT] = {
+    KnobConfig knobConfig[KNOB_COUNT] = {
             { .analog = true },
             { .analog = true },
             { .analog = true },
@@ -123,6 +349,9 @@ int main()
             { .pullup = true },
             { .pullup = true },
     };
+#if GUITAR_TAP_BUTTON >= 0
+    knobConfig[GUITAR_TAP_BUTTON] = (KnobConfig) { .pullup = true };
+#endif
 
     platformInit(knobConfig);
     codedSetInVolume(5);
@@ -130,12 +359,49 @@ int main()
 
     printf("Starting guitar board\n");
 
+#if GUITAR_FIXED_POINT
+    gateState = fxNodeAlloc(&gateNode);
+    FixedVibratoState* vibrato = arenaAlloc(sizeof(FixedVibratoState),
+            ARENA_HOT, "vibrato");
+    if (vibrato) {
+        initVibratoFixed(vibrato);
+    }
+    effectStates[EFFECT_VIBRATO] = vibrato;
+    DelayState* delay = arenaAlloc(sizeof(DelayState), ARENA_COLD, "delay");
+    if (delay) {
+        initDelay(delay);
+    }
+    effectStates[EFFECT_DELAY] = delay;
+#if GUITAR_REVERB
+    reverbState = arenaAlloc(sizeof(ReverbState), ARENA_HOT, "reverb");
+    if (reverbState) {
+        initReverb(reverbState);
+    }
+#endif
+#else
+    for (unsigned fx = 0; fx < EFFECTS_COUNT; fx++) {
+        if (effects[fx].type) {
+            effectStates[fx] = fxNodeAlloc(effects[fx].type);
+        }
+    }
+    if (!fxGraphInit(&graph, graphNodes, sizeof(graphNodes)/sizeof(*graphNodes),
+            EDGE_OUTPUT, graphSlots, sizeof(graphSlots)/sizeof(*graphSlots))) {
+        printf("Invalid effect graph, needs %u slots\n", graph.slotsNeeded);
+    }
+#endif
+
+    // Have a set of parameters ready before the first frame
+    tapTempoInit(&tapTempo);
+    tripleBufferInit(&paramBuffer);
+    idleCallback();
+    effectSwitchInit(&effectSwitch, params[tripleBufferReadSlot(&paramBuffer)].effect,
+            EFFECTSWITCH_FADE_FRAMES);
+
+    arenaPrintMap();
+
     platformRegisterIdleCallback(idleCallback);
     codecRegisterProcessFunction(process);
 
-    initDelay(&delayState);
-    initVibrato(&vibratoState);
-
     platformMainloop();
 
     return 0;
@@ -0,0 +1,14 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <time.h>
+
+#include "platform.h"
+
+uint32_t cycleCounter(void)
+{
+    // Nanoseconds, wrapping every 4.3 seconds just like the Cortex-M4 cycle
+    // counter wraps every 25 seconds.
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint32_t)t.tv_sec * 1000000000u + (uint32_t)t.tv_nsec;
+}
@@ -1,15 +1,19 @@
 #define _POSIX_C_SOURCE 199309L
 
 #include <jack/jack.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include <unistd.h>
 #include <signal.h>
 #include <time.h>
 
 #include "codec.h"
 #include "jackclient.h"
+#include "loadmeter.h"
+#include "platform.h"
 
 static jack_client_t* client;
 static bool die;
@@ -19,6 +23,10 @@ static jack_port_t* il;
 static jack_port_t* ir;
 static CodecProcess appProcess;
 static void(*idleCallback)(void);
+static atomic_uint samplecounter;
+/// Buffer size Jack changed to that isn't a whole number of frames, reported
+/// by the idle loop
+static atomic_uint badBufferSize;
 
 static int process(jack_nframes_t nframes, void* arg)
 {
@@ -33,6 +41,15 @@ static int process(jack_nframes_t nframes, void* arg)
     const float scale = 0x8000;
     const float invscale = 1.0/0x8000;
 
+    // The buffer size may change while running. Returning an error would
+    // make Jack drop the client for good, so output silence instead.
+    if (nframes % CODEC_SAMPLES_PER_FRAME) {
+        memset(olBuf, 0, nframes * sizeof(*olBuf));
+        memset(orBuf, 0, nframes * sizeof(*orBuf));
+        badBufferSize = nframes;
+        return 0;
+    }
+
     for (size_t subframe = 0; subframe < nframes; subframe += CODEC_SAMPLES_PER_FRAME) {
         AudioBuffer in = {};
         AudioBuffer out = {};
@@ -42,12 +59,16 @@ static int process(jack_nframes_t nframes, void* arg)
             in.s[sample][1] = irBuf[subframe + sample] * scale;
         }
 
+        const uint32_t start = cycleCounter();
         appProcess(&in, &out);
+        const uint32_t cycles = cycleCounter() - start;
+        loadMeterRecord(&codecLoadStats, cycles, cycles > LOADMETER_FRAME_BUDGET);
 
         for (size_t sample = 0; sample < CODEC_SAMPLES_PER_FRAME; sample++) {
             olBuf[subframe + sample] = out.s[sample][0] * invscale;
             orBuf[subframe + sample] = out.s[sample][1] * invscale;
         }
+        samplecounter += CODEC_SAMPLES_PER_FRAME;
     }
 
     return 0;
@@ -74,6 +95,11 @@ void codecRegisterProcessFunction(CodecProcess fn)
     appProcess = fn;
 }
 
+unsigned jackClientSampleCounter(void)
+{
+    return samplecounter;
+}
+
 void jackClientSetIdleCallback(void(*cb)(void))
 {
     idleCallback = cb;
@@ -103,6 +129,16 @@ void jackClientInit()
         exit(1);
     }
 
+    if (jack_get_sample_rate(client) != CODEC_SAMPLERATE) {
+        fprintf(stderr, "Warning: Jack runs at %u Hz, but we are built for %u Hz\n",
+                (unsigned)jack_get_sample_rate(client), CODEC_SAMPLERATE);
+    }
+    if (jack_get_buffer_size(client) % CODEC_SAMPLES_PER_FRAME) {
+        fprintf(stderr, "Jack buffer size %u is not a multiple of the frame size %u\n",
+                (unsigned)jack_get_buffer_size(client), CODEC_SAMPLES_PER_FRAME);
+        exit(1);
+    }
+
     jack_set_process_callback(client, process, NULL);
 }
 
@@ -124,7 +160,14 @@ void jackClientRun()
     signal(SIGINT, sigterm);
     signal(SIGTERM, sigterm);
 
+    bool reportedBufferSize = false;
     while (!die) {
+        const unsigned bad = badBufferSize;
+        if (bad && !reportedBufferSize) {
+            fprintf(stderr, "Jack buffer size %u is not a multiple of the frame "
+                    "size %u, output is muted\n", bad, CODEC_SAMPLES_PER_FRAME);
+            reportedBufferSize = true;
+        }
         if (idleCallback) {
             idleCallback();
         }
@@ -133,4 +176,6 @@ void jackClientRun()
         nanosleep(&t, NULL);
     }
     jack_client_close(client);
+
+    loadMeterPrint("process", &codecLoadStats);
 }
@@ -3,3 +3,4 @@
 void jackClientInit(void);
 void jackClientRun(void);
 void jackClientSetIdleCallback(void(*cb)(void));
+unsigned jackClientSampleCounter(void);
@@ -0,0 +1,449 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "codec.h"
+#include "loadmeter.h"
+#include "platform.h"
+#include "offline.h"
+
+#define WAVE_FORMAT_PCM 1
+#define WAVE_FORMAT_IEEE_FLOAT 3
+
+struct Event {
+    double time;
+    bool isKnob;
+    uint8_t n;
+    uint16_t value;
+    double ramp;
+};
+
+struct Ramp {
+    float from;
+    float to;
+    unsigned start;
+    unsigned length;
+};
+
+static CodecProcess appProcess;
+static void(*idleCallback)(void);
+
+static FILE* input;
+static unsigned inputChannels = 2;
+static unsigned inputFormat = WAVE_FORMAT_PCM;
+static FILE* output;
+static bool outputIsWav;
+static unsigned renderSamples;
+static unsigned tailSamples;
+
+static struct Event* events;
+static size_t eventCount;
+
+static unsigned samplecounter;
+static uint16_t knobValues[KNOB_COUNT];
+static struct Ramp knobRamps[KNOB_COUNT];
+static bool buttonValues[KNOB_COUNT];
+
+static bool hasSuffix(const char* s, const char* suffix)
+{
+    const size_t len = strlen(s);
+    const size_t suffixLen = strlen(suffix);
+    if (len < suffixLen) {
+        return false;
+    }
+    for (size_t i = 0; i < suffixLen; i++) {
+        char c = s[len - suffixLen + i];
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        if (c != suffix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static double envDouble(const char* name, double fallback)
+{
+    const char* s = getenv(name);
+    return s ? atof(s) : fallback;
+}
+
+static uint32_t readLE(const uint8_t* p, unsigned bytes)
+{
+    uint32_t v = 0;
+    for (unsigned i = 0; i < bytes; i++) {
+        v |= (uint32_t)p[i] << (8 * i);
+    }
+    return v;
+}
+
+static void writeLE(uint8_t* p, uint32_t v, unsigned bytes)
+{
+    for (unsigned i = 0; i < bytes; i++) {
+        p[i] = v >> (8 * i);
+    }
+}
+
+/**
+ * Parse the RIFF header of a WAV file and leave the file positioned at the
+ * first sample of the data chunk.
+ */
+static void openWav(const char* name)
+{
+    uint8_t riff[12];
+    if (fread(riff, sizeof(riff), 1, input) != 1 ||
+            memcmp(riff, "RIFF", 4) || memcmp(riff + 8, "WAVE", 4)) {
+        fprintf(stderr, "%s: not a WAV file\n", name);
+        exit(1);
+    }
+
+    bool haveFormat = false;
+    while (true) {
+        uint8_t chunk[8];
+        if (fread(chunk, sizeof(chunk), 1, input) != 1) {
+            fprintf(stderr, "%s: no data chunk\n", name);
+            exit(1);
+        }
+        const uint32_t size = readLE(chunk + 4, 4);
+
+        if (!memcmp(chunk, "fmt ", 4)) {
+            uint8_t fmt[16];
+            if (size < sizeof(fmt) || fread(fmt, sizeof(fmt), 1, input) != 1) {
+                fprintf(stderr, "%s: bad format chunk\n", name);
+                exit(1);
+            }
+            inputFormat = readLE(fmt, 2);
+            inputChannels = readLE(fmt + 2, 2);
+            const unsigned rate = readLE(fmt + 4, 4);
+            const unsigned bits = readLE(fmt + 14, 2);
+
+            if (!((inputFormat == WAVE_FORMAT_PCM && bits == 16) ||
+                    (inputFormat == WAVE_FORMAT_IEEE_FLOAT && bits == 32)) ||
+                    inputChannels < 1 || inputChannels > 2) {
+                fprintf(stderr, "%s: only 16-bit PCM and 32-bit float, mono "
+                        "or stereo, is supported\n", name);
+                exit(1);
+            }
+            if (rate != CODEC_SAMPLERATE) {
+                fprintf(stderr, "%s: warning, sample rate is %u Hz, processing "
+                        "as %u Hz\n", name, rate, CODEC_SAMPLERATE);
+            }
+            fseek(input, size - sizeof(fmt) + (size & 1), SEEK_CUR);
+            haveFormat = true;
+        }
+        else if (!memcmp(chunk, "data", 4)) {
+            if (!haveFormat) {
+                fprintf(stderr, "%s: data before format chunk\n", name);
+                exit(1);
+            }
+            return;
+        }
+        else {
+            fseek(input, size + (size & 1), SEEK_CUR);
+        }
+    }
+}
+
+/**
+ * Write a WAV header. Called with placeholder sizes when the file is opened
+ * and again with the real sizes when rendering is done.
+ */
+static void writeWavHeader(uint32_t dataBytes)
+{
+    uint8_t h[44];
+    memcpy(h, "RIFF", 4);
+    writeLE(h + 4, 36 + dataBytes, 4);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    writeLE(h + 16, 16, 4);
+    writeLE(h + 20, WAVE_FORMAT_PCM, 2);
+    writeLE(h + 22, 2, 2);
+    writeLE(h + 24, CODEC_SAMPLERATE, 4);
+    writeLE(h + 28, CODEC_SAMPLERATE * 2 * sizeof(CodecIntSample), 4);
+    writeLE(h + 32, 2 * sizeof(CodecIntSample), 2);
+    writeLE(h + 34, 16, 2);
+    memcpy(h + 36, "data", 4);
+    writeLE(h + 40, dataBytes, 4);
+
+    fseek(output, 0, SEEK_SET);
+    fwrite(h, sizeof(h), 1, output);
+}
+
+static int compareEvents(const void* a, const void* b)
+{
+    const struct Event* ea = a;
+    const struct Event* eb = b;
+    return (ea->time > eb->time) - (ea->time < eb->time);
+}
+
+static void loadAutomation(const char* name)
+{
+    FILE* f = fopen(name, "r");
+    if (!f) {
+        perror(name);
+        exit(1);
+    }
+
+    size_t capacity = 0;
+    char line[256];
+    for (unsigned lineno = 1; fgets(line, sizeof(line), f); lineno++) {
+        char* s = line;
+        while (*s == ' ' || *s == '\t') s++;
+        if (*s == '#' || *s == '\n' || *s == '\r' || *s == '\0') {
+            continue;
+        }
+
+        double time;
+        char kind[16];
+        unsigned n;
+        char value[16];
+        double ramp = 0;
+        const int fields = sscanf(s, "%lf %15s %u %15s %lf", &time, kind, &n,
+                value, &ramp);
+        const bool isKnob = !strcmp(kind, "knob");
+        if (fields < 4 || (!isKnob && strcmp(kind, "button")) ||
+                n >= KNOB_COUNT || time < 0 || ramp < 0) {
+            fprintf(stderr, "%s:%u: bad automation event\n", name, lineno);
+            exit(1);
+        }
+
+        if (eventCount == capacity) {
+            capacity = capacity ? 2 * capacity : 64;
+            events = realloc(events, capacity * sizeof(*events));
+            if (!events) {
+                fprintf(stderr, "Out of memory\n");
+                exit(1);
+            }
+        }
+        events[eventCount++] = (struct Event) {
+            .time = time,
+            .isKnob = isKnob,
+            .n = n,
+            .value = strtoul(value, NULL, 0),
+            .ramp = ramp
+        };
+    }
+    fclose(f);
+
+    // Stable order is not needed; events at the same time on the same
+    // control are ambiguous anyway.
+    qsort(events, eventCount, sizeof(*events), compareEvents);
+}
+
+/**
+ * Apply all automation events that are due at the start of the current frame
+ * and move any knobs that are ramping.
+ */
+static void automate(void)
+{
+    static size_t nextEvent;
+    while (nextEvent < eventCount &&
+            events[nextEvent].time * CODEC_SAMPLERATE <= samplecounter) {
+        const struct Event* e = &events[nextEvent++];
+        if (!e->isKnob) {
+            buttonValues[e->n] = e->value;
+        }
+        else if (e->ramp > 0) {
+            knobRamps[e->n] = (struct Ramp) {
+                .from = knobValues[e->n],
+                .to = e->value,
+                .start = samplecounter,
+                .length = e->ramp * CODEC_SAMPLERATE
+            };
+        }
+        else {
+            knobRamps[e->n].length = 0;
+            knobValues[e->n] = e->value;
+        }
+    }
+
+    for (unsigned n = 0; n < KNOB_COUNT; n++) {
+        struct Ramp* r = &knobRamps[n];
+        if (r->length) {
+            const unsigned elapsed = samplecounter - r->start;
+            if (elapsed >= r->length) {
+                knobValues[n] = r->to;
+                r->length = 0;
+            }
+            else {
+                const float t = (float)elapsed / r->length;
+                knobValues[n] = r->from + t * (r->to - r->from);
+            }
+        }
+    }
+}
+
+/**
+ * Read one frame of input. Returns false at the end of the input.
+ */
+static bool readFrame(AudioBuffer* in)
+{
+    if (!input) {
+        return samplecounter < renderSamples;
+    }
+
+    if (inputFormat == WAVE_FORMAT_IEEE_FLOAT) {
+        float buf[2 * CODEC_SAMPLES_PER_FRAME] = { 0 };
+        const size_t n = fread(buf, inputChannels * sizeof(float),
+                CODEC_SAMPLES_PER_FRAME, input);
+        for (size_t s = 0; s < n; s++) {
+            for (unsigned c = 0; c < 2; c++) {
+                float v = buf[s * inputChannels + (c % inputChannels)] * 0x8000;
+                v = v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : v);
+                in->s[s][c] = v;
+            }
+        }
+        return n > 0;
+    }
+
+    CodecIntSample buf[2 * CODEC_SAMPLES_PER_FRAME] = { 0 };
+    const size_t n = fread(buf, inputChannels * sizeof(CodecIntSample),
+            CODEC_SAMPLES_PER_FRAME, input);
+    for (size_t s = 0; s < n; s++) {
+        in->s[s][0] = buf[s * inputChannels];
+        in->s[s][1] = buf[s * inputChannels + (inputChannels - 1)];
+    }
+    return n > 0;
+}
+
+void codedSetInVolume(int vol)
+{
+    (void)vol;
+}
+
+void codedSetOutVolume(int voldB)
+{
+    (void)voldB;
+}
+
+void codecRegisterProcessFunction(CodecProcess fn)
+{
+    appProcess = fn;
+}
+
+void offlineSetIdleCallback(void(*cb)(void))
+{
+    idleCallback = cb;
+}
+
+uint16_t offlineKnob(uint8_t n)
+{
+    return knobValues[n];
+}
+
+bool offlineButton(uint8_t n)
+{
+    return buttonValues[n];
+}
+
+unsigned offlineSampleCounter(void)
+{
+    return samplecounter;
+}
+
+void offlineInit(void)
+{
+    const char* inName = getenv("OFFLINE_INPUT");
+    const char* outName = getenv("OFFLINE_OUTPUT");
+    const char* automationName = getenv("OFFLINE_AUTOMATION");
+
+    if (inName) {
+        input = fopen(inName, "rb");
+        if (!input) {
+            perror(inName);
+            exit(1);
+        }
+        if (hasSuffix(inName, ".wav")) {
+            openWav(inName);
+        }
+    }
+    else {
+        renderSamples = envDouble("OFFLINE_SECONDS", 10) * CODEC_SAMPLERATE;
+    }
+    tailSamples = envDouble("OFFLINE_TAIL", 0) * CODEC_SAMPLERATE;
+
+    if (outName) {
+        output = fopen(outName, "wb");
+        if (!output) {
+            perror(outName);
+            exit(1);
+        }
+        outputIsWav = hasSuffix(outName, ".wav");
+        if (outputIsWav) {
+            writeWavHeader(0);
+        }
+    }
+
+    if (automationName) {
+        loadAutomation(automationName);
+    }
+}
+
+void offlineRun(void)
+{
+    if (!appProcess) {
+        fprintf(stderr, "No process function registered\n");
+        exit(1);
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    unsigned tailLeft = tailSamples;
+    size_t outFrames = 0;
+    while (true) {
+        AudioBuffer in = {};
+        AudioBuffer out = {};
+
+        if (!readFrame(&in)) {
+            if (tailLeft == 0) {
+                break;
+            }
+            tailLeft = tailLeft > CODEC_SAMPLES_PER_FRAME ?
+                    tailLeft - CODEC_SAMPLES_PER_FRAME : 0;
+        }
+
+        automate();
+        const uint32_t start = cycleCounter();
+        appProcess(&in, &out);
+        const uint32_t cycles = cycleCounter() - start;
+        loadMeterRecord(&codecLoadStats, cycles, cycles > LOADMETER_FRAME_BUDGET);
+        samplecounter += CODEC_SAMPLES_PER_FRAME;
+
+        if (output) {
+            outFrames += fwrite(out.s, sizeof(out.s[0]),
+                    CODEC_SAMPLES_PER_FRAME, output);
+        }
+
+        // Run the idle loop once per frame, the same order of magnitude as
+        // on target and in the Jack client.
+        if (idleCallback) {
+            idleCallback();
+        }
+    }
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    const double elapsed = (end.tv_sec - start.tv_sec) +
+            (end.tv_nsec - start.tv_nsec) / 1e9;
+    const double audio = (double)samplecounter / CODEC_SAMPLERATE;
+
+    fprintf(stderr, "Rendered %.2f s of audio in %.3f s, %.1fx real time\n",
+            audio, elapsed, elapsed > 0 ? audio / elapsed : 0);
+    loadMeterPrint("process", &codecLoadStats);
+
+    if (input) {
+        fclose(input);
+    }
+    if (output) {
+        if (outputIsWav) {
+            writeWavHeader(outFrames * sizeof(((AudioBuffer*)0)->s[0]));
+        }
+        fclose(output);
+    }
+    free(events);
+}
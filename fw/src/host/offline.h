@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Offline host backend. Instead of streaming audio through Jack, audio is
+ * read from a file, run through the registered CodecProcess function as fast
+ * as the CPU allows and written to another file.
+ *
+ * It is configured through environment variables, since the applications
+ * don't take any command line arguments:
+ *
+ *  OFFLINE_INPUT      Input file, a 16-bit PCM or 32-bit float WAV file, or
+ *                     raw interleaved 16-bit stereo samples. Silence is used
+ *                     if not set.
+ *  OFFLINE_OUTPUT     Output file. Written as a 16-bit stereo WAV file if the
+ *                     name ends with .wav, raw interleaved samples otherwise.
+ *                     No output is written if not set.
+ *  OFFLINE_AUTOMATION Script with knob and button automation, see below.
+ *  OFFLINE_SECONDS    Length to render if no input file is given (default 10).
+ *  OFFLINE_TAIL       Seconds of silence to render after the end of the input
+ *                     file, to let delays ring out (default 0).
+ *
+ * The automation script has one event per line, blank lines and lines
+ * starting with # are ignored:
+ *
+ *   <time> knob <n> <value> [<ramp>]
+ *   <time> button <n> <0|1>
+ *
+ * Times are in seconds from the start of rendering. Knob values are 16-bit
+ * unsigned, like the ones returned by knob() on target, in decimal or 0x hex.
+ * If a ramp time in seconds is given the knob moves linearly from its previous
+ * value to the new one over that time.
+ */
+
+void offlineInit(void);
+void offlineRun(void);
+void offlineSetIdleCallback(void(*cb)(void));
+
+uint16_t offlineKnob(uint8_t n);
+bool offlineButton(uint8_t n);
+unsigned offlineSampleCounter(void);
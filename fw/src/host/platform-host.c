@@ -28,3 +28,8 @@ bool button(uint8_t n)
     (void)n;
     return false;
 }
+
+unsigned sampleCounter(void)
+{
+    return jackClientSampleCounter();
+}
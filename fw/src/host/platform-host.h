@@ -3,6 +3,14 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+/// cycleCounter() counts nanoseconds on host
+#define CYCLES_PER_SECOND 1000000000
+
+/// Host has no core coupled memory, it's all the same
+#define CCM_DATA
+
+uint32_t cycleCounter(void);
+
 static inline void setLed(enum Led led, bool state)
 {
     (void)led;
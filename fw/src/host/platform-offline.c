@@ -0,0 +1,33 @@
+#include "platform.h"
+#include "offline.h"
+
+void platformInit(const KnobConfig* knobConfig)
+{
+    (void)knobConfig;
+    offlineInit();
+}
+
+void platformRegisterIdleCallback(void(*cb)(void))
+{
+    offlineSetIdleCallback(cb);
+}
+
+void platformMainloop(void)
+{
+    offlineRun();
+}
+
+uint16_t knob(uint8_t n)
+{
+    return offlineKnob(n);
+}
+
+bool button(uint8_t n)
+{
+    return offlineButton(n);
+}
+
+unsigned sampleCounter(void)
+{
+    return offlineSampleCounter();
+}
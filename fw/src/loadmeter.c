@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "platform.h"
+#include "loadmeter.h"
+
+LoadStats codecLoadStats = { .minCycles = UINT32_MAX };
+
+void loadMeterReset(LoadStats* stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->minCycles = UINT32_MAX;
+}
+
+void loadMeterRecord(LoadStats* stats, uint32_t cycles, bool overrun)
+{
+    stats->frames++;
+    stats->overruns += overrun;
+    stats->totalCycles += cycles;
+    if (cycles < stats->minCycles) {
+        stats->minCycles = cycles;
+    }
+    if (cycles > stats->maxCycles) {
+        stats->maxCycles = cycles;
+    }
+
+    // Bucket by the number of significant bits
+    const int bits = cycles ? 32 - __builtin_clz(cycles) : 0;
+    int bucket = bits - LOADMETER_MIN_BITS;
+    if (bucket < 0) {
+        bucket = 0;
+    }
+    else if (bucket >= LOADMETER_BUCKETS) {
+        bucket = LOADMETER_BUCKETS - 1;
+    }
+    stats->histogram[bucket]++;
+}
+
+/// Cycles in tenths of a percent of the frame budget, so we can print it
+/// without floating point printf support.
+static unsigned permille(uint64_t cycles)
+{
+    return (cycles * 1000 + LOADMETER_FRAME_BUDGET / 2) / LOADMETER_FRAME_BUDGET;
+}
+
+void loadMeterPrint(const char* name, const LoadStats* stats)
+{
+    if (!stats->frames) {
+        printf("%s: no frames\n", name);
+        return;
+    }
+
+    const uint32_t avg = stats->totalCycles / stats->frames;
+    printf("%s: %u frames, min %u avg %u max %u cycles, "
+            "avg %u.%u%% max %u.%u%% of budget, %u overruns\n",
+            name, (unsigned)stats->frames, (unsigned)stats->minCycles,
+            (unsigned)avg, (unsigned)stats->maxCycles,
+            permille(avg) / 10, permille(avg) % 10,
+            permille(stats->maxCycles) / 10, permille(stats->maxCycles) % 10,
+            (unsigned)stats->overruns);
+
+    printf("%s: histogram from 2^%u cycles:", name, LOADMETER_MIN_BITS);
+    for (unsigned b = 0; b < LOADMETER_BUCKETS; b++) {
+        printf(" %u", (unsigned)stats->histogram[b]);
+    }
+    printf("\n");
+}
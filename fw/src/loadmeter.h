@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "codec.h"
+
+/// Histogram bucket n counts frames taking 2^(n+LOADMETER_MIN_BITS-1) to
+/// 2^(n+LOADMETER_MIN_BITS) cycles. The first and last buckets also count
+/// everything below and above that.
+#define LOADMETER_BUCKETS 16
+#define LOADMETER_MIN_BITS 8
+
+/**
+ * Processing time statistics. Time is measured in cycles of cycleCounter(),
+ * which counts CPU cycles on target and nanoseconds on host, so compare
+ * platforms by the share of the frame budget rather than by raw numbers.
+ */
+typedef struct {
+    uint32_t frames;
+    uint32_t overruns; ///< Frames where processing missed its deadline
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t histogram[LOADMETER_BUCKETS];
+} LoadStats;
+
+/// Cycles available to process one frame in real time
+#define LOADMETER_FRAME_BUDGET ((uint32_t)((uint64_t)CYCLES_PER_SECOND * \
+        CODEC_SAMPLES_PER_FRAME / CODEC_SAMPLERATE))
+
+/**
+ * Statistics for the application's process function, updated by the codec
+ * driver of each platform for every frame.
+ */
+extern LoadStats codecLoadStats;
+
+void loadMeterReset(LoadStats* stats);
+
+/**
+ * Add the processing time of one frame to the statistics.
+ *
+ * @param cycles Time taken to process the frame
+ * @param overrun True if the deadline for the frame was missed
+ */
+void loadMeterRecord(LoadStats* stats, uint32_t cycles, bool overrun);
+
+/**
+ * Print a one line summary of the statistics and a line with the histogram,
+ * with times in percent of the frame budget.
+ */
+void loadMeterPrint(const char* name, const LoadStats* stats);
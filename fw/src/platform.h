@@ -25,3 +25,6 @@ void platformRegisterIdleCallback(void(*cb)(void));
 
 uint16_t knob(uint8_t n);
 bool button(uint8_t n);
+
+/// Samples processed since the start, for timing control input
+unsigned sampleCounter(void);
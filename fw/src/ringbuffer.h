@@ -0,0 +1,71 @@
+#pragma once
+
+/**
+ * Lock-free single producer, single consumer ring of samples, for streaming
+ * audio from one context to another, e.g. from the audio interrupt to work
+ * done in the idle loop and back. Neither side ever waits: the writer checks
+ * how much room there is and the reader how much there is to read.
+ *
+ * The counters of written and read samples only ever grow and wrap around
+ * with size_t, so the ring can use all of its power of two capacity.
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+typedef struct {
+    float* data;
+    size_t mask; ///< Capacity - 1
+    _Atomic size_t written; ///< Only changed by the writer
+    _Atomic size_t read; ///< Only changed by the reader
+} RingBuffer;
+
+/**
+ * @param data Storage for the samples
+ * @param capacity Number of samples in data, a power of two
+ */
+static inline void ringBufferInit(RingBuffer* rb, float* data, size_t capacity)
+{
+    rb->data = data;
+    rb->mask = capacity - 1;
+    atomic_init(&rb->written, 0);
+    atomic_init(&rb->read, 0);
+}
+
+/// Samples the reader can take
+static inline size_t ringBufferReadable(RingBuffer* rb)
+{
+    return atomic_load_explicit(&rb->written, memory_order_acquire) -
+            atomic_load_explicit(&rb->read, memory_order_relaxed);
+}
+
+/// Samples the writer can add
+static inline size_t ringBufferWritable(RingBuffer* rb)
+{
+    return rb->mask + 1 - (atomic_load_explicit(&rb->written, memory_order_relaxed) -
+            atomic_load_explicit(&rb->read, memory_order_acquire));
+}
+
+/**
+ * Add samples, no more than ringBufferWritable()
+ */
+static inline void ringBufferWrite(RingBuffer* rb, const float* src, size_t n)
+{
+    const size_t w = atomic_load_explicit(&rb->written, memory_order_relaxed);
+    for (size_t i = 0; i < n; i++) {
+        rb->data[(w + i) & rb->mask] = src[i];
+    }
+    atomic_store_explicit(&rb->written, w + n, memory_order_release);
+}
+
+/**
+ * Take samples, no more than ringBufferReadable()
+ */
+static inline void ringBufferRead(RingBuffer* rb, float* dst, size_t n)
+{
+    const size_t r = atomic_load_explicit(&rb->read, memory_order_relaxed);
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = rb->data[(r + i) & rb->mask];
+    }
+    atomic_store_explicit(&rb->read, r + n, memory_order_release);
+}
@@ -0,0 +1,151 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "taptempo.h"
+#include "utils.h"
+
+/// In beats, from short to long
+static const float subdivisions[] = {
+    0.25f, 1.0f/3, 0.5f, 2.0f/3, 0.75f, 1.0f, 1.5f, 2.0f
+};
+#define SUBDIVISION_COUNT (sizeof(subdivisions)/sizeof(*subdivisions))
+
+/**
+ * The median of the intervals, refined to the mean of those within the
+ * tolerance of it
+ */
+static float estimatePeriod(const TapTempo* tt)
+{
+    unsigned sorted[TAPTEMPO_MAX_TAPS - 1];
+    for (unsigned i = 0; i < tt->count; i++) {
+        unsigned j = i;
+        for (; j > 0 && sorted[j - 1] > tt->intervals[i]; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = tt->intervals[i];
+    }
+
+    // The lower of the middle two for an even count, so that the median is
+    // always one of the intervals and counts itself
+    const float median = sorted[(tt->count - 1) / 2];
+    float sum = 0.0f;
+    unsigned n = 0;
+    for (unsigned i = 0; i < tt->count; i++) {
+        if (fabsf(sorted[i] - median) <= TAPTEMPO_TOLERANCE * median) {
+            sum += sorted[i];
+            n++;
+        }
+    }
+    return sum / n;
+}
+
+/**
+ * Take a press of the button
+ *
+ * @return True if the tempo changed
+ */
+static bool tap(TapTempo* tt, unsigned now)
+{
+    const unsigned interval = now - tt->lastTap;
+    const bool inSeries = tt->inSeries && interval <= TAPTEMPO_MAX_INTERVAL;
+    if (inSeries && interval < TAPTEMPO_MIN_INTERVAL) {
+        // A double tap
+        return false;
+    }
+    tt->lastTap = now;
+    tt->inSeries = true;
+    if (!inSeries) {
+        tt->count = 0;
+        tt->outliers = 0;
+        return false;
+    }
+
+    if (tt->period && fabsf(interval - tt->period) >
+            TAPTEMPO_TOLERANCE * tt->period) {
+        tt->outliers++;
+    }
+    else {
+        tt->outliers = 0;
+    }
+
+    memmove(&tt->intervals[1], &tt->intervals[0],
+            (TAPTEMPO_MAX_TAPS - 2) * sizeof(*tt->intervals));
+    tt->intervals[0] = interval;
+    if (tt->count < TAPTEMPO_MAX_TAPS - 1) {
+        tt->count++;
+    }
+
+    // The player has moved on to another tempo if the last two taps agree
+    // with each other, forget the old one
+    if (tt->outliers >= 2 && fabsf((float)tt->intervals[0] - tt->intervals[1]) <=
+            TAPTEMPO_TOLERANCE * tt->intervals[1]) {
+        tt->count = 2;
+        tt->outliers = 0;
+    }
+
+    const float old = tt->period;
+    tt->period = estimatePeriod(tt);
+    return tt->period != old;
+}
+
+bool tapTempoUpdate(TapTempo* tt, bool pressed, unsigned now)
+{
+    if (pressed != tt->pressed) {
+        if (now - tt->lastChange < TAPTEMPO_DEBOUNCE) {
+            return false;
+        }
+        tt->pressed = pressed;
+        tt->lastChange = now;
+        return pressed ? tap(tt, now) : false;
+    }
+
+    if (pressed && tt->period && now - tt->lastChange >= TAPTEMPO_HOLD) {
+        tt->period = 0;
+        tt->count = 0;
+        tt->inSeries = false;
+        return true;
+    }
+    return false;
+}
+
+float tapTempoSubdivision(float knob)
+{
+    const float i = knob * SUBDIVISION_COUNT;
+    return subdivisions[CLAMP((int)i, 0, (int)SUBDIVISION_COUNT - 1)];
+}
+
+float tapTempoLength(const TapTempo* tt, float beats, float max)
+{
+    float length = beats * tt->period;
+    while (length > max) {
+        length *= 0.5f;
+    }
+    return length;
+}
+
+float tapTempoSpeed(const TapTempo* tt, float beats)
+{
+    if (!tt->period) {
+        return 0.0f;
+    }
+    return 2 * M_PI / (beats * tt->period);
+}
+
+void tapTempoReport(const TapTempo* tt, const char* name)
+{
+    if (tt->period) {
+        // In tenths, as printf on the target has no floats
+        const unsigned bpm = 600.0f * CODEC_SAMPLERATE / tt->period + 0.5f;
+        printf("%s: %u.%u BPM from %u taps\n", name, bpm / 10, bpm % 10,
+                tt->count + 1);
+    }
+    else {
+        printf("%s: cleared\n", name);
+    }
+}
+
+void tapTempoInit(TapTempo* tt)
+{
+    memset(tt, 0, sizeof(*tt));
+}
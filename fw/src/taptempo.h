@@ -0,0 +1,79 @@
+#pragma once
+
+/**
+ * Tap tempo from a button. The idle loop polls the button and timestamps each
+ * press with sampleCounter(), and the beat is estimated from the intervals
+ * between the last few presses: their median, refined to the mean of the
+ * intervals close to it, so that a single early or late tap doesn't move the
+ * tempo. Two intervals in a row that are far off the tempo but agree with
+ * each other start a new one. A pause longer than the slowest beat starts a
+ * new series of taps without forgetting the tempo, and holding the button
+ * down clears it.
+ *
+ * Effects take their delays and LFO periods from the tempo as a number of
+ * beats, picked from the usual note values with tapTempoSubdivision().
+ */
+
+#include <stdbool.h>
+
+#include "codec.h"
+
+/// Taps the tempo is estimated from
+#define TAPTEMPO_MAX_TAPS 8
+
+/// Fastest and slowest beat, 300 and 30 BPM
+#define TAPTEMPO_MIN_INTERVAL (CODEC_SAMPLERATE / 5)
+#define TAPTEMPO_MAX_INTERVAL (2 * CODEC_SAMPLERATE)
+
+/// Presses closer to the previous change of the button are contact bounce
+#define TAPTEMPO_DEBOUNCE (CODEC_SAMPLERATE / 50)
+
+/// Holding the button this long clears the tempo
+#define TAPTEMPO_HOLD (3 * CODEC_SAMPLERATE / 2)
+
+/// How far an interval may be off the median, relative to it, to count
+#define TAPTEMPO_TOLERANCE 0.2f
+
+typedef struct {
+    unsigned intervals[TAPTEMPO_MAX_TAPS - 1]; ///< Latest first
+    unsigned count; ///< Intervals since the series started
+    unsigned outliers; ///< Latest intervals in a row far off the tempo
+    unsigned lastTap;
+    unsigned lastChange; ///< Of the button state
+    bool inSeries; ///< lastTap starts the next interval
+    bool pressed;
+    float period; ///< Samples per beat, 0 without a tempo
+} TapTempo;
+
+void tapTempoInit(TapTempo* tt);
+
+/**
+ * Follow the button, called from the idle loop often enough to see each press
+ *
+ * @param pressed State of the button
+ * @param now sampleCounter()
+ * @return True if the tempo changed
+ */
+bool tapTempoUpdate(TapTempo* tt, bool pressed, unsigned now);
+
+/**
+ * Note value for a knob from 0 to 1, in beats: a sixteenth note, eighth note
+ * triplet, eighth note, quarter note triplet, dotted eighth note, quarter note,
+ * dotted quarter note or half note
+ */
+float tapTempoSubdivision(float knob);
+
+/**
+ * Length of a number of beats in samples, halved until it is at most max
+ */
+float tapTempoLength(const TapTempo* tt, float beats, float max);
+
+/**
+ * Speed of an LFO in radians per sample, for one period every number of beats
+ */
+float tapTempoSpeed(const TapTempo* tt, float beats);
+
+/**
+ * Print the tempo, such as when tapTempoUpdate() returns true
+ */
+void tapTempoReport(const TapTempo* tt, const char* name);
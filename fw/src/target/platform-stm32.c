@@ -2,6 +2,8 @@
  * Platform specific details for running on STM32F405RG.
  */
 
+#include <libopencm3/cm3/cortex.h>
+#include <libopencm3/cm3/dwt.h>
 #include <libopencm3/cm3/itm.h>
 #include <libopencm3/stm32/adc.h>
 #include <libopencm3/stm32/gpio.h>
@@ -13,6 +15,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 
+#include "loadmeter.h"
 #include "platform.h"
 #include "wm8731.h"
 #include "codec.h"
@@ -129,6 +132,9 @@ void platformInit(const KnobConfig* knobConfig)
     rcc_periph_clock_enable(RCC_DMA2);
     rcc_periph_clock_enable(RCC_ADC1);
 
+    // Used for measuring processing load
+    dwt_enable_cycle_counter();
+
     // Enable LED pins and turn them on
     gpio_mode_setup(GPIOC, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, GPIO8 | GPIO7);
     gpio_mode_setup(GPIOB, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, GPIO6);
@@ -152,6 +158,11 @@ bool button(uint8_t n)
     return gpio_get(pins[n].port, pins[n].pinno);
 }
 
+unsigned sampleCounter(void)
+{
+    return samplecounter;
+}
+
 void platformRegisterIdleCallback(void(*cb)(void))
 {
     idleCallback = cb;
@@ -176,6 +187,15 @@ void platformMainloop(void)
                     adcValues[4], adcValues[5]);
 
             peakIn = peakOut = INT16_MIN;
+
+            // Take the load statistics for the last second. Interrupts are
+            // disabled so the audio interrupt can't update it half way.
+            cm_disable_interrupts();
+            const LoadStats load = codecLoadStats;
+            loadMeterReset(&codecLoadStats);
+            cm_enable_interrupts();
+            loadMeterPrint("process", &load);
+
             lastprint += CODEC_SAMPLERATE;
         }
 
@@ -1,8 +1,17 @@
 #pragma once
 
 #include <stdbool.h>
+#include <libopencm3/cm3/dwt.h>
 #include <libopencm3/stm32/gpio.h>
 
+/// The core clock set up by platformInit()
+#define CYCLES_PER_SECOND 168000000
+
+/// Place a variable in the 64 KB core coupled memory, which the CPU accesses
+/// without wait states or contention with DMA. It's not reachable by DMA and
+/// not zeroed at startup.
+#define CCM_DATA __attribute__((section(".ccmram")))
+
 static inline void setLed(enum Led led, bool state)
 {
     switch (led) {
@@ -18,4 +27,12 @@ static inline void setLed(enum Led led, bool state)
     }
 }
 
+/**
+ * Read the DWT cycle counter, which is enabled by platformInit().
+ */
+static inline uint32_t cycleCounter(void)
+{
+    return DWT_CYCCNT;
+}
+
 void platformFrameFinishedCB(void);
@@ -15,8 +15,9 @@
 
 #define EP_ID_AUDIO_FROM_ME 0x83
 
-// Send 48 samples (2 channels * 2 bytes) every 1 ms
-#define AUDIO_PACKET_SAMPLES 48
+// Send a millisecond worth of samples (2 channels * 2 bytes) every 1 ms. At
+// 44.1 kHz the extra sample allowed per packet takes up the fraction.
+#define AUDIO_PACKET_SAMPLES (CODEC_SAMPLERATE / 1000)
 #define AUDIO_PACKET_SIZE (AUDIO_PACKET_SAMPLES*4)
 #define MAX_AUDIO_PACKET_SIZE (AUDIO_PACKET_SIZE + 16)
 
@@ -5,6 +5,7 @@
 #include <libopencm3/stm32/rcc.h>
 #include <libopencm3/stm32/spi.h>
 #include <libopencm3/cm3/nvic.h>
+#include "loadmeter.h"
 #include "platform.h"
 #include "usb_audio.h"
 
@@ -20,6 +21,41 @@ _Atomic unsigned samplecounter;
 _Atomic CodecIntSample peakIn = INT16_MIN;
 _Atomic CodecIntSample peakOut = INT16_MIN;
 
+/*
+ * I2S clock settings for each sample rate, from table 127 in the reference
+ * manual (with a 1 MHz PLLI2S input and MCLK output enabled). MCLK is always
+ * 256 * fs, and the codec sampling control register is set to a rate the
+ * WM8731 datasheet lists for that MCLK in normal mode: 44.1 kHz from
+ * 11.2896 MHz and 48 kHz from 12.288 MHz. At 96 kHz MCLK is 24.576 MHz, which
+ * the codec divides by two (CLKIDIV2) to use the 96 kHz setting for
+ * 12.288 MHz. 32 kHz would need 8.192 MHz, which the datasheet has no
+ * setting for.
+ */
+#if CODEC_SAMPLERATE == 32000
+#error "The WM8731 has no 32 kHz setting for the 8.192 MHz MCLK of the I2S"
+#elif CODEC_SAMPLERATE == 44100
+#define I2S_PLLN 271
+#define I2S_PLLR 2
+#define I2S_DIV 6
+#define I2S_ODD 0
+#define WM8731_SR 0b1000
+#define WM8731_CLKIDIV2 0
+#elif CODEC_SAMPLERATE == 48000
+#define I2S_PLLN 258
+#define I2S_PLLR 3
+#define I2S_DIV 3
+#define I2S_ODD 1
+#define WM8731_SR 0b0000
+#define WM8731_CLKIDIV2 0
+#elif CODEC_SAMPLERATE == 96000
+#define I2S_PLLN 344
+#define I2S_PLLR 2
+#define I2S_DIV 3
+#define I2S_ODD 1
+#define WM8731_SR 0b0111
+#define WM8731_CLKIDIV2 1
+#endif
+
 static const uint32_t DAC_DMA_STREAM = DMA_STREAM4; // SPI2_TX
 static const uint32_t DAC_DMA_CHANNEL = DMA_SxCR_CHSEL_0;
 static const uint32_t ADC_DMA_STREAM = DMA_STREAM3; // I2S2_EXT_RX
@@ -62,6 +98,8 @@ static void codecConfig()
 #endif
     codecWriteReg(0x06, 0b000000000); // Power down control - enable everything
     codecWriteReg(0x07, 0b000000010); // Interface format - 16-bit I2S
+    // Sampling control - normal mode, BOSR 0, core clock MCLK or MCLK / 2
+    codecWriteReg(0x08, (WM8731_CLKIDIV2 << 6) | (WM8731_SR << 2));
     codecWriteReg(0x09, 0b000000001); // Active control - engage!
 }
 
@@ -109,23 +147,22 @@ void codecInit(void)
 
     codecConfig();
 
-    // Set up I2S for 48kHz 16-bit stereo.
+    // Set up I2S for 16-bit stereo at CODEC_SAMPLERATE.
     // The input to the PLLI2S is 1MHz. Division factors are from
-    // table 126 in the data sheet.
+    // table 127 in the reference manual.
     //
-    // This gives us 1.536MHz SCLK = 16 bits * 2 channels * 48000 Hz
+    // At 48 kHz this gives us 1.536MHz SCLK = 16 bits * 2 channels * 48000 Hz
     // and 12.288 MHz MCLK = 256 * 48000 Hz.
     // With this PLL configuration the actual sampling frequency
     // is nominally 47991 Hz.
 
     spi_reset(SPI2);
 
-    RCC_PLLI2SCFGR = (3 << 28) | (258 << 6);
+    RCC_PLLI2SCFGR = (I2S_PLLR << 28) | (I2S_PLLN << 6);
     RCC_CR |= RCC_CR_PLLI2SON;
     while (!(RCC_CR & RCC_CR_PLLI2SRDY));
 
-    const unsigned i2sdiv = 3;
-    SPI_I2SPR(SPI2) = SPI_I2SPR_MCKOE | SPI_I2SPR_ODD | i2sdiv;
+    SPI_I2SPR(SPI2) = SPI_I2SPR_MCKOE | (I2S_ODD ? SPI_I2SPR_ODD : 0) | I2S_DIV;
     SPI_I2SCFGR(SPI2) |= SPI_I2SCFGR_I2SMOD | SPI_I2SCFGR_I2SE |
             (SPI_I2SCFGR_I2SCFG_MASTER_TRANSMIT << SPI_I2SCFGR_I2SCFG_LSB);
     SPI_I2SCFGR(I2S2_EXT_BASE) = SPI_I2SCFGR_I2SMOD | SPI_I2SCFGR_I2SE |
@@ -172,10 +209,11 @@ void dma1_stream3_isr(void)
 {
     dma_clear_interrupt_flags(DMA1, ADC_DMA_STREAM, DMA_TCIF);
 
-    AudioBuffer* outBuffer = dma_get_target(DMA1, DAC_DMA_STREAM) ?
+    const unsigned dacTarget = dma_get_target(DMA1, DAC_DMA_STREAM);
+    AudioBuffer* outBuffer = dacTarget ?
                     (void*)dacBuffer[0] :
                     (void*)dacBuffer[1];
-    AudioBuffer* inBuffer = dma_get_target(DMA1, DAC_DMA_STREAM) ?
+    AudioBuffer* inBuffer = dacTarget ?
                     (void*)adcBuffer[0] :
                     (void*)adcBuffer[1];
 
@@ -194,7 +232,14 @@ void dma1_stream3_isr(void)
 #endif
 
     if (appProcess) {
+        const uint32_t start = cycleCounter();
         appProcess((const AudioBuffer*)inBuffer, (AudioBuffer*)outBuffer);
+        const uint32_t cycles = cycleCounter() - start;
+
+        // If the DAC DMA has moved on to the buffer we were writing to, it
+        // has started playing it before processing finished.
+        const bool overrun = dma_get_target(DMA1, DAC_DMA_STREAM) != dacTarget;
+        loadMeterRecord(&codecLoadStats, cycles, overrun);
     }
 
     samplecounter += CODEC_SAMPLES_PER_FRAME;
@@ -0,0 +1,297 @@
+/*
+ * Cost against quality of keeping delay lines in ADPCM (dsp/adpcm.h) rather
+ * than as int16 samples, the two storage modes of the delay (DELAY_ADPCM in
+ * dsp/delay.h).
+ *
+ * The cost is the time per sample to write a line a frame at a time, and to
+ * read it back a frame at a time at a fractional delay, which for ADPCM means
+ * decoding the range the frame covers first, like the delay does for each of
+ * its taps. The quality is the signal to noise ratio of the decoded samples
+ * against the int16 samples written, which raw int16 storage keeps exactly,
+ * once and after the signal went round the line a few times at a feedback
+ * gain, as the repeats of the delay do, against the same repeats in int16.
+ *
+ * Results go to stdout as CSV and a readable summary goes to stderr, like
+ * bench_dsp.
+ *
+ * Usage: bench_adpcm.elf [-n frames]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "codec.h"
+#include "dsp/adpcm.h"
+#include "dsp/delayline.h"
+#include "utils.h"
+
+#define DEFAULT_FRAMES 200000
+#define CAPACITY 65536
+#define MASK (CAPACITY - 1)
+
+/// One second of each test signal
+#define SIGNAL_LEN CODEC_SAMPLERATE
+
+/// Passes through the line for the second SNR figure, and the gain each time
+#define REPEATS 4
+#define FEEDBACK 0.7f
+
+/// Delay of the timed reads, in samples
+#define READ_DELAY 20000.25f
+
+/// Samples decoded around a frame of reads, as in the delay
+#define WINDOW_LEN (CODEC_SAMPLES_PER_FRAME + INTERP_MAX_TAPS)
+
+static CodecIntSample intLine[DELAYLINE_STORAGE(CAPACITY)];
+static AdpcmBlock adpcmLine[ADPCM_BLOCKS(CAPACITY)];
+
+static CodecIntSample signal[SIGNAL_LEN];
+static CodecIntSample decoded[SIGNAL_LEN];
+static CodecIntSample reference[SIGNAL_LEN];
+
+typedef void (*MakeSignal)(void);
+
+/// A plucked string, a decaying 110 Hz tone with harmonics, every half second
+static void makePluck(float level)
+{
+    for (unsigned n = 0; n < SIGNAL_LEN; n++) {
+        const float t = (float)(n % (SIGNAL_LEN / 2)) / CODEC_SAMPLERATE;
+        float v = 0.0f;
+        for (unsigned h = 1; h <= 8; h++) {
+            v += expf(-t * 3 * h) / h * sinf(2 * M_PI * 110 * h * t);
+        }
+        signal[n] = level * 16000 * v;
+    }
+}
+
+static void makePluckLoud(void)
+{
+    makePluck(1.0f);
+}
+
+static void makePluckQuiet(void)
+{
+    makePluck(0.03f);
+}
+
+static void makeSine(float frequency)
+{
+    for (unsigned n = 0; n < SIGNAL_LEN; n++) {
+        signal[n] = 16000 * sinf(2 * M_PI * frequency * n / CODEC_SAMPLERATE);
+    }
+}
+
+static void makeSine220(void)
+{
+    makeSine(220);
+}
+
+static void makeSine4k(void)
+{
+    makeSine(4000);
+}
+
+static void makeNoise(void)
+{
+    unsigned seed = 1;
+    for (unsigned n = 0; n < SIGNAL_LEN; n++) {
+        seed = seed * 1103515245 + 12345;
+        signal[n] = (int16_t)(seed >> 16) / 4;
+    }
+}
+
+struct Signal {
+    const char* name;
+    MakeSignal make;
+};
+
+static const struct Signal signals[] = {
+        { "pluck", makePluckLoud },
+        { "pluck-30db", makePluckQuiet },
+        { "sine-220", makeSine220 },
+        { "sine-4k", makeSine4k },
+        { "noise", makeNoise },
+};
+
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_CYCLES 1
+#else
+/// Without a cycle counter the cycles columns read n/a
+#define HAVE_CYCLES 0
+#endif
+
+static unsigned long long cycles(void)
+{
+#if HAVE_CYCLES
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Signal to noise ratio in dB of the signal through the ADPCM line, passing
+ * through it passes times with the feedback gain before all but the first
+ */
+static double measureSnr(unsigned passes)
+{
+    memcpy(decoded, signal, sizeof(decoded));
+    memcpy(reference, signal, sizeof(reference));
+    for (unsigned p = 0; p < passes; p++) {
+        const float gain = p ? FEEDBACK : 1.0f;
+        AdpcmEncoder enc = { 0 };
+        for (unsigned n = 0; n < SIGNAL_LEN; n++) {
+            adpcmWrite(adpcmLine, MASK, &enc, n, lrintf(gain * decoded[n]));
+            reference[n] = lrintf(gain * reference[n]);
+        }
+        adpcmDecode(adpcmLine, MASK, 0, SIGNAL_LEN, decoded);
+    }
+
+    double power = 0.0;
+    double noise = 0.0;
+    for (unsigned n = 0; n < SIGNAL_LEN; n++) {
+        const double d = decoded[n] - reference[n];
+        power += (double)reference[n] * reference[n];
+        noise += d * d;
+    }
+    return 10 * log10(power / (noise > 1e-30 ? noise : 1e-30));
+}
+
+/// Time per sample of writes and reads of one storage mode
+struct Cost {
+    double writeNs;
+    double writeCycles;
+    double readNs;
+    double readCycles;
+    float checksum;
+};
+
+static void writeInt16(size_t pos)
+{
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        delayLineWrite(intLine, MASK, pos + s, signal[(pos + s) % SIGNAL_LEN]);
+    }
+}
+
+static void readInt16(size_t pos, float* out)
+{
+    delayLineReadRamp(intLine, MASK, CAPACITY + pos - READ_DELAY, 1.0f,
+            CODEC_SAMPLES_PER_FRAME, out);
+}
+
+static AdpcmEncoder encoder;
+
+static void writeAdpcm(size_t pos)
+{
+    for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+        adpcmWrite(adpcmLine, MASK, &encoder, pos + s,
+                signal[(pos + s) % SIGNAL_LEN]);
+    }
+}
+
+static void readAdpcm(size_t pos, float* out)
+{
+    CodecIntSample window[WINDOW_LEN];
+    const float first = CAPACITY + pos - READ_DELAY;
+    const size_t start = (size_t)first - 1;
+    adpcmDecode(adpcmLine, MASK, start, WINDOW_LEN, window);
+    delayLineReadRamp(window, SIZE_MAX, first - start, 1.0f,
+            CODEC_SAMPLES_PER_FRAME, out);
+}
+
+struct Storage {
+    const char* name;
+    void (*write)(size_t pos);
+    void (*read)(size_t pos, float* out);
+    size_t bytes; ///< For CAPACITY samples
+};
+
+static const struct Storage storages[] = {
+        { "int16", writeInt16, readInt16, sizeof(intLine) },
+        { "adpcm", writeAdpcm, readAdpcm, sizeof(adpcmLine) },
+};
+
+static struct Cost measureCost(const struct Storage* st, unsigned frames)
+{
+    struct Cost c = { 0 };
+    const double samples = (double)frames * CODEC_SAMPLES_PER_FRAME;
+
+    double start = now();
+    unsigned long long startCycles = cycles();
+    for (unsigned f = 0; f < frames; f++) {
+        st->write((size_t)f * CODEC_SAMPLES_PER_FRAME & MASK);
+    }
+    c.writeCycles = (cycles() - startCycles) / samples;
+    c.writeNs = 1e9 * (now() - start) / samples;
+
+    float out[CODEC_SAMPLES_PER_FRAME];
+    start = now();
+    startCycles = cycles();
+    for (unsigned f = 0; f < frames; f++) {
+        st->read((size_t)f * CODEC_SAMPLES_PER_FRAME & MASK, out);
+        c.checksum += out[f % CODEC_SAMPLES_PER_FRAME];
+    }
+    c.readCycles = (cycles() - startCycles) / samples;
+    c.readNs = 1e9 * (now() - start) / samples;
+    return c;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned frames = DEFAULT_FRAMES;
+    if (argc > 2 && !strcmp(argv[1], "-n")) {
+        frames = strtoul(argv[2], NULL, 0);
+    }
+    if (frames == 0) {
+        fprintf(stderr, "Usage: %s [-n frames]\n", argv[0]);
+        return 1;
+    }
+
+    makePluckLoud();
+    fprintf(stderr, "%u frames per storage, %u samples in the line\n", frames,
+            CAPACITY);
+    printf("name,bytes,write_ns,write_cycles,read_ns,read_cycles,checksum\n");
+    const size_t storageCount = sizeof(storages)/sizeof(*storages);
+    for (size_t i = 0; i < storageCount; i++) {
+        const struct Storage* st = &storages[i];
+        const struct Cost c = measureCost(st, frames);
+        char writeCycles[16] = "n/a";
+        char readCycles[16] = "n/a";
+        if (HAVE_CYCLES) {
+            snprintf(writeCycles, sizeof(writeCycles), "%.2f", c.writeCycles);
+            snprintf(readCycles, sizeof(readCycles), "%.2f", c.readCycles);
+        }
+        printf("%s,%zu,%.2f,%s,%.2f,%s,%g\n", st->name, st->bytes,
+                c.writeNs, writeCycles, c.readNs, readCycles, c.checksum);
+        fprintf(stderr, "%-6s %6zu bytes  write %6.2f ns %6s cycles  "
+                "read %6.2f ns %6s cycles per sample\n", st->name, st->bytes,
+                c.writeNs, writeCycles, c.readNs, readCycles);
+    }
+
+    fprintf(stderr, "\nSNR of adpcm against int16, once and after %u passes "
+            "at feedback %.1f\n", REPEATS, FEEDBACK);
+    printf("\nsignal,snr,snr_%u_passes\n", REPEATS);
+    const size_t signalCount = sizeof(signals)/sizeof(*signals);
+    for (size_t i = 0; i < signalCount; i++) {
+        const struct Signal* s = &signals[i];
+        s->make();
+        const double once = measureSnr(1);
+        const double repeated = measureSnr(REPEATS);
+        printf("%s,%.1f,%.1f\n", s->name, once, repeated);
+        fprintf(stderr, "%-10s %5.1f dB %5.1f dB\n", s->name, once, repeated);
+    }
+
+    return 0;
+}
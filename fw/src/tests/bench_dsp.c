@@ -0,0 +1,572 @@
+/*
+ * Benchmark for the DSP blocks in dsp/. Each block is run over a number of
+ * frames of a test signal while its parameters are swept, and the time spent
+ * is reported per frame, per sample and as a share of the real time budget of
+ * one frame.
+ *
+ * Results go to stdout as CSV, so that they can be collected and compared
+ * across commits, and a readable summary goes to stderr.
+ *
+ * Usage: bench_dsp.elf [-n frames] [name...]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "codec.h"
+#include "dsp/biquad.h"
+#include "dsp/cabinet.h"
+#include "dsp/delay.h"
+#include "dsp/pitcher.h"
+#include "dsp/reverb.h"
+#include "dsp/gate.h"
+#include "dsp/vibrato.h"
+#include "dsp/wahwah.h"
+#include "dsp/waveshaper.h"
+#include "utils.h"
+
+#define DEFAULT_FRAMES 1000000
+#define SIGNAL_FRAMES 256
+
+/// Real time available for processing one frame, in nanoseconds
+#define FRAME_BUDGET_NS (1e9 * CODEC_SAMPLES_PER_FRAME / CODEC_SAMPLERATE)
+
+struct Benchmark {
+    const char* name;
+    void(*init)(void);
+    /// Process one frame. sweep goes from 0 to 1 and back over the run.
+    void(*process)(const FloatAudioBuffer* restrict in,
+            FloatAudioBuffer* restrict out, float sweep);
+    /// Used instead of process for fixed point blocks
+    void(*processFixed)(const AudioBuffer* restrict in,
+            AudioBuffer* restrict out, float sweep);
+};
+
+static FloatAudioBuffer signal[SIGNAL_FRAMES];
+static AudioBuffer intSignal[SIGNAL_FRAMES];
+
+static DelayState delayState;
+static VibratoState vibratoState;
+static FixedVibratoState fixedVibratoState;
+static PitcherState pitcherState;
+static WahwahState wahwahState;
+static FloatBiquadState bqState;
+static FloatBiquadCascade bqCascade;
+static FixedBiquadState fixedBqState;
+static CabinetState cabinetState;
+static ReverbState reverbState;
+static GateState gateState;
+static DriveState driveState;
+static DriveParams driveSetup;
+
+static void makeSignal(void)
+{
+    // A guitar-ish test signal: a decaying chord with some noise on top
+    unsigned seed = 1;
+    for (unsigned f = 0; f < SIGNAL_FRAMES; f++) {
+        for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+            const unsigned n = f * CODEC_SAMPLES_PER_FRAME + s;
+            const float t = (float)n / CODEC_SAMPLERATE;
+            const float env = expf(-4.0f * t);
+            for (unsigned c = 0; c < 2; c++) {
+                seed = seed * 1103515245 + 12345;
+                const float noise = ((int)(seed >> 16) & 0x7fff) - 0x4000;
+                signal[f].s[s][c] = env * (8000 * sinf(2 * M_PI * 110 * t) +
+                        6000 * sinf(2 * M_PI * 165 * t + c) +
+                        4000 * sinf(2 * M_PI * 220 * t)) + 0.05f * noise;
+            }
+        }
+        floatToSamples(&signal[f], &intSignal[f]);
+    }
+}
+
+static void initDelayBench(void)
+{
+    initDelay(&delayState);
+}
+
+static void runDelay(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, float sweep)
+{
+    const DelayParams params = {
+            .input = 0.8f,
+            .confusion = sweep,
+            .feedback = 0.5f,
+            .octaveMix = 0.5f * sweep,
+            .length = 0.1f + 0.9f * sweep
+    };
+    memset(out, 0, sizeof(*out));
+    processDelay(in, out, &delayState, &params);
+}
+
+/// The same with the confusion taps moved by a sine LFO
+static void runDelayWobble(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, float sweep)
+{
+    const DelayParams params = {
+            .input = 0.8f,
+            .confusion = sweep,
+            .feedback = 0.5f,
+            .octaveMix = 0.5f * sweep,
+            .length = 0.1f + 0.9f * sweep,
+            .wobble = 0.002f,
+            .lfo = { .shape = LFO_SINE, .speed = HZ2OMEGA(0.3f) }
+    };
+    memset(out, 0, sizeof(*out));
+    processDelay(in, out, &delayState, &params);
+}
+
+static void runDelayFixed(const AudioBuffer* restrict in,
+        AudioBuffer* restrict out, float sweep)
+{
+    const DelayParams params = {
+            .input = 0.8f,
+            .confusion = sweep,
+            .feedback = 0.5f,
+            .octaveMix = 0.5f * sweep,
+            .length = 0.1f + 0.9f * sweep
+    };
+    processDelayFixed(in, out, &delayState, &params);
+}
+
+static void initVibratoBench(void)
+{
+    initVibrato(&vibratoState);
+}
+
+static void runVibrato(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, float sweep)
+{
+    const VibratoParams params = {
+            .speed = exp2f(RAMP(sweep, 0.0001f, 0.005f)) - 1.0f,
+            .depth = sweep * (VIBRATO_MAX_DEPTH-1),
+            .phasediff = sweep * M_PI/4
+    };
+    processVibrato(in, out, &vibratoState, &params);
+}
+
+static void initVibratoFixedBench(void)
+{
+    initVibratoFixed(&fixedVibratoState);
+}
+
+static void runVibratoFixed(const AudioBuffer* restrict in,
+        AudioBuffer* restrict out, float sweep)
+{
+    const VibratoParams params = {
+            .speed = exp2f(RAMP(sweep, 0.0001f, 0.005f)) - 1.0f,
+            .depth = sweep * (VIBRATO_MAX_DEPTH-1),
+            .phasediff = sweep * M_PI/4
+    };
+    processVibratoFixed(in, out, &fixedVibratoState, &params);
+}
+
+static void initPitcherBench(void)
+{
+    initPitcher(&pitcherState);
+}
+
+static void runPitcher(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, float sweep)
+{
+    const PitcherParams params = {
+            .speed = sweep,
+            .wet = 0.5f,
+            .phasediff = 0.02f * sweep
+    };
+    processPitcher(in, out, &pitcherState, &params);
+}
+
+static void initWahwahBench(void)
+{
+    initWahwah(&wahwahState);
+}
+
+static void runWahwah(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, float sweep)
+{
+    const WahwahParams params = {
+            .wah = sweep,
+            .q = 0.5f
+    };
+    processWahwah(in, out, &wahwahState, &params);
+}
+
+/// Auto-wah, with the peak following the input level
+static void runWahwahAuto(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, float sweep)
+{
+    const WahwahParams params = {
+            .wah = 0.2f,
+            .q = 0.5f,
+            .sweep = 2 * sweep,
+            .lfo = { .shape = LFO_ENVELOPE, .attack = 0.005f, .release = 0.2f }
+    };
+    processWahwah(in, out, &wahwahState, &params);
+}
+
+static void initBiquadBench(void)
+{
+    memset(&bqState, 0, sizeof(bqState));
+}
+
+static void runBiquad(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, float sweep)
+{
+    FloatBiquadCoeffs coeffs;
+    bqMakeLowpass(&coeffs, RAMP(sweep, HZ2OMEGA(200), HZ2OMEGA(8000)), 0.7f);
+    bqProcess(in, out, &coeffs, &bqState);
+}
+
+static void initBiquadFixedBench(void)
+{
+    memset(&fixedBqState, 0, sizeof(fixedBqState));
+}
+
+static void runBiquadFixed(const AudioBuffer* restrict in,
+        AudioBuffer* restrict out, float sweep)
+{
+    FloatBiquadCoeffs coeffs;
+    FixedBiquadCoeffs fixedCoeffs;
+    bqMakeLowpass(&coeffs, RAMP(sweep, HZ2OMEGA(200), HZ2OMEGA(8000)), 0.7f);
+    bqMakeFixed(&fixedCoeffs, &coeffs);
+    bqProcessFixed(in, out, &fixedCoeffs, &fixedBqState);
+}
+
+static void initCascadeBench(void)
+{
+    bqCascadeInit(&bqCascade, 4);
+}
+
+static void runCascade(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, float sweep)
+{
+    // Four lowpass stages with coefficients changing every frame, the worst
+    // case with interpolation always active
+    FloatBiquadCoeffs coeffs;
+    bqMakeLowpass(&coeffs, RAMP(sweep, HZ2OMEGA(200), HZ2OMEGA(8000)), 0.7f);
+    for (unsigned n = 0; n < 4; n++) {
+        bqCascadeSetStage(&bqCascade, n, &coeffs);
+    }
+    bqCascadeProcess(in, out, &bqCascade);
+}
+
+static void initCabinetBench(void)
+{
+    initCabinet(&cabinetState);
+}
+
+static void runCabinet(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, float sweep)
+{
+    (void)sweep;
+    processCabinet(in, out, &cabinetState);
+}
+
+static void initReverbBench(void)
+{
+    initReverb(&reverbState);
+}
+
+static void runReverb(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, float sweep)
+{
+    const ReverbParams params = {
+            .decay = RAMP(sweep, 0.5f, 8.0f),
+            .damping = sweep,
+            .mix = 0.5f
+    };
+    processReverb(in, out, &reverbState, &params);
+}
+
+static void runReverbFixed(const AudioBuffer* restrict in,
+        AudioBuffer* restrict out, float sweep)
+{
+    const ReverbParams params = {
+            .decay = RAMP(sweep, 0.5f, 8.0f),
+            .damping = sweep,
+            .mix = 0.5f
+    };
+    processReverbFixed(in, out, &reverbState, &params);
+}
+
+static void initGateBench(void)
+{
+    initGate(&gateState);
+}
+
+/// The gate as the applications set it up, opening and closing on the
+/// decaying chord as the threshold sweeps
+static GateParams gateParams(float sweep)
+{
+    return (GateParams) {
+            .threshold = 0.003f * sweep,
+            .hysteresis = 0.5f,
+            .ratio = 3.0f,
+            .range = 0.05f,
+            .attack = 0.001f,
+            .hold = 0.05f,
+            .release = 0.1f,
+            .lookahead = GATE_MAX_LOOKAHEAD,
+            .detector = GATE_RMS
+    };
+}
+
+static void runGate(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, float sweep)
+{
+    const GateParams params = gateParams(sweep);
+    processGate(in, out, &gateState, &params);
+}
+
+static void runGateOpen(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, float sweep)
+{
+    // Never closing and without look-ahead, the cost of leaving it in
+    (void)sweep;
+    GateParams params = gateParams(0.0f);
+    params.lookahead = 0;
+    processGate(in, out, &gateState, &params);
+}
+
+static void runGateFixed(const AudioBuffer* restrict in,
+        AudioBuffer* restrict out, float sweep)
+{
+    const GateParams params = gateParams(sweep);
+    processGateFixed(in, out, &gateState, &params);
+}
+
+static void initGuitarChainBench(void)
+{
+    initGate(&gateState);
+    initDelay(&delayState);
+    initDrive(&driveState);
+    initCabinet(&cabinetState);
+    initReverb(&reverbState);
+}
+
+/// The heaviest path through the guitar application: the gate, the delay, the
+/// drive stage as built, the cabinet and the reverb
+static void runGuitarChain(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, float sweep)
+{
+    const GateParams gate = gateParams(sweep);
+    const DelayParams delay = {
+            .input = 0.8f,
+            .confusion = sweep,
+            .feedback = 0.5f,
+            .octaveMix = 0.5f * sweep,
+            .length = 0.1f + 0.9f * sweep,
+            .wobble = 0.002f,
+            .lfo = { .shape = LFO_SINE, .speed = HZ2OMEGA(0.3f) }
+    };
+    const DriveParams drive = {
+            .gainExp = exp2f(6*sweep),
+            .tubeMix = CLAMP(2*sweep, 0.0f, 1.0f),
+            .adaa = DRIVE_ADAA,
+            .oversample = DRIVE_OVERSAMPLE
+    };
+    const ReverbParams reverb = {
+            .decay = 1.2f,
+            .damping = 0.5f,
+            .mix = 0.3f
+    };
+    FloatAudioBuffer a = { 0 };
+    FloatAudioBuffer b;
+    processGate(in, &b, &gateState, &gate);
+    processDelay(&b, &a, &delayState, &delay);
+    processDrive(&a, &b, &driveState, &drive);
+    processCabinet(&b, &a, &cabinetState);
+    processReverb(&a, out, &reverbState, &reverb);
+}
+
+static void runWaveshaper(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, float sweep)
+{
+    // The gain stage at the end of every application
+    const float gainExp = exp2f(6*sweep);
+    const float tubeMix = CLAMP(2*sweep, 0.0f, 1.0f);
+    for (unsigned s = 0; s < 2 * CODEC_SAMPLES_PER_FRAME; s++) {
+        const float v = in->m[s] * gainExp;
+        out->m[s] = RAMP(tubeMix, saturateSoft(v), tubeSaturate(v));
+    }
+}
+
+static void initDriveBench(unsigned oversample, bool adaa)
+{
+    initDrive(&driveState);
+    driveSetup = (DriveParams) {
+            .curve = DRIVE_CURVE_MIX,
+            .adaa = adaa,
+            .oversample = oversample
+    };
+}
+
+static void initDrive1x(void) { initDriveBench(1, false); }
+static void initDrive2x(void) { initDriveBench(2, false); }
+static void initDrive4x(void) { initDriveBench(4, false); }
+static void initDrive8x(void) { initDriveBench(8, false); }
+static void initDrive1xAdaa(void) { initDriveBench(1, true); }
+static void initDrive2xAdaa(void) { initDriveBench(2, true); }
+static void initDrive4xAdaa(void) { initDriveBench(4, true); }
+static void initDrive8xAdaa(void) { initDriveBench(8, true); }
+
+static void runDrive(const FloatAudioBuffer* restrict in,
+        FloatAudioBuffer* restrict out, float sweep)
+{
+    // The same sweep as the plain waveshaper, through the drive stage
+    DriveParams params = driveSetup;
+    params.gainExp = exp2f(6*sweep);
+    params.tubeMix = CLAMP(2*sweep, 0.0f, 1.0f);
+    processDrive(in, out, &driveState, &params);
+}
+
+static void runWaveshaperFixed(const AudioBuffer* restrict in,
+        AudioBuffer* restrict out, float sweep)
+{
+    const int32_t gainExp = exp2f(6*sweep) * 256;
+    const int32_t tubeMix = FLOAT_TO_Q15(CLAMP(2*sweep, 0.0f, 1.0f));
+    for (unsigned s = 0; s < 2 * CODEC_SAMPLES_PER_FRAME; s++) {
+        const int32_t v = (in->m[s] * gainExp) >> 8;
+        const int32_t soft = saturateSoftFixed(v);
+        out->m[s] = soft + (((tubeSaturateFixed(v) - soft) * tubeMix) >> 15);
+    }
+}
+
+static const struct Benchmark benchmarks[] = {
+        { "delay", initDelayBench, runDelay, NULL },
+        { "delay-wobble", initDelayBench, runDelayWobble, NULL },
+        { "delay-fixed", initDelayBench, NULL, runDelayFixed },
+        { "vibrato", initVibratoBench, runVibrato, NULL },
+        { "vibrato-fixed", initVibratoFixedBench, NULL, runVibratoFixed },
+        { "pitcher", initPitcherBench, runPitcher, NULL },
+        { "wahwah", initWahwahBench, runWahwah, NULL },
+        { "wahwah-auto", initWahwahBench, runWahwahAuto, NULL },
+        { "biquad", initBiquadBench, runBiquad, NULL },
+        { "biquad-fixed", initBiquadFixedBench, NULL, runBiquadFixed },
+        { "cascade4", initCascadeBench, runCascade, NULL },
+        { "cabinet", initCabinetBench, runCabinet, NULL },
+        { "reverb", initReverbBench, runReverb, NULL },
+        { "reverb-fixed", initReverbBench, NULL, runReverbFixed },
+        { "gate", initGateBench, runGate, NULL },
+        { "gate-open", initGateBench, runGateOpen, NULL },
+        { "gate-fixed", initGateBench, NULL, runGateFixed },
+        { "guitar-chain", initGuitarChainBench, runGuitarChain, NULL },
+        { "waveshaper", NULL, runWaveshaper, NULL },
+        { "waveshaper-fixed", NULL, NULL, runWaveshaperFixed },
+        { "drive-1x", initDrive1x, runDrive, NULL },
+        { "drive-2x", initDrive2x, runDrive, NULL },
+        { "drive-4x", initDrive4x, runDrive, NULL },
+        { "drive-8x", initDrive8x, runDrive, NULL },
+        { "drive-1x-adaa", initDrive1xAdaa, runDrive, NULL },
+        { "drive-2x-adaa", initDrive2xAdaa, runDrive, NULL },
+        { "drive-4x-adaa", initDrive4xAdaa, runDrive, NULL },
+        { "drive-8x-adaa", initDrive8xAdaa, runDrive, NULL },
+};
+
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_CYCLES 1
+#else
+/// Without a cycle counter the cycles columns read n/a
+#define HAVE_CYCLES 0
+#endif
+
+static unsigned long long cycles(void)
+{
+#if HAVE_CYCLES
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void runBenchmark(const struct Benchmark* b, unsigned frames)
+{
+    if (b->init) {
+        b->init();
+    }
+
+    FloatAudioBuffer out;
+    AudioBuffer fixedOut;
+    float checksum = 0;
+    const unsigned sweepFrames = frames / 2 ? frames / 2 : 1;
+
+    const double start = now();
+    const unsigned long long startCycles = cycles();
+    for (unsigned f = 0; f < frames; f++) {
+        // Triangle sweep 0..1..0 over the run
+        const float sweep = f < sweepFrames ? (float)f / sweepFrames :
+                2.0f - (float)f / sweepFrames;
+        if (b->processFixed) {
+            b->processFixed(&intSignal[f % SIGNAL_FRAMES], &fixedOut, sweep);
+            checksum += fixedOut.m[f % (2 * CODEC_SAMPLES_PER_FRAME)];
+        }
+        else {
+            b->process(&signal[f % SIGNAL_FRAMES], &out, sweep);
+            checksum += out.m[f % (2 * CODEC_SAMPLES_PER_FRAME)];
+        }
+    }
+    const unsigned long long totalCycles = cycles() - startCycles;
+    const double elapsed = now() - start;
+
+    const double nsPerFrame = 1e9 * elapsed / frames;
+    const double cyclesPerSample = (double)totalCycles /
+            ((double)frames * CODEC_SAMPLES_PER_FRAME);
+    const double budget = 100 * nsPerFrame / FRAME_BUDGET_NS;
+    char cyclesText[16] = "n/a";
+    if (HAVE_CYCLES) {
+        snprintf(cyclesText, sizeof(cyclesText), "%.2f", cyclesPerSample);
+    }
+
+    printf("%s,%u,%.1f,%s,%.3f,%g\n", b->name, frames, nsPerFrame,
+            cyclesText, budget, checksum);
+    fprintf(stderr, "%-18s %10.1f ns/frame %8s cycles/sample %7.3f %% of budget\n",
+            b->name, nsPerFrame, cyclesText, budget);
+}
+
+int main(int argc, char** argv)
+{
+    unsigned frames = DEFAULT_FRAMES;
+    int first = 1;
+    if (argc > 2 && !strcmp(argv[1], "-n")) {
+        frames = strtoul(argv[2], NULL, 0);
+        first = 3;
+    }
+    if (frames == 0) {
+        fprintf(stderr, "Usage: %s [-n frames] [name...]\n", argv[0]);
+        return 1;
+    }
+
+    makeSignal();
+
+    fprintf(stderr, "%u frames of %u samples at %u Hz, budget %.0f ns/frame\n",
+            frames, CODEC_SAMPLES_PER_FRAME, CODEC_SAMPLERATE, FRAME_BUDGET_NS);
+    printf("name,frames,ns_per_frame,cycles_per_sample,budget_percent,checksum\n");
+
+    const size_t count = sizeof(benchmarks)/sizeof(*benchmarks);
+    for (size_t i = 0; i < count; i++) {
+        bool selected = first >= argc;
+        for (int a = first; a < argc; a++) {
+            if (!strcmp(argv[a], benchmarks[i].name)) {
+                selected = true;
+            }
+        }
+        if (selected) {
+            runBenchmark(&benchmarks[i], frames);
+        }
+    }
+
+    return 0;
+}
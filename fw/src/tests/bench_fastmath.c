@@ -0,0 +1,211 @@
+/*
+ * Accuracy and speed of the functions in dsp/fastmath.h against libm. Builds
+ * for every platform, so that the speedup can be measured on the Cortex-M4 as
+ * well as on the host.
+ *
+ * The error is the largest difference to libm in double precision over a grid
+ * of inputs across the range used, relative to the exact value for fastExp2()
+ * and absolute for the others. The time is that of a loop over the same
+ * inputs, per call, in cycles of cycleCounter(), which counts nanoseconds on
+ * host. The phasor is timed per step, against a sinf() per step.
+ *
+ * Results go to stdout as CSV and a readable summary goes to stderr, like
+ * bench_dsp. On target they are printed over and over.
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "dsp/fastmath.h"
+#include "platform.h"
+#include "codec.h"
+#include "utils.h"
+
+#define INPUTS 4096
+#define RUNS 16
+#define PHASOR_STEPS 64
+
+static float inputs[INPUTS];
+static volatile float sink;
+
+/// Inputs evenly spread from lo to hi, or logarithmically if geometric
+static void makeInputs(float lo, float hi, bool geometric)
+{
+    for (unsigned i = 0; i < INPUTS; i++) {
+        const double t = (double)i / (INPUTS - 1);
+        inputs[i] = geometric ? lo * pow(hi / lo, t) : lo + (hi - lo) * t;
+    }
+}
+
+/**
+ * Make a loop applying a function to all inputs, with the function a constant
+ * so that the fast ones are inlined like in the effects
+ */
+#define FUNCTION_LOOP(name, function) \
+    static void name(void) \
+    { \
+        float sum = 0.0f; \
+        for (unsigned i = 0; i < INPUTS; i++) { \
+            sum += function(inputs[i]); \
+        } \
+        sink = sum; \
+    }
+
+FUNCTION_LOOP(loopExp2f, exp2f)
+FUNCTION_LOOP(loopFastExp2, fastExp2)
+FUNCTION_LOOP(loopLog2f, log2f)
+FUNCTION_LOOP(loopFastLog2, fastLog2)
+FUNCTION_LOOP(loopSinf, sinf)
+FUNCTION_LOOP(loopFastSin, fastSin)
+FUNCTION_LOOP(loopCosf, cosf)
+FUNCTION_LOOP(loopFastCos, fastCos)
+FUNCTION_LOOP(loopTanhf, tanhf)
+FUNCTION_LOOP(loopFastTanh, fastTanh)
+
+static float (*const fastFunctions[])(float) = {
+    fastExp2, fastLog2, fastSin, fastCos, fastTanh
+};
+
+struct Function {
+    const char* name;
+    float lo, hi;
+    bool geometric;
+    bool relative; ///< Error relative to the exact value
+    double (*exact)(double);
+    void (*libmLoop)(void);
+    void (*fastLoop)(void);
+};
+
+static const struct Function functions[] = {
+    { "exp2", -20, 20, false, true, exp2, loopExp2f, loopFastExp2 },
+    { "log2", 1e-6f, 1e6f, true, false, log2, loopLog2f, loopFastLog2 },
+    { "sin", -M_PI, M_PI, false, false, sin, loopSinf, loopFastSin },
+    { "cos", -M_PI, M_PI, false, false, cos, loopCosf, loopFastCos },
+    { "tanh", -8, 8, false, false, tanh, loopTanhf, loopFastTanh },
+};
+#define FUNCTION_COUNT (sizeof(functions)/sizeof(*functions))
+
+/// Fastest run of a loop over the inputs, per call
+static float timeLoop(void (*loop)(void), unsigned calls)
+{
+    uint32_t best = UINT32_MAX;
+    for (unsigned r = 0; r < RUNS; r++) {
+        const uint32_t start = cycleCounter();
+        loop();
+        const uint32_t cycles = cycleCounter() - start;
+        if (cycles < best) {
+            best = cycles;
+        }
+    }
+    return (float)best / calls;
+}
+
+static void report(const char* name, float libmCycles, float fastCycles,
+        double error)
+{
+    printf("%s,%.1f,%.1f,%.2f,%.3g\n", name, libmCycles, fastCycles,
+            libmCycles / fastCycles, error);
+    fprintf(stderr, "%-8s libm %7.1f fast %7.1f cycles/call  %5.2fx  "
+            "max error %.3g\n", name, libmCycles, fastCycles,
+            libmCycles / fastCycles, error);
+}
+
+static void benchFunction(unsigned f)
+{
+    const struct Function* fn = &functions[f];
+    makeInputs(fn->lo, fn->hi, fn->geometric);
+
+    double maxError = 0;
+    for (unsigned i = 0; i < INPUTS; i++) {
+        // Also between the inputs, to fall between table entries
+        for (unsigned j = 0; j < 16; j++) {
+            const float x = i + 1 < INPUTS ?
+                    inputs[i] + (inputs[i+1] - inputs[i]) * j / 16 : inputs[i];
+            const double exact = fn->exact(x);
+            double error = fabs(fastFunctions[f](x) - exact);
+            if (fn->relative) {
+                error /= fabs(exact);
+            }
+            maxError = fmax(maxError, error);
+        }
+    }
+
+    report(fn->name, timeLoop(fn->libmLoop, INPUTS),
+            timeLoop(fn->fastLoop, INPUTS), maxError);
+}
+
+static float lfoStep;
+
+/// Steps of an LFO computing the sine of the phase every sample
+static void loopSinfSteps(void)
+{
+    float phase = 0.0f;
+    float sum = 0.0f;
+    for (unsigned i = 0; i < INPUTS; i++) {
+        sum += sinf(phase);
+        phase += lfoStep;
+        if (phase >= M_PI) {
+            phase -= 2 * M_PI;
+        }
+    }
+    sink = sum;
+}
+
+/// The same LFO with a phasor set up every PHASOR_STEPS, like once per frame
+static void loopPhasorSteps(void)
+{
+    float sum = 0.0f;
+    for (unsigned i = 0; i < INPUTS; i += PHASOR_STEPS) {
+        Phasor p;
+        phasorInit(&p, i * lfoStep, lfoStep);
+        for (unsigned s = 0; s < PHASOR_STEPS; s++) {
+            sum += p.sin;
+            phasorStep(&p);
+        }
+    }
+    sink = sum;
+}
+
+static void benchPhasor(void)
+{
+    // A fast vibrato at 48 kHz, 10 Hz
+    lfoStep = 2 * M_PI * 10 / 48000;
+
+    double maxError = 0;
+    for (unsigned run = 0; run < 1000; run++) {
+        const double start = -M_PI + run * (2 * M_PI / 1000);
+        Phasor p;
+        phasorInit(&p, start, lfoStep);
+        for (unsigned s = 0; s < PHASOR_STEPS; s++) {
+            maxError = fmax(maxError, fabs(p.sin - sin(start + s * (double)lfoStep)));
+            phasorStep(&p);
+        }
+    }
+
+    report("phasor", timeLoop(loopSinfSteps, INPUTS),
+            timeLoop(loopPhasorSteps, INPUTS), maxError);
+}
+
+static void runAll(void)
+{
+    printf("function,libm_cycles,fast_cycles,speedup,max_error\n");
+    for (unsigned f = 0; f < FUNCTION_COUNT; f++) {
+        benchFunction(f);
+    }
+    benchPhasor();
+}
+
+int main()
+{
+    platformInit(NULL);
+
+#ifdef HOST
+    runAll();
+#else
+    while (true) {
+        runAll();
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,228 @@
+/*
+ * Speed and accuracy of the FFT backend linked in, see dsp/fft.h. The build
+ * links this once with each backend, so that running all of them compares
+ * the backends.
+ *
+ * For each size the complex transform and the real forward and inverse
+ * transforms are timed over random input, taking the fastest of a few
+ * batches. The accuracy is the largest error
+ * of each transform against a DFT in double precision, relative to the
+ * largest output. The real inverse transform is checked on the spectrum of
+ * the real forward one.
+ *
+ * Results go to stdout as CSV and a readable summary goes to stderr, like
+ * bench_dsp.
+ *
+ * Usage: bench_fft_<backend>.elf [-n transforms]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dsp/fft.h"
+
+#define DEFAULT_TRANSFORMS 20000
+#define MAX_SIZE 2048
+#define BATCHES 10
+
+static const unsigned sizes[] = { 64, 128, 256, 512, 1024, 2048 };
+#define SIZE_COUNT (sizeof(sizes)/sizeof(*sizes))
+
+static kiss_fft_cpx input[MAX_SIZE];
+static kiss_fft_cpx output[MAX_SIZE];
+static float realBuffer[MAX_SIZE];
+static float realOutput[MAX_SIZE];
+static uint8_t forwardMemory[FFT_KISS_MEMORY(2 * MAX_SIZE)];
+static uint8_t inverseMemory[FFT_KISS_MEMORY(2 * MAX_SIZE)];
+static kiss_fft_cfg complexCfg;
+static kiss_fftr_cfg forwardCfg;
+static kiss_fftr_cfg inverseCfg;
+
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/**
+ * Largest error of the transform in output against a direct DFT of input,
+ * relative to the largest output
+ */
+static double dftError(unsigned n)
+{
+    const double pi = 3.14159265358979323846;
+    double maxError = 0;
+    double maxValue = 0;
+    for (unsigned k = 0; k < n; k++) {
+        double re = 0, im = 0;
+        for (unsigned t = 0; t < n; t++) {
+            const double phase = -2 * pi * (double)((k * t) % n) / n;
+            re += input[t].r * cos(phase) - input[t].i * sin(phase);
+            im += input[t].r * sin(phase) + input[t].i * cos(phase);
+        }
+        maxError = fmax(maxError, hypot(re - output[k].r, im - output[k].i));
+        maxValue = fmax(maxValue, hypot(re, im));
+    }
+    return maxError / maxValue;
+}
+
+/**
+ * Largest error of the real transform in output against a direct DFT of
+ * realBuffer, over the bins it gives, relative to the largest output
+ */
+static double realDftError(unsigned n)
+{
+    const double pi = 3.14159265358979323846;
+    double maxError = 0;
+    double maxValue = 0;
+    for (unsigned k = 0; k <= n / 2; k++) {
+        double re = 0, im = 0;
+        for (unsigned t = 0; t < n; t++) {
+            const double phase = -2 * pi * (double)((k * t) % n) / n;
+            re += realBuffer[t] * cos(phase);
+            im += realBuffer[t] * sin(phase);
+        }
+        maxError = fmax(maxError, hypot(re - output[k].r, im - output[k].i));
+        maxValue = fmax(maxValue, hypot(re, im));
+    }
+    return maxError / maxValue;
+}
+
+/**
+ * Largest error of the unscaled real inverse transform in realOutput against
+ * a direct inverse DFT of the half spectrum in output, relative to the
+ * largest output. The other half is the complex conjugate.
+ */
+static double realInverseDftError(unsigned n)
+{
+    const double pi = 3.14159265358979323846;
+    double maxError = 0;
+    double maxValue = 0;
+    for (unsigned t = 0; t < n; t++) {
+        double v = output[0].r + (t % 2 ? -output[n/2].r : output[n/2].r);
+        for (unsigned k = 1; k < n / 2; k++) {
+            const double phase = 2 * pi * (double)((k * t) % n) / n;
+            v += 2 * (output[k].r * cos(phase) - output[k].i * sin(phase));
+        }
+        maxError = fmax(maxError, fabs(v - realOutput[t]));
+        maxValue = fmax(maxValue, fabs(v));
+    }
+    return maxError / maxValue;
+}
+
+/**
+ * Time per transform of the fastest of a few batches, which is the least
+ * disturbed by whatever else runs on the host
+ */
+static double fastest(void (*run)(unsigned n, unsigned count), unsigned n,
+        unsigned transforms)
+{
+    const unsigned count = transforms / BATCHES ? transforms / BATCHES : 1;
+    double best = INFINITY;
+    for (unsigned b = 0; b < BATCHES; b++) {
+        const double start = now();
+        run(n, count);
+        best = fmin(best, (now() - start) / count);
+    }
+    return best;
+}
+
+// Each run feeds a little of the output back, so that no transform can be
+// left out
+
+static void runComplex(unsigned n, unsigned count)
+{
+    for (unsigned i = 0; i < count; i++) {
+        kiss_fft(complexCfg, input, output);
+        input[i % n].r += output[i % n].r * 1e-20f;
+    }
+}
+
+static void runReal(unsigned n, unsigned count)
+{
+    for (unsigned i = 0; i < count; i++) {
+        kiss_fftr(forwardCfg, realBuffer, output);
+        realBuffer[i % n] += output[i % (n/2)].r * 1e-20f;
+    }
+}
+
+static void runRealInverse(unsigned n, unsigned count)
+{
+    for (unsigned i = 0; i < count; i++) {
+        kiss_fftri(inverseCfg, output, realBuffer);
+        output[i % (n/2)].i += realBuffer[i % n] * 1e-20f;
+    }
+}
+
+static void report(const char* name, unsigned n, double seconds, double error)
+{
+    const double ns = 1e9 * seconds;
+    printf("%s,%s,%u,%.1f,%g\n", fftBackendName, name, n, ns, error);
+    fprintf(stderr, "%-8s %-8s %5u %10.1f ns/transform  error %.1f dB\n",
+            fftBackendName, name, n, ns, 20 * log10(error));
+}
+
+static void benchSize(unsigned n, unsigned transforms)
+{
+    size_t len = sizeof(forwardMemory);
+    complexCfg = kiss_fft_alloc(n, false, forwardMemory, &len);
+    if (!complexCfg) {
+        fprintf(stderr, "%s: no complex FFT of %u\n", fftBackendName, n);
+        return;
+    }
+    kiss_fft(complexCfg, input, output);
+    const double error = dftError(n);
+    report("complex", n, fastest(runComplex, n, transforms), error);
+
+    len = sizeof(forwardMemory);
+    forwardCfg = kiss_fftr_alloc(n, false, forwardMemory, &len);
+    len = sizeof(inverseMemory);
+    inverseCfg = kiss_fftr_alloc(n, true, inverseMemory, &len);
+    if (!forwardCfg || !inverseCfg) {
+        fprintf(stderr, "%s: no real FFT of %u\n", fftBackendName, n);
+        return;
+    }
+    kiss_fftr(forwardCfg, realBuffer, output);
+    const double realError = realDftError(n);
+    // The DC and Nyquist bins of a real signal are real
+    output[0].i = 0;
+    output[n/2].i = 0;
+    kiss_fftri(inverseCfg, output, realOutput);
+    const double inverseError = realInverseDftError(n);
+    report("real", n, fastest(runReal, n, transforms), realError);
+    report("realinv", n, fastest(runRealInverse, n, transforms), inverseError);
+}
+
+int main(int argc, char** argv)
+{
+    unsigned transforms = DEFAULT_TRANSFORMS;
+    if (argc > 2 && !strcmp(argv[1], "-n")) {
+        transforms = strtoul(argv[2], NULL, 0);
+    }
+    if (transforms == 0) {
+        fprintf(stderr, "Usage: %s [-n transforms]\n", argv[0]);
+        return 1;
+    }
+
+    srand(1);
+    for (unsigned i = 0; i < MAX_SIZE; i++) {
+        input[i].r = (float)rand() / RAND_MAX - 0.5f;
+        input[i].i = (float)rand() / RAND_MAX - 0.5f;
+        realBuffer[i] = (float)rand() / RAND_MAX - 0.5f;
+    }
+
+    printf("backend,transform,size,ns_per_transform,error\n");
+    for (unsigned s = 0; s < SIZE_COUNT; s++) {
+        benchSize(sizes[s], transforms);
+    }
+
+    return 0;
+}
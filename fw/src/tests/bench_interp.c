@@ -0,0 +1,216 @@
+/*
+ * Cost against quality of the delay line interpolation kernels in
+ * dsp/interpolation.h, to pick a kernel for each effect.
+ *
+ * The cost is the time per read from a float delay line at random fractional
+ * positions. The quality is the signal to noise ratio of reading sines of a
+ * few frequencies at fractional delays, where the noise is the difference to
+ * the exact value of the sine in between samples.
+ *
+ * Results go to stdout as CSV and a readable summary goes to stderr, like
+ * bench_dsp.
+ *
+ * Usage: bench_interp.elf [-n reads]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "codec.h"
+#include "dsp/delayline.h"
+#include "utils.h"
+
+#define DEFAULT_READS 20000000
+#define CAPACITY 1024
+#define MASK (CAPACITY - 1)
+#define POSITIONS 4096
+
+/// Range of positions read, well inside the line
+#define FIRST 64
+#define LAST (CAPACITY - 64)
+
+static const float frequencies[] = { 1000, 5000, 10000, 15000, 20000 };
+#define FREQUENCY_COUNT (sizeof(frequencies)/sizeof(*frequencies))
+
+static float line[DELAYLINE_STORAGE(CAPACITY)];
+static float positions[POSITIONS];
+
+/// Run one kernel over the positions, reads times, returning a checksum
+typedef float (*ReadLoop)(unsigned reads);
+
+/**
+ * Make a read loop for a kernel, with the kernel a constant so that its
+ * coefficients are inlined like in the effects
+ */
+#define KERNEL_LOOP(name, kernel) \
+    static float name(unsigned reads) \
+    { \
+        float sum = 0.0f; \
+        for (unsigned i = 0; i < reads; i++) { \
+            sum += delayLineReadInterpFloat(line, MASK, \
+                    positions[i % POSITIONS], kernel); \
+        } \
+        return sum; \
+    }
+
+KERNEL_LOOP(readLinear, INTERP_LINEAR)
+KERNEL_LOOP(readHermite, INTERP_HERMITE)
+KERNEL_LOOP(readLagrange4, INTERP_LAGRANGE4)
+KERNEL_LOOP(readLagrange6, INTERP_LAGRANGE6)
+KERNEL_LOOP(readSinc, INTERP_SINC)
+
+static float readAllpass(unsigned reads)
+{
+    AllpassInterp ap = { 0 };
+    float sum = 0.0f;
+    for (unsigned i = 0; i < reads; i++) {
+        sum += delayLineReadAllpassFloat(line, MASK, positions[i % POSITIONS],
+                &ap);
+    }
+    return sum;
+}
+
+struct Kernel {
+    const char* name;
+    int kernel; ///< Kernel for the quality test, or -1 for the allpass
+    ReadLoop loop;
+};
+
+static const struct Kernel kernels[] = {
+        { "linear", INTERP_LINEAR, readLinear },
+        { "hermite", INTERP_HERMITE, readHermite },
+        { "lagrange4", INTERP_LAGRANGE4, readLagrange4 },
+        { "lagrange6", INTERP_LAGRANGE6, readLagrange6 },
+        { "sinc", INTERP_SINC, readSinc },
+        { "allpass", -1, readAllpass },
+};
+
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_CYCLES 1
+#else
+/// Without a cycle counter the cycles columns read n/a
+#define HAVE_CYCLES 0
+#endif
+
+static unsigned long long cycles(void)
+{
+#if HAVE_CYCLES
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void fillLine(float omega)
+{
+    for (unsigned n = 0; n < CAPACITY; n++) {
+        delayLineWriteFloat(line, MASK, n, sinf(omega * n));
+    }
+}
+
+static float readKernel(const struct Kernel* k, float pos, AllpassInterp* ap)
+{
+    if (k->kernel < 0) {
+        return delayLineReadAllpassFloat(line, MASK, pos, ap);
+    }
+    return delayLineReadInterpFloat(line, MASK, pos, k->kernel);
+}
+
+/**
+ * Signal to noise ratio in dB of reading a sine at fractional positions.
+ * Positions are read in order for each fraction, as a read head with a fixed
+ * delay does, which the allpass depends on.
+ */
+static double measureSnr(const struct Kernel* k, float frequency)
+{
+    const float omega = 2 * M_PI * frequency / CODEC_SAMPLERATE;
+    fillLine(omega);
+
+    double signal = 0.0;
+    double noise = 0.0;
+    for (unsigned f = 0; f < 16; f++) {
+        const float frac = (f + 0.5f) / 16;
+        AllpassInterp ap = { 0 };
+        for (unsigned n = FIRST; n < LAST; n++) {
+            const float v = readKernel(k, n + frac, &ap);
+            // Let the allpass settle
+            if (n < FIRST + 32) {
+                continue;
+            }
+            const double exact = sin((double)omega * (n + frac));
+            signal += exact * exact;
+            noise += (v - exact) * (v - exact);
+        }
+    }
+    return 10 * log10(signal / (noise > 1e-30 ? noise : 1e-30));
+}
+
+int main(int argc, char** argv)
+{
+    unsigned reads = DEFAULT_READS;
+    if (argc > 2 && !strcmp(argv[1], "-n")) {
+        reads = strtoul(argv[2], NULL, 0);
+    }
+    if (reads == 0) {
+        fprintf(stderr, "Usage: %s [-n reads]\n", argv[0]);
+        return 1;
+    }
+
+    unsigned seed = 1;
+    for (unsigned i = 0; i < POSITIONS; i++) {
+        seed = seed * 1103515245 + 12345;
+        positions[i] = FIRST + (float)(seed >> 8) / (1 << 24) * (LAST - FIRST);
+    }
+
+    fprintf(stderr, "%u reads per kernel, SNR of sines at %u Hz\n", reads,
+            CODEC_SAMPLERATE);
+    printf("name,taps,ns_per_read,cycles_per_read,checksum");
+    for (unsigned f = 0; f < FREQUENCY_COUNT; f++) {
+        printf(",snr_%.0f", frequencies[f]);
+    }
+    printf("\n");
+
+    const size_t count = sizeof(kernels)/sizeof(*kernels);
+    for (size_t i = 0; i < count; i++) {
+        const struct Kernel* k = &kernels[i];
+        const unsigned taps = k->kernel < 0 ? 2 : INTERP_TAPS(k->kernel);
+
+        fillLine(0.1f);
+        const double start = now();
+        const unsigned long long startCycles = cycles();
+        const float checksum = k->loop(reads);
+        const unsigned long long totalCycles = cycles() - startCycles;
+        const double nsPerRead = 1e9 * (now() - start) / reads;
+        const double cyclesPerRead = (double)totalCycles / reads;
+        char cyclesText[16] = "n/a";
+        if (HAVE_CYCLES) {
+            snprintf(cyclesText, sizeof(cyclesText), "%.2f", cyclesPerRead);
+        }
+
+        printf("%s,%u,%.2f,%s,%g", k->name, taps, nsPerRead, cyclesText,
+                checksum);
+        fprintf(stderr, "%-10s %u taps %6.2f ns/read %6s cycles/read  SNR",
+                k->name, taps, nsPerRead, cyclesText);
+        for (unsigned f = 0; f < FREQUENCY_COUNT; f++) {
+            const double snr = measureSnr(k, frequencies[f]);
+            printf(",%.1f", snr);
+            fprintf(stderr, " %5.1f", snr);
+        }
+        printf("\n");
+        fprintf(stderr, " dB\n");
+    }
+
+    return 0;
+}
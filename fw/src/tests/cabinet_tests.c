@@ -0,0 +1,127 @@
+/*
+ * Checks the partitioned convolution of the cabinet simulation against a
+ * direct convolution in double precision. Noise is run through impulse
+ * responses of several lengths: shorter than a partition, so that only the
+ * direct part runs, a partition and a sample, a few partitions, the default
+ * response and the longest one that can be loaded. The error is the largest
+ * difference from the direct convolution, relative to the largest output.
+ *
+ * The partitions are a frame long, so the offline makefile builds and runs
+ * this once for each of a few frame sizes with make -f offline.mk test.
+ *
+ * Results go to stdout as CSV and a readable summary goes to stderr, like
+ * bench_dsp. The exit status is nonzero if any error is above
+ * MAX_ERROR_DB.
+ *
+ * Usage: cabinet_tests.elf
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "codec.h"
+#include "dsp/cabinet.h"
+#include "cabinet_ir.h"
+
+/// Largest error allowed, relative to the largest output
+#define MAX_ERROR_DB -100.0
+
+/// Input past the end of the longest impulse response, so that every
+/// partition sees a full frame of input
+#define INPUT_FRAMES (CABINET_MAX_IR / CODEC_SAMPLES_PER_FRAME + 8)
+#define INPUT_SAMPLES (INPUT_FRAMES * CODEC_SAMPLES_PER_FRAME)
+
+static CabinetState cabinet;
+static float ir[CABINET_MAX_IR];
+static float input[2][INPUT_SAMPLES];
+
+/**
+ * Largest error of processCabinet() with the impulse response loaded
+ * against a direct convolution, relative to the largest output
+ */
+static double convolutionError(unsigned length)
+{
+    double maxError = 0;
+    double maxValue = 0;
+    for (unsigned f = 0; f < INPUT_FRAMES; f++) {
+        FloatAudioBuffer buffer;
+        for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+            buffer.s[s][0] = input[0][f * CODEC_SAMPLES_PER_FRAME + s];
+            buffer.s[s][1] = input[1][f * CODEC_SAMPLES_PER_FRAME + s];
+        }
+        processCabinet(&buffer, &buffer, &cabinet);
+
+        for (unsigned s = 0; s < CODEC_SAMPLES_PER_FRAME; s++) {
+            const unsigned t = f * CODEC_SAMPLES_PER_FRAME + s;
+            for (unsigned c = 0; c < 2; c++) {
+                double expected = 0;
+                for (unsigned i = 0; i < length && i <= t; i++) {
+                    expected += (double)ir[i] * input[c][t - i];
+                }
+                maxError = fmax(maxError, fabs(buffer.s[s][c] - expected));
+                maxValue = fmax(maxValue, fabs(expected));
+            }
+        }
+    }
+    return maxError / maxValue;
+}
+
+static bool check(const char* name, unsigned length)
+{
+    cabinetLoad(&cabinet, ir, length);
+    const double error = 20 * log10(convolutionError(length));
+    const unsigned partitions =
+            (length + CABINET_PARTITION - 1) / CABINET_PARTITION;
+    const bool pass = error <= MAX_ERROR_DB;
+
+    printf("%s,%u,%u,%u,%.1f\n", name, CODEC_SAMPLES_PER_FRAME, length,
+            partitions, error);
+    fprintf(stderr, "%-10s frame %3u %5u samples %3u partitions  error %6.1f dB%s\n",
+            name, CODEC_SAMPLES_PER_FRAME, length, partitions, error,
+            pass ? "" : "  FAIL");
+    return pass;
+}
+
+static void randomIr(unsigned length)
+{
+    // Decaying noise, roughly like a cabinet
+    for (unsigned i = 0; i < length; i++) {
+        ir[i] = ((float)rand() / RAND_MAX - 0.5f) * expf(-4.0f * i / length);
+    }
+}
+
+int main(void)
+{
+    srand(1);
+    for (unsigned c = 0; c < 2; c++) {
+        for (unsigned i = 0; i < INPUT_SAMPLES; i++) {
+            input[c][i] = 16384 * ((float)rand() / RAND_MAX - 0.5f);
+        }
+    }
+
+    initCabinet(&cabinet);
+
+    printf("ir,frame,length,partitions,error_db\n");
+    bool pass = true;
+    const unsigned lengths[] = {
+        CABINET_PARTITION / 2,
+        CABINET_PARTITION + 1,
+        3 * CABINET_PARTITION + 5,
+        CABINET_MAX_IR
+    };
+    for (unsigned l = 0; l < sizeof(lengths)/sizeof(*lengths); l++) {
+        randomIr(lengths[l]);
+        pass &= check("noise", lengths[l]);
+    }
+
+    const unsigned length = CABINET_DEFAULT_IR_LENGTH < CABINET_MAX_IR ?
+            CABINET_DEFAULT_IR_LENGTH : CABINET_MAX_IR;
+    for (unsigned i = 0; i < length; i++) {
+        ir[i] = cabinetDefaultIr[i];
+    }
+    pass &= check("default", length);
+
+    return pass ? 0 : 1;
+}
@@ -4,7 +4,7 @@
 #include <time.h>
 #include "platform.h"
 #include "codec.h"
-#include "window.h"
+#include "dsp/tables.h"
 #include <tools/kiss_fftr.h>
 
 #ifndef HOST
@@ -104,13 +104,13 @@ static void doFft()
     };
 
     setLed(LED_GREEN, true);
-    // Apply a Hann window. The function includes a correction factor
-    // to remove the attenuation in the window.
+    // Apply a Hann window, doubled as a correction factor to remove the
+    // attenuation in the window.
     for (unsigned n = 0; n < N; n++) {
-        (in[0])[n] *= hannWindow[n];
+        (in[0])[n] *= 2 * WINDOW_HANN(N)[n];
     }
     for (unsigned n = 0; n < N; n++) {
-        (in[1])[n] *= hannWindow[n];
+        (in[1])[n] *= 2 * WINDOW_HANN(N)[n];
     }
 
     kiss_fftr(fftCfg, in[0], transform[0]);
@@ -1,2051 +0,0 @@
-// 2048 point Hann window
-static const float hannWindow[2048] = {
-    0.000000,
-    0.000005,
-    0.000019,
-    0.000042,
-    0.000075,
-    0.000118,
-    0.000170,
-    0.000231,
-    0.000301,
-    0.000382,
-    0.000471,
-    0.000570,
-    0.000678,
-    0.000796,
-    0.000923,
-    0.001060,
-    0.001206,
-    0.001361,
-    0.001526,
-    0.001700,
-    0.001884,
-    0.002077,
-    0.002279,
-    0.002491,
-    0.002712,
-    0.002943,
-    0.003183,
-    0.003432,
-    0.003691,
-    0.003959,
-    0.004237,
-    0.004524,
-    0.004820,
-    0.005126,
-    0.005441,
-    0.005765,
-    0.006099,
-    0.006442,
-    0.006795,
-    0.007157,
-    0.007528,
-    0.007908,
-    0.008298,
-    0.008698,
-    0.009106,
-    0.009524,
-    0.009951,
-    0.010388,
-    0.010834,
-    0.011289,
-    0.011754,
-    0.012228,
-    0.012711,
-    0.013203,
-    0.013705,
-    0.014216,
-    0.014737,
-    0.015266,
-    0.015805,
-    0.016354,
-    0.016911,
-    0.017478,
-    0.018054,
-    0.018639,
-    0.019233,
-    0.019837,
-    0.020450,
-    0.021072,
-    0.021704,
-    0.022344,
-    0.022994,
-    0.023653,
-    0.024322,
-    0.024999,
-    0.025686,
-    0.026381,
-    0.027086,
-    0.027801,
-    0.028524,
-    0.029256,
-    0.029998,
-    0.030749,
-    0.031509,
-    0.032278,
-    0.033056,
-    0.033843,
-    0.034639,
-    0.035445,
-    0.036259,
-    0.037083,
-    0.037915,
-    0.038757,
-    0.039608,
-    0.040468,
-    0.041337,
-    0.042215,
-    0.043101,
-    0.043997,
-    0.044902,
-    0.045816,
-    0.046739,
-    0.047671,
-    0.048612,
-    0.049562,
-    0.050521,
-    0.051488,
-    0.052465,
-    0.053451,
-    0.054445,
-    0.055449,
-    0.056461,
-    0.057482,
-    0.058512,
-    0.059551,
-    0.060599,
-    0.061656,
-    0.062722,
-    0.063796,
-    0.064879,
-    0.065971,
-    0.067072,
-    0.068182,
-    0.069300,
-    0.070427,
-    0.071563,
-    0.072708,
-    0.073861,
-    0.075023,
-    0.076194,
-    0.077373,
-    0.078562,
-    0.079759,
-    0.080964,
-    0.082178,
-    0.083401,
-    0.084633,
-    0.085873,
-    0.087122,
-    0.088379,
-    0.089645,
-    0.090919,
-    0.092202,
-    0.093494,
-    0.094794,
-    0.096103,
-    0.097420,
-    0.098746,
-    0.100080,
-    0.101423,
-    0.102774,
-    0.104134,
-    0.105502,
-    0.106878,
-    0.108263,
-    0.109656,
-    0.111058,
-    0.112468,
-    0.113887,
-    0.115313,
-    0.116748,
-    0.118192,
-    0.119644,
-    0.121104,
-    0.122572,
-    0.124048,
-    0.125533,
-    0.127026,
-    0.128528,
-    0.130037,
-    0.131555,
-    0.133081,
-    0.134615,
-    0.136157,
-    0.137707,
-    0.139266,
-    0.140832,
-    0.142407,
-    0.143990,
-    0.145581,
-    0.147179,
-    0.148786,
-    0.150401,
-    0.152024,
-    0.153655,
-    0.155294,
-    0.156941,
-    0.158596,
-    0.160258,
-    0.161929,
-    0.163608,
-    0.165294,
-    0.166988,
-    0.168690,
-    0.170400,
-    0.172118,
-    0.173844,
-    0.175577,
-    0.177318,
-    0.179067,
-    0.180824,
-    0.182588,
-    0.184360,
-    0.186140,
-    0.187927,
-    0.189722,
-    0.191525,
-    0.193335,
-    0.195153,
-    0.196978,
-    0.198811,
-    0.200652,
-    0.202500,
-    0.204356,
-    0.206219,
-    0.208089,
-    0.209967,
-    0.211853,
-    0.213746,
-    0.215646,
-    0.217554,
-    0.219469,
-    0.221391,
-    0.223321,
-    0.225258,
-    0.227203,
-    0.229154,
-    0.231113,
-    0.233079,
-    0.235053,
-    0.237033,
-    0.239021,
-    0.241016,
-    0.243018,
-    0.245028,
-    0.247044,
-    0.249067,
-    0.251098,
-    0.253136,
-    0.255180,
-    0.257232,
-    0.259290,
-    0.261356,
-    0.263429,
-    0.265508,
-    0.267595,
-    0.269688,
-    0.271788,
-    0.273895,
-    0.276009,
-    0.278130,
-    0.280258,
-    0.282392,
-    0.284533,
-    0.286681,
-    0.288835,
-    0.290997,
-    0.293165,
-    0.295339,
-    0.297520,
-    0.299708,
-    0.301903,
-    0.304104,
-    0.306311,
-    0.308525,
-    0.310746,
-    0.312973,
-    0.315207,
-    0.317447,
-    0.319693,
-    0.321946,
-    0.324206,
-    0.326471,
-    0.328743,
-    0.331021,
-    0.333306,
-    0.335597,
-    0.337894,
-    0.340198,
-    0.342507,
-    0.344823,
-    0.347145,
-    0.349473,
-    0.351807,
-    0.354148,
-    0.356494,
-    0.358847,
-    0.361205,
-    0.363570,
-    0.365940,
-    0.368317,
-    0.370699,
-    0.373088,
-    0.375482,
-    0.377882,
-    0.380289,
-    0.382700,
-    0.385118,
-    0.387542,
-    0.389971,
-    0.392406,
-    0.394847,
-    0.397293,
-    0.399745,
-    0.402203,
-    0.404667,
-    0.407136,
-    0.409610,
-    0.412091,
-    0.414576,
-    0.417068,
-    0.419564,
-    0.422067,
-    0.424574,
-    0.427087,
-    0.429606,
-    0.432130,
-    0.434659,
-    0.437193,
-    0.439733,
-    0.442278,
-    0.444829,
-    0.447384,
-    0.449945,
-    0.452511,
-    0.455082,
-    0.457658,
-    0.460240,
-    0.462826,
-    0.465418,
-    0.468014,
-    0.470616,
-    0.473222,
-    0.475834,
-    0.478450,
-    0.481072,
-    0.483698,
-    0.486329,
-    0.488965,
-    0.491606,
-    0.494252,
-    0.496902,
-    0.499557,
-    0.502217,
-    0.504881,
-    0.507550,
-    0.510224,
-    0.512903,
-    0.515586,
-    0.518273,
-    0.520965,
-    0.523662,
-    0.526363,
-    0.529069,
-    0.531779,
-    0.534493,
-    0.537212,
-    0.539935,
-    0.542662,
-    0.545394,
-    0.548130,
-    0.550871,
-    0.553615,
-    0.556364,
-    0.559117,
-    0.561874,
-    0.564635,
-    0.567401,
-    0.570170,
-    0.572944,
-    0.575721,
-    0.578503,
-    0.581288,
-    0.584077,
-    0.586871,
-    0.589668,
-    0.592469,
-    0.595274,
-    0.598083,
-    0.600895,
-    0.603711,
-    0.606531,
-    0.609355,
-    0.612183,
-    0.615014,
-    0.617848,
-    0.620687,
-    0.623528,
-    0.626374,
-    0.629223,
-    0.632075,
-    0.634931,
-    0.637790,
-    0.640653,
-    0.643519,
-    0.646389,
-    0.649262,
-    0.652138,
-    0.655017,
-    0.657900,
-    0.660786,
-    0.663675,
-    0.666567,
-    0.669462,
-    0.672361,
-    0.675262,
-    0.678167,
-    0.681075,
-    0.683985,
-    0.686899,
-    0.689816,
-    0.692735,
-    0.695657,
-    0.698583,
-    0.701511,
-    0.704442,
-    0.707376,
-    0.710312,
-    0.713251,
-    0.716193,
-    0.719138,
-    0.722085,
-    0.725035,
-    0.727987,
-    0.730942,
-    0.733900,
-    0.736860,
-    0.739822,
-    0.742787,
-    0.745755,
-    0.748724,
-    0.751697,
-    0.754671,
-    0.757648,
-    0.760627,
-    0.763608,
-    0.766592,
-    0.769578,
-    0.772566,
-    0.775556,
-    0.778548,
-    0.781542,
-    0.784539,
-    0.787537,
-    0.790537,
-    0.793540,
-    0.796544,
-    0.799550,
-    0.802558,
-    0.805568,
-    0.808580,
-    0.811594,
-    0.814609,
-    0.817626,
-    0.820645,
-    0.823666,
-    0.826688,
-    0.829712,
-    0.832737,
-    0.835764,
-    0.838793,
-    0.841823,
-    0.844854,
-    0.847887,
-    0.850922,
-    0.853957,
-    0.856995,
-    0.860033,
-    0.863073,
-    0.866114,
-    0.869157,
-    0.872200,
-    0.875245,
-    0.878291,
-    0.881339,
-    0.884387,
-    0.887436,
-    0.890487,
-    0.893538,
-    0.896591,
-    0.899644,
-    0.902699,
-    0.905754,
-    0.908810,
-    0.911868,
-    0.914925,
-    0.917984,
-    0.921044,
-    0.924104,
-    0.927165,
-    0.930227,
-    0.933289,
-    0.936352,
-    0.939415,
-    0.942479,
-    0.945544,
-    0.948609,
-    0.951675,
-    0.954741,
-    0.957807,
-    0.960874,
-    0.963942,
-    0.967009,
-    0.970077,
-    0.973145,
-    0.976214,
-    0.979283,
-    0.982352,
-    0.985421,
-    0.988490,
-    0.991559,
-    0.994628,
-    0.997698,
-    1.000767,
-    1.003837,
-    1.006906,
-    1.009976,
-    1.013045,
-    1.016114,
-    1.019183,
-    1.022252,
-    1.025320,
-    1.028389,
-    1.031457,
-    1.034525,
-    1.037592,
-    1.040659,
-    1.043726,
-    1.046792,
-    1.049858,
-    1.052923,
-    1.055988,
-    1.059053,
-    1.062117,
-    1.065180,
-    1.068242,
-    1.071304,
-    1.074366,
-    1.077426,
-    1.080486,
-    1.083545,
-    1.086604,
-    1.089661,
-    1.092718,
-    1.095774,
-    1.098829,
-    1.101882,
-    1.104935,
-    1.107987,
-    1.111038,
-    1.114088,
-    1.117137,
-    1.120185,
-    1.123232,
-    1.126277,
-    1.129321,
-    1.132365,
-    1.135406,
-    1.138447,
-    1.141486,
-    1.144524,
-    1.147561,
-    1.150596,
-    1.153630,
-    1.156662,
-    1.159693,
-    1.162722,
-    1.165750,
-    1.168776,
-    1.171801,
-    1.174824,
-    1.177845,
-    1.180865,
-    1.183883,
-    1.186899,
-    1.189913,
-    1.192926,
-    1.195937,
-    1.198946,
-    1.201953,
-    1.204958,
-    1.207962,
-    1.210963,
-    1.213962,
-    1.216960,
-    1.219955,
-    1.222948,
-    1.225940,
-    1.228929,
-    1.231915,
-    1.234900,
-    1.237883,
-    1.240863,
-    1.243841,
-    1.246816,
-    1.249790,
-    1.252761,
-    1.255729,
-    1.258696,
-    1.261659,
-    1.264621,
-    1.267579,
-    1.270536,
-    1.273489,
-    1.276440,
-    1.279389,
-    1.282335,
-    1.285278,
-    1.288219,
-    1.291157,
-    1.294092,
-    1.297024,
-    1.299954,
-    1.302880,
-    1.305804,
-    1.308725,
-    1.311643,
-    1.314558,
-    1.317470,
-    1.320380,
-    1.323286,
-    1.326189,
-    1.329089,
-    1.331986,
-    1.334880,
-    1.337770,
-    1.340658,
-    1.343542,
-    1.346423,
-    1.349301,
-    1.352175,
-    1.355046,
-    1.357914,
-    1.360779,
-    1.363640,
-    1.366497,
-    1.369351,
-    1.372202,
-    1.375049,
-    1.377893,
-    1.380733,
-    1.383569,
-    1.386402,
-    1.389232,
-    1.392057,
-    1.394879,
-    1.397697,
-    1.400512,
-    1.403322,
-    1.406129,
-    1.408932,
-    1.411731,
-    1.414526,
-    1.417318,
-    1.420105,
-    1.422889,
-    1.425668,
-    1.428444,
-    1.431215,
-    1.433983,
-    1.436746,
-    1.439505,
-    1.442260,
-    1.445011,
-    1.447758,
-    1.450500,
-    1.453238,
-    1.455972,
-    1.458702,
-    1.461427,
-    1.464148,
-    1.466865,
-    1.469577,
-    1.472285,
-    1.474988,
-    1.477687,
-    1.480381,
-    1.483071,
-    1.485756,
-    1.488437,
-    1.491113,
-    1.493785,
-    1.496452,
-    1.499114,
-    1.501771,
-    1.504424,
-    1.507072,
-    1.509715,
-    1.512353,
-    1.514987,
-    1.517616,
-    1.520239,
-    1.522858,
-    1.525472,
-    1.528081,
-    1.530686,
-    1.533285,
-    1.535879,
-    1.538468,
-    1.541052,
-    1.543630,
-    1.546204,
-    1.548773,
-    1.551336,
-    1.553894,
-    1.556447,
-    1.558995,
-    1.561537,
-    1.564075,
-    1.566606,
-    1.569133,
-    1.571654,
-    1.574170,
-    1.576680,
-    1.579185,
-    1.581685,
-    1.584179,
-    1.586667,
-    1.589150,
-    1.591628,
-    1.594099,
-    1.596566,
-    1.599026,
-    1.601481,
-    1.603931,
-    1.606374,
-    1.608812,
-    1.611244,
-    1.613671,
-    1.616091,
-    1.618506,
-    1.620915,
-    1.623318,
-    1.625716,
-    1.628107,
-    1.630493,
-    1.632872,
-    1.635246,
-    1.637613,
-    1.639975,
-    1.642330,
-    1.644680,
-    1.647023,
-    1.649361,
-    1.651692,
-    1.654017,
-    1.656336,
-    1.658648,
-    1.660955,
-    1.663255,
-    1.665549,
-    1.667837,
-    1.670118,
-    1.672394,
-    1.674662,
-    1.676925,
-    1.679181,
-    1.681431,
-    1.683674,
-    1.685911,
-    1.688141,
-    1.690365,
-    1.692582,
-    1.694793,
-    1.696998,
-    1.699195,
-    1.701386,
-    1.703571,
-    1.705749,
-    1.707920,
-    1.710085,
-    1.712243,
-    1.714394,
-    1.716538,
-    1.718676,
-    1.720807,
-    1.722931,
-    1.725049,
-    1.727159,
-    1.729263,
-    1.731360,
-    1.733449,
-    1.735532,
-    1.737608,
-    1.739678,
-    1.741740,
-    1.743795,
-    1.745843,
-    1.747884,
-    1.749918,
-    1.751945,
-    1.753965,
-    1.755978,
-    1.757984,
-    1.759982,
-    1.761974,
-    1.763958,
-    1.765935,
-    1.767905,
-    1.769867,
-    1.771822,
-    1.773771,
-    1.775711,
-    1.777645,
-    1.779571,
-    1.781490,
-    1.783401,
-    1.785305,
-    1.787202,
-    1.789091,
-    1.790973,
-    1.792847,
-    1.794714,
-    1.796573,
-    1.798425,
-    1.800269,
-    1.802106,
-    1.803935,
-    1.805757,
-    1.807571,
-    1.809378,
-    1.811177,
-    1.812968,
-    1.814751,
-    1.816527,
-    1.818295,
-    1.820056,
-    1.821808,
-    1.823553,
-    1.825291,
-    1.827020,
-    1.828742,
-    1.830456,
-    1.832162,
-    1.833860,
-    1.835550,
-    1.837233,
-    1.838907,
-    1.840574,
-    1.842233,
-    1.843884,
-    1.845526,
-    1.847161,
-    1.848788,
-    1.850407,
-    1.852018,
-    1.853621,
-    1.855216,
-    1.856803,
-    1.858381,
-    1.859952,
-    1.861514,
-    1.863069,
-    1.864615,
-    1.866153,
-    1.867683,
-    1.869205,
-    1.870719,
-    1.872224,
-    1.873721,
-    1.875210,
-    1.876691,
-    1.878163,
-    1.879627,
-    1.881083,
-    1.882531,
-    1.883970,
-    1.885401,
-    1.886824,
-    1.888238,
-    1.889644,
-    1.891041,
-    1.892430,
-    1.893811,
-    1.895183,
-    1.896547,
-    1.897903,
-    1.899250,
-    1.900588,
-    1.901918,
-    1.903239,
-    1.904552,
-    1.905857,
-    1.907153,
-    1.908440,
-    1.909719,
-    1.910989,
-    1.912251,
-    1.913504,
-    1.914748,
-    1.915984,
-    1.917211,
-    1.918430,
-    1.919640,
-    1.920841,
-    1.922034,
-    1.923217,
-    1.924393,
-    1.925559,
-    1.926717,
-    1.927866,
-    1.929006,
-    1.930138,
-    1.931260,
-    1.932374,
-    1.933480,
-    1.934576,
-    1.935664,
-    1.936742,
-    1.937812,
-    1.938873,
-    1.939926,
-    1.940969,
-    1.942004,
-    1.943029,
-    1.944046,
-    1.945054,
-    1.946053,
-    1.947043,
-    1.948024,
-    1.948997,
-    1.949960,
-    1.950914,
-    1.951860,
-    1.952796,
-    1.953723,
-    1.954642,
-    1.955551,
-    1.956452,
-    1.957343,
-    1.958226,
-    1.959099,
-    1.959963,
-    1.960819,
-    1.961665,
-    1.962502,
-    1.963330,
-    1.964149,
-    1.964959,
-    1.965760,
-    1.966552,
-    1.967335,
-    1.968108,
-    1.968873,
-    1.969628,
-    1.970374,
-    1.971111,
-    1.971839,
-    1.972558,
-    1.973267,
-    1.973968,
-    1.974659,
-    1.975341,
-    1.976014,
-    1.976677,
-    1.977332,
-    1.977977,
-    1.978613,
-    1.979240,
-    1.979858,
-    1.980466,
-    1.981065,
-    1.981655,
-    1.982235,
-    1.982807,
-    1.983369,
-    1.983922,
-    1.984465,
-    1.985000,
-    1.985525,
-    1.986040,
-    1.986547,
-    1.987044,
-    1.987532,
-    1.988010,
-    1.988480,
-    1.988939,
-    1.989390,
-    1.989831,
-    1.990263,
-    1.990686,
-    1.991099,
-    1.991503,
-    1.991898,
-    1.992283,
-    1.992659,
-    1.993026,
-    1.993383,
-    1.993731,
-    1.994069,
-    1.994398,
-    1.994718,
-    1.995028,
-    1.995329,
-    1.995621,
-    1.995903,
-    1.996176,
-    1.996440,
-    1.996694,
-    1.996938,
-    1.997174,
-    1.997400,
-    1.997616,
-    1.997823,
-    1.998021,
-    1.998209,
-    1.998388,
-    1.998558,
-    1.998718,
-    1.998868,
-    1.999010,
-    1.999142,
-    1.999264,
-    1.999377,
-    1.999481,
-    1.999575,
-    1.999660,
-    1.999735,
-    1.999801,
-    1.999858,
-    1.999905,
-    1.999942,
-    1.999971,
-    1.999989,
-    1.999999,
-    1.999999,
-    1.999989,
-    1.999971,
-    1.999942,
-    1.999905,
-    1.999858,
-    1.999801,
-    1.999735,
-    1.999660,
-    1.999575,
-    1.999481,
-    1.999377,
-    1.999264,
-    1.999142,
-    1.999010,
-    1.998868,
-    1.998718,
-    1.998558,
-    1.998388,
-    1.998209,
-    1.998021,
-    1.997823,
-    1.997616,
-    1.997400,
-    1.997174,
-    1.996938,
-    1.996694,
-    1.996440,
-    1.996176,
-    1.995903,
-    1.995621,
-    1.995329,
-    1.995028,
-    1.994718,
-    1.994398,
-    1.994069,
-    1.993731,
-    1.993383,
-    1.993026,
-    1.992659,
-    1.992283,
-    1.991898,
-    1.991503,
-    1.991099,
-    1.990686,
-    1.990263,
-    1.989831,
-    1.989390,
-    1.988939,
-    1.988480,
-    1.988010,
-    1.987532,
-    1.987044,
-    1.986547,
-    1.986040,
-    1.985525,
-    1.985000,
-    1.984465,
-    1.983922,
-    1.983369,
-    1.982807,
-    1.982235,
-    1.981655,
-    1.981065,
-    1.980466,
-    1.979858,
-    1.979240,
-    1.978613,
-    1.977977,
-    1.977332,
-    1.976677,
-    1.976014,
-    1.975341,
-    1.974659,
-    1.973968,
-    1.973267,
-    1.972558,
-    1.971839,
-    1.971111,
-    1.970374,
-    1.969628,
-    1.968873,
-    1.968108,
-    1.967335,
-    1.966552,
-    1.965760,
-    1.964959,
-    1.964149,
-    1.963330,
-    1.962502,
-    1.961665,
-    1.960819,
-    1.959963,
-    1.959099,
-    1.958226,
-    1.957343,
-    1.956452,
-    1.955551,
-    1.954642,
-    1.953723,
-    1.952796,
-    1.951860,
-    1.950914,
-    1.949960,
-    1.948997,
-    1.948024,
-    1.947043,
-    1.946053,
-    1.945054,
-    1.944046,
-    1.943029,
-    1.942004,
-    1.940969,
-    1.939926,
-    1.938873,
-    1.937812,
-    1.936742,
-    1.935664,
-    1.934576,
-    1.933480,
-    1.932374,
-    1.931260,
-    1.930138,
-    1.929006,
-    1.927866,
-    1.926717,
-    1.925559,
-    1.924393,
-    1.923217,
-    1.922034,
-    1.920841,
-    1.919640,
-    1.918430,
-    1.917211,
-    1.915984,
-    1.914748,
-    1.913504,
-    1.912251,
-    1.910989,
-    1.909719,
-    1.908440,
-    1.907153,
-    1.905857,
-    1.904552,
-    1.903239,
-    1.901918,
-    1.900588,
-    1.899250,
-    1.897903,
-    1.896547,
-    1.895183,
-    1.893811,
-    1.892430,
-    1.891041,
-    1.889644,
-    1.888238,
-    1.886824,
-    1.885401,
-    1.883970,
-    1.882531,
-    1.881083,
-    1.879627,
-    1.878163,
-    1.876691,
-    1.875210,
-    1.873721,
-    1.872224,
-    1.870719,
-    1.869205,
-    1.867683,
-    1.866153,
-    1.864615,
-    1.863069,
-    1.861514,
-    1.859952,
-    1.858381,
-    1.856803,
-    1.855216,
-    1.853621,
-    1.852018,
-    1.850407,
-    1.848788,
-    1.847161,
-    1.845526,
-    1.843884,
-    1.842233,
-    1.840574,
-    1.838907,
-    1.837233,
-    1.835550,
-    1.833860,
-    1.832162,
-    1.830456,
-    1.828742,
-    1.827020,
-    1.825291,
-    1.823553,
-    1.821808,
-    1.820056,
-    1.818295,
-    1.816527,
-    1.814751,
-    1.812968,
-    1.811177,
-    1.809378,
-    1.807571,
-    1.805757,
-    1.803935,
-    1.802106,
-    1.800269,
-    1.798425,
-    1.796573,
-    1.794714,
-    1.792847,
-    1.790973,
-    1.789091,
-    1.787202,
-    1.785305,
-    1.783401,
-    1.781490,
-    1.779571,
-    1.777645,
-    1.775711,
-    1.773771,
-    1.771822,
-    1.769867,
-    1.767905,
-    1.765935,
-    1.763958,
-    1.761974,
-    1.759982,
-    1.757984,
-    1.755978,
-    1.753965,
-    1.751945,
-    1.749918,
-    1.747884,
-    1.745843,
-    1.743795,
-    1.741740,
-    1.739678,
-    1.737608,
-    1.735532,
-    1.733449,
-    1.731360,
-    1.729263,
-    1.727159,
-    1.725049,
-    1.722931,
-    1.720807,
-    1.718676,
-    1.716538,
-    1.714394,
-    1.712243,
-    1.710085,
-    1.707920,
-    1.705749,
-    1.703571,
-    1.701386,
-    1.699195,
-    1.696998,
-    1.694793,
-    1.692582,
-    1.690365,
-    1.688141,
-    1.685911,
-    1.683674,
-    1.681431,
-    1.679181,
-    1.676925,
-    1.674662,
-    1.672394,
-    1.670118,
-    1.667837,
-    1.665549,
-    1.663255,
-    1.660955,
-    1.658648,
-    1.656336,
-    1.654017,
-    1.651692,
-    1.649361,
-    1.647023,
-    1.644680,
-    1.642330,
-    1.639975,
-    1.637613,
-    1.635246,
-    1.632872,
-    1.630493,
-    1.628107,
-    1.625716,
-    1.623318,
-    1.620915,
-    1.618506,
-    1.616091,
-    1.613671,
-    1.611244,
-    1.608812,
-    1.606374,
-    1.603931,
-    1.601481,
-    1.599026,
-    1.596566,
-    1.594099,
-    1.591628,
-    1.589150,
-    1.586667,
-    1.584179,
-    1.581685,
-    1.579185,
-    1.576680,
-    1.574170,
-    1.571654,
-    1.569133,
-    1.566606,
-    1.564075,
-    1.561537,
-    1.558995,
-    1.556447,
-    1.553894,
-    1.551336,
-    1.548773,
-    1.546204,
-    1.543630,
-    1.541052,
-    1.538468,
-    1.535879,
-    1.533285,
-    1.530686,
-    1.528081,
-    1.525472,
-    1.522858,
-    1.520239,
-    1.517616,
-    1.514987,
-    1.512353,
-    1.509715,
-    1.507072,
-    1.504424,
-    1.501771,
-    1.499114,
-    1.496452,
-    1.493785,
-    1.491113,
-    1.488437,
-    1.485756,
-    1.483071,
-    1.480381,
-    1.477687,
-    1.474988,
-    1.472285,
-    1.469577,
-    1.466865,
-    1.464148,
-    1.461427,
-    1.458702,
-    1.455972,
-    1.453238,
-    1.450500,
-    1.447758,
-    1.445011,
-    1.442260,
-    1.439505,
-    1.436746,
-    1.433983,
-    1.431215,
-    1.428444,
-    1.425668,
-    1.422889,
-    1.420105,
-    1.417318,
-    1.414526,
-    1.411731,
-    1.408932,
-    1.406129,
-    1.403322,
-    1.400512,
-    1.397697,
-    1.394879,
-    1.392057,
-    1.389232,
-    1.386402,
-    1.383569,
-    1.380733,
-    1.377893,
-    1.375049,
-    1.372202,
-    1.369351,
-    1.366497,
-    1.363640,
-    1.360779,
-    1.357914,
-    1.355046,
-    1.352175,
-    1.349301,
-    1.346423,
-    1.343542,
-    1.340658,
-    1.337770,
-    1.334880,
-    1.331986,
-    1.329089,
-    1.326189,
-    1.323286,
-    1.320380,
-    1.317470,
-    1.314558,
-    1.311643,
-    1.308725,
-    1.305804,
-    1.302880,
-    1.299954,
-    1.297024,
-    1.294092,
-    1.291157,
-    1.288219,
-    1.285278,
-    1.282335,
-    1.279389,
-    1.276440,
-    1.273489,
-    1.270536,
-    1.267579,
-    1.264621,
-    1.261659,
-    1.258696,
-    1.255729,
-    1.252761,
-    1.249790,
-    1.246816,
-    1.243841,
-    1.240863,
-    1.237883,
-    1.234900,
-    1.231915,
-    1.228929,
-    1.225940,
-    1.222948,
-    1.219955,
-    1.216960,
-    1.213962,
-    1.210963,
-    1.207962,
-    1.204958,
-    1.201953,
-    1.198946,
-    1.195937,
-    1.192926,
-    1.189913,
-    1.186899,
-    1.183883,
-    1.180865,
-    1.177845,
-    1.174824,
-    1.171801,
-    1.168776,
-    1.165750,
-    1.162722,
-    1.159693,
-    1.156662,
-    1.153630,
-    1.150596,
-    1.147561,
-    1.144524,
-    1.141486,
-    1.138447,
-    1.135406,
-    1.132365,
-    1.129321,
-    1.126277,
-    1.123232,
-    1.120185,
-    1.117137,
-    1.114088,
-    1.111038,
-    1.107987,
-    1.104935,
-    1.101882,
-    1.098829,
-    1.095774,
-    1.092718,
-    1.089661,
-    1.086604,
-    1.083545,
-    1.080486,
-    1.077426,
-    1.074366,
-    1.071304,
-    1.068242,
-    1.065180,
-    1.062117,
-    1.059053,
-    1.055988,
-    1.052923,
-    1.049858,
-    1.046792,
-    1.043726,
-    1.040659,
-    1.037592,
-    1.034525,
-    1.031457,
-    1.028389,
-    1.025320,
-    1.022252,
-    1.019183,
-    1.016114,
-    1.013045,
-    1.009976,
-    1.006906,
-    1.003837,
-    1.000767,
-    0.997698,
-    0.994628,
-    0.991559,
-    0.988490,
-    0.985421,
-    0.982352,
-    0.979283,
-    0.976214,
-    0.973145,
-    0.970077,
-    0.967009,
-    0.963942,
-    0.960874,
-    0.957807,
-    0.954741,
-    0.951675,
-    0.948609,
-    0.945544,
-    0.942479,
-    0.939415,
-    0.936352,
-    0.933289,
-    0.930227,
-    0.927165,
-    0.924104,
-    0.921044,
-    0.917984,
-    0.914925,
-    0.911868,
-    0.908810,
-    0.905754,
-    0.902699,
-    0.899644,
-    0.896591,
-    0.893538,
-    0.890487,
-    0.887436,
-    0.884387,
-    0.881339,
-    0.878291,
-    0.875245,
-    0.872200,
-    0.869157,
-    0.866114,
-    0.863073,
-    0.860033,
-    0.856995,
-    0.853957,
-    0.850922,
-    0.847887,
-    0.844854,
-    0.841823,
-    0.838793,
-    0.835764,
-    0.832737,
-    0.829712,
-    0.826688,
-    0.823666,
-    0.820645,
-    0.817626,
-    0.814609,
-    0.811594,
-    0.808580,
-    0.805568,
-    0.802558,
-    0.799550,
-    0.796544,
-    0.793540,
-    0.790537,
-    0.787537,
-    0.784539,
-    0.781542,
-    0.778548,
-    0.775556,
-    0.772566,
-    0.769578,
-    0.766592,
-    0.763608,
-    0.760627,
-    0.757648,
-    0.754671,
-    0.751697,
-    0.748724,
-    0.745755,
-    0.742787,
-    0.739822,
-    0.736860,
-    0.733900,
-    0.730942,
-    0.727987,
-    0.725035,
-    0.722085,
-    0.719138,
-    0.716193,
-    0.713251,
-    0.710312,
-    0.707376,
-    0.704442,
-    0.701511,
-    0.698583,
-    0.695657,
-    0.692735,
-    0.689816,
-    0.686899,
-    0.683985,
-    0.681075,
-    0.678167,
-    0.675262,
-    0.672361,
-    0.669462,
-    0.666567,
-    0.663675,
-    0.660786,
-    0.657900,
-    0.655017,
-    0.652138,
-    0.649262,
-    0.646389,
-    0.643519,
-    0.640653,
-    0.637790,
-    0.634931,
-    0.632075,
-    0.629223,
-    0.626374,
-    0.623528,
-    0.620687,
-    0.617848,
-    0.615014,
-    0.612183,
-    0.609355,
-    0.606531,
-    0.603711,
-    0.600895,
-    0.598083,
-    0.595274,
-    0.592469,
-    0.589668,
-    0.586871,
-    0.584077,
-    0.581288,
-    0.578503,
-    0.575721,
-    0.572944,
-    0.570170,
-    0.567401,
-    0.564635,
-    0.561874,
-    0.559117,
-    0.556364,
-    0.553615,
-    0.550871,
-    0.548130,
-    0.545394,
-    0.542662,
-    0.539935,
-    0.537212,
-    0.534493,
-    0.531779,
-    0.529069,
-    0.526363,
-    0.523662,
-    0.520965,
-    0.518273,
-    0.515586,
-    0.512903,
-    0.510224,
-    0.507550,
-    0.504881,
-    0.502217,
-    0.499557,
-    0.496902,
-    0.494252,
-    0.491606,
-    0.488965,
-    0.486329,
-    0.483698,
-    0.481072,
-    0.478450,
-    0.475834,
-    0.473222,
-    0.470616,
-    0.468014,
-    0.465418,
-    0.462826,
-    0.460240,
-    0.457658,
-    0.455082,
-    0.452511,
-    0.449945,
-    0.447384,
-    0.444829,
-    0.442278,
-    0.439733,
-    0.437193,
-    0.434659,
-    0.432130,
-    0.429606,
-    0.427087,
-    0.424574,
-    0.422067,
-    0.419564,
-    0.417068,
-    0.414576,
-    0.412091,
-    0.409610,
-    0.407136,
-    0.404667,
-    0.402203,
-    0.399745,
-    0.397293,
-    0.394847,
-    0.392406,
-    0.389971,
-    0.387542,
-    0.385118,
-    0.382700,
-    0.380289,
-    0.377882,
-    0.375482,
-    0.373088,
-    0.370699,
-    0.368317,
-    0.365940,
-    0.363570,
-    0.361205,
-    0.358847,
-    0.356494,
-    0.354148,
-    0.351807,
-    0.349473,
-    0.347145,
-    0.344823,
-    0.342507,
-    0.340198,
-    0.337894,
-    0.335597,
-    0.333306,
-    0.331021,
-    0.328743,
-    0.326471,
-    0.324206,
-    0.321946,
-    0.319693,
-    0.317447,
-    0.315207,
-    0.312973,
-    0.310746,
-    0.308525,
-    0.306311,
-    0.304104,
-    0.301903,
-    0.299708,
-    0.297520,
-    0.295339,
-    0.293165,
-    0.290997,
-    0.288835,
-    0.286681,
-    0.284533,
-    0.282392,
-    0.280258,
-    0.278130,
-    0.276009,
-    0.273895,
-    0.271788,
-    0.269688,
-    0.267595,
-    0.265508,
-    0.263429,
-    0.261356,
-    0.259290,
-    0.257232,
-    0.255180,
-    0.253136,
-    0.251098,
-    0.249067,
-    0.247044,
-    0.245028,
-    0.243018,
-    0.241016,
-    0.239021,
-    0.237033,
-    0.235053,
-    0.233079,
-    0.231113,
-    0.229154,
-    0.227203,
-    0.225258,
-    0.223321,
-    0.221391,
-    0.219469,
-    0.217554,
-    0.215646,
-    0.213746,
-    0.211853,
-    0.209967,
-    0.208089,
-    0.206219,
-    0.204356,
-    0.202500,
-    0.200652,
-    0.198811,
-    0.196978,
-    0.195153,
-    0.193335,
-    0.191525,
-    0.189722,
-    0.187927,
-    0.186140,
-    0.184360,
-    0.182588,
-    0.180824,
-    0.179067,
-    0.177318,
-    0.175577,
-    0.173844,
-    0.172118,
-    0.170400,
-    0.168690,
-    0.166988,
-    0.165294,
-    0.163608,
-    0.161929,
-    0.160258,
-    0.158596,
-    0.156941,
-    0.155294,
-    0.153655,
-    0.152024,
-    0.150401,
-    0.148786,
-    0.147179,
-    0.145581,
-    0.143990,
-    0.142407,
-    0.140832,
-    0.139266,
-    0.137707,
-    0.136157,
-    0.134615,
-    0.133081,
-    0.131555,
-    0.130037,
-    0.128528,
-    0.127026,
-    0.125533,
-    0.124048,
-    0.122572,
-    0.121104,
-    0.119644,
-    0.118192,
-    0.116748,
-    0.115313,
-    0.113887,
-    0.112468,
-    0.111058,
-    0.109656,
-    0.108263,
-    0.106878,
-    0.105502,
-    0.104134,
-    0.102774,
-    0.101423,
-    0.100080,
-    0.098746,
-    0.097420,
-    0.096103,
-    0.094794,
-    0.093494,
-    0.092202,
-    0.090919,
-    0.089645,
-    0.088379,
-    0.087122,
-    0.085873,
-    0.084633,
-    0.083401,
-    0.082178,
-    0.080964,
-    0.079759,
-    0.078562,
-    0.077373,
-    0.076194,
-    0.075023,
-    0.073861,
-    0.072708,
-    0.071563,
-    0.070427,
-    0.069300,
-    0.068182,
-    0.067072,
-    0.065971,
-    0.064879,
-    0.063796,
-    0.062722,
-    0.061656,
-    0.060599,
-    0.059551,
-    0.058512,
-    0.057482,
-    0.056461,
-    0.055449,
-    0.054445,
-    0.053451,
-    0.052465,
-    0.051488,
-    0.050521,
-    0.049562,
-    0.048612,
-    0.047671,
-    0.046739,
-    0.045816,
-    0.044902,
-    0.043997,
-    0.043101,
-    0.042215,
-    0.041337,
-    0.040468,
-    0.039608,
-    0.038757,
-    0.037915,
-    0.037083,
-    0.036259,
-    0.035445,
-    0.034639,
-    0.033843,
-    0.033056,
-    0.032278,
-    0.031509,
-    0.030749,
-    0.029998,
-    0.029256,
-    0.028524,
-    0.027801,
-    0.027086,
-    0.026381,
-    0.025686,
-    0.024999,
-    0.024322,
-    0.023653,
-    0.022994,
-    0.022344,
-    0.021704,
-    0.021072,
-    0.020450,
-    0.019837,
-    0.019233,
-    0.018639,
-    0.018054,
-    0.017478,
-    0.016911,
-    0.016354,
-    0.015805,
-    0.015266,
-    0.014737,
-    0.014216,
-    0.013705,
-    0.013203,
-    0.012711,
-    0.012228,
-    0.011754,
-    0.011289,
-    0.010834,
-    0.010388,
-    0.009951,
-    0.009524,
-    0.009106,
-    0.008698,
-    0.008298,
-    0.007908,
-    0.007528,
-    0.007157,
-    0.006795,
-    0.006442,
-    0.006099,
-    0.005765,
-    0.005441,
-    0.005126,
-    0.004820,
-    0.004524,
-    0.004237,
-    0.003959,
-    0.003691,
-    0.003432,
-    0.003183,
-    0.002943,
-    0.002712,
-    0.002491,
-    0.002279,
-    0.002077,
-    0.001884,
-    0.001700,
-    0.001526,
-    0.001361,
-    0.001206,
-    0.001060,
-    0.000923,
-    0.000796,
-    0.000678,
-    0.000570,
-    0.000471,
-    0.000382,
-    0.000301,
-    0.000231,
-    0.000170,
-    0.000118,
-    0.000075,
-    0.000042,
-    0.000019,
-    0.000005,
-    0.000000,
-};
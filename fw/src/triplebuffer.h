@@ -0,0 +1,60 @@
+#pragma once
+
+/**
+ * Lock-free triple buffer for handing data from one context to another, e.g.
+ * parameters computed in the idle loop to the audio interrupt. The writer
+ * always has a slot of its own to fill and the reader always gets the most
+ * recently published slot, so neither of them ever waits for the other.
+ *
+ * The buffer only keeps track of slot indices. The caller keeps an array of
+ * three slots of whatever type it needs, and the writer must fill in a whole
+ * slot before each publish.
+ */
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/// Set in the middle slot index when it was published after the last read
+#define TRIPLEBUFFER_FRESH 0x4
+
+typedef struct {
+    _Atomic uint8_t middle; ///< Slot between writer and reader
+    uint8_t back; ///< Slot owned by the writer
+    uint8_t front; ///< Slot owned by the reader
+} TripleBuffer;
+
+static inline void tripleBufferInit(TripleBuffer* tb)
+{
+    tb->front = 0;
+    atomic_init(&tb->middle, 1);
+    tb->back = 2;
+}
+
+/**
+ * The slot the writer should fill in before publishing it
+ */
+static inline unsigned tripleBufferWriteSlot(const TripleBuffer* tb)
+{
+    return tb->back;
+}
+
+/**
+ * Make the slot the writer has filled in available to the reader
+ */
+static inline void tripleBufferPublish(TripleBuffer* tb)
+{
+    tb->back = atomic_exchange(&tb->middle, tb->back | TRIPLEBUFFER_FRESH) &
+            ~TRIPLEBUFFER_FRESH;
+}
+
+/**
+ * The slot holding the most recently published data, which stays valid for
+ * the reader until the next call.
+ */
+static inline unsigned tripleBufferReadSlot(TripleBuffer* tb)
+{
+    if (atomic_load(&tb->middle) & TRIPLEBUFFER_FRESH) {
+        tb->front = atomic_exchange(&tb->middle, tb->front) & ~TRIPLEBUFFER_FRESH;
+    }
+    return tb->front;
+}
@@ -28,6 +28,9 @@ SRCS += src/target/usb.c
 SRCS += src/target/usb_audio.c
 SRCS += src/target/wm8731.c
 
+# Sources shared by all platforms
+SRCS += src/loadmeter.c
+
 COMMON_OBJS := $(SRCS:src/%.c=$(BUILDDIR)/%.o)
 
 # -------------------------------------
@@ -44,6 +47,10 @@ LDFLAGS += -Wl,-T$(LDSCRIPT)
 
 include common.mk
 
+# fft_tests waits in its idle loop for audio, which needs the idle loop to run
+# alongside the audio processing, as it does here and in the Jack client
+all: $(BUILDDIR)/fft_tests.elf
+
 # -------------------------------------
 
 $(LIBOPENCM3):